@@ -0,0 +1,30 @@
+#version 450
+
+// Depth only counterpart of engine-material-shader-packed.vert, reads nothing but the position stream
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+layout(location = 0) in vec4 inPosition;
+
+// One record per render proxy, indexed by the draw's first instance
+layout(std430, set = 1, binding = 0) readonly buffer ObjectBuffer {
+	mat4 models[];
+} objects;
+
+// Positions are normalized within the mesh bounds
+layout(push_constant) uniform VertexDequantization {
+    vec4 positionOffset;
+    vec4 positionScale;
+} dequantization;
+
+invariant gl_Position;
+
+void main() {
+    vec3 position = dequantization.positionOffset.xyz + dequantization.positionScale.xyz * inPosition.xyz;
+
+    mat4 model = objects.models[gl_InstanceIndex];
+    gl_Position = ubo.proj * ubo.view * model * vec4(position, 1.0);
+}
\ No newline at end of file
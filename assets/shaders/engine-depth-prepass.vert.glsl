@@ -0,0 +1,22 @@
+#version 450
+
+// Depth only counterpart of engine-material-shader.vert, reads nothing but the position stream
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+layout(location = 0) in vec3 inPosition;
+
+// One record per render proxy, indexed by the draw's first instance
+layout(std430, set = 1, binding = 0) readonly buffer ObjectBuffer {
+	mat4 models[];
+} objects;
+
+invariant gl_Position;
+
+void main() {
+    mat4 model = objects.models[gl_InstanceIndex];
+    gl_Position = ubo.proj * ubo.view * model * vec4(inPosition, 1.0);
+}
\ No newline at end of file
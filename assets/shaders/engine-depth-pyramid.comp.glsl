@@ -0,0 +1,35 @@
+#version 450
+
+// Reduces one level of the depth pyramid into the next, or the depth attachment into the first level. Every
+// destination texel keeps the farthest depth of the source texels it overlaps, so it never claims more occlusion
+// than the source shows.
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = 0) uniform sampler2D source;
+layout(binding = 1, r32f) uniform writeonly image2D destination;
+
+layout(push_constant) uniform ReduceConstants {
+	uvec2 sourceSize;
+	uvec2 destinationSize;
+} constants;
+
+void main() {
+	uvec2 position = gl_GlobalInvocationID.xy;
+	if (any(greaterThanEqual(position, constants.destinationSize))) {
+		return;
+	}
+
+	// Rounded outwards, the first level is at most twice as small as the attachment so this spans up to 3x3 texels
+	uvec2 first = position * constants.sourceSize / constants.destinationSize;
+	uvec2 last = min(((position + 1) * constants.sourceSize + constants.destinationSize - 1) / constants.destinationSize, constants.sourceSize) - 1;
+
+	float depth = 0.0;
+	for (uint y = first.y; y <= last.y; ++y) {
+		for (uint x = first.x; x <= last.x; ++x) {
+			depth = max(depth, texelFetch(source, ivec2(x, y), 0).r);
+		}
+	}
+
+	imageStore(destination, ivec2(position), vec4(depth));
+}
\ No newline at end of file
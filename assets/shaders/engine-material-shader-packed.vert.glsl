@@ -0,0 +1,61 @@
+#version 450
+
+// Vertex shader for geometries stored as PackedVertex3d, outputs match engine-material-shader.vert
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+// Expanded to floats by the vertex input formats
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec4 inColor;
+layout(location = 2) in vec2 inNormal;
+layout(location = 3) in vec2 inTexCoord;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragNormal;
+layout(location = 2) out vec2 fragTexCoord;
+
+// Must match the depth prepass bit for bit, the color pass tests against its depth
+invariant gl_Position;
+
+// One record per render proxy, indexed by the draw's first instance
+layout(std430, set = 1, binding = 0) readonly buffer ObjectBuffer {
+	mat4 models[];
+} objects;
+
+// Positions are normalized within the mesh bounds
+layout(push_constant) uniform VertexDequantization {
+    vec4 positionOffset;
+    vec4 positionScale;
+} dequantization;
+
+const vec3 DIRECTION_TO_LIGHT = normalize(vec3(1.0, -3.0, 1.0));
+const float AMBIENT = 0.05;
+
+vec3 DecodeOctahedral(vec2 encoded) {
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    // Folds the lower hemisphere back out of the corners of the square
+    float fold = max(-normal.z, 0.0);
+    normal.x += normal.x >= 0.0 ? -fold : fold;
+    normal.y += normal.y >= 0.0 ? -fold : fold;
+    return normalize(normal);
+}
+
+void main() {
+    vec3 position = dequantization.positionOffset.xyz + dequantization.positionScale.xyz * inPosition.xyz;
+    vec3 normal = DecodeOctahedral(inNormal);
+
+    mat4 model = objects.models[gl_InstanceIndex];
+    gl_Position = ubo.proj * ubo.view * model * vec4(position, 1.0);
+
+    mat3 normalMatrix = transpose(inverse(mat3(model)));
+    vec3 normalWorldSpace = normalize(normalMatrix * normal);
+
+    float lightIntensity = AMBIENT + max(dot(normalWorldSpace, DIRECTION_TO_LIGHT), 0);
+
+    fragColor = lightIntensity * inColor.rgb;
+    fragNormal = normal;
+    fragTexCoord = inTexCoord;
+}
\ No newline at end of file
@@ -14,18 +14,22 @@ layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec3 fragNormal;
 layout(location = 2) out vec2 fragTexCoord;
 
-layout(push_constant) uniform pushConstants {
-	// Only guaranteed a total of 128 bytes.
-	mat4 model; // 64 bytes
-} uPushConstants;
+// Must match the depth prepass bit for bit, the color pass tests against its depth
+invariant gl_Position;
+
+// One record per render proxy, indexed by the draw's first instance
+layout(std430, set = 1, binding = 0) readonly buffer ObjectBuffer {
+	mat4 models[];
+} objects;
 
 const vec3 DIRECTION_TO_LIGHT = normalize(vec3(1.0, -3.0, 1.0));
 const float AMBIENT = 0.05;
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * uPushConstants.model * vec4(inPosition, 1.0);
+    mat4 model = objects.models[gl_InstanceIndex];
+    gl_Position = ubo.proj * ubo.view * model * vec4(inPosition, 1.0);
 
-    mat3 normalMatrix = transpose(inverse(mat3(uPushConstants.model)));
+    mat3 normalMatrix = transpose(inverse(mat3(model)));
     vec3 normalWorldSpace = normalize(normalMatrix * inNormal);
 
     float lightIntensity = AMBIENT + max(dot(normalWorldSpace, DIRECTION_TO_LIGHT), 0);
@@ -0,0 +1,190 @@
+#version 450
+#extension GL_EXT_buffer_reference : require
+
+// Culls the meshlets of one object against the view frustum, their normal cones and the depth pyramid and appends
+// an indexed indirect draw per survivor. One dispatch per object and phase, one invocation per meshlet.
+//
+// Occlusion is tested in two phases. The early phase tests against the pyramid of the previous frame, projected
+// with the previous frame's matrix, and draws what it does not occlude. The late phase runs once the early draws
+// have been reduced into a new pyramid and tests only the meshlets the early phase rejected, drawing the ones the
+// current depth shows. Whatever moved into view since the previous frame is drawn late instead of disappearing.
+
+layout(local_size_x = 64) in;
+
+// Matches Meshlet in render_types.h
+struct Meshlet {
+	uint firstIndex;
+	uint indexCount;
+	uint firstVertex;
+	uint vertexCount;
+	vec3 center;
+	float radius;
+	vec3 coneAxis;
+	float coneCutoff;
+};
+
+// VkDrawIndexedIndirectCommand
+struct DrawCommand {
+	uint indexCount;
+	uint instanceCount;
+	uint firstIndex;
+	int vertexOffset;
+	uint firstInstance;
+};
+
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer MeshletBuffer {
+	Meshlet meshlets[];
+};
+
+layout(binding = 0) uniform CullUniforms {
+	// World space, inward facing unit normals in xyz and the distance in w
+	vec4 frustumPlanes[6];
+	vec4 cameraPosition;
+	// Matrices the pyramid was built with, the current frame's for the late phase and the previous frame's for
+	// the early one
+	mat4 viewProjection;
+	mat4 previousViewProjection;
+	// Width and height of the first level and the level count. w is 1 when the pyramid holds the previous frame's
+	// depth for the early phase to test, 0 when the frame has no occlusion culling or no previous depth.
+	vec4 pyramid;
+} cull;
+
+layout(std430, binding = 1) writeonly buffer DrawBuffer {
+	DrawCommand draws[];
+};
+
+// Surviving meshlets per culled object, cleared before the pass and read as the draw count
+layout(std430, binding = 2) buffer CountBuffer {
+	uint counts[];
+};
+
+// Per draw slot of the early range, set by the early phase for the meshlets the previous frame's depth occluded
+layout(std430, binding = 3) buffer OccludedBuffer {
+	uint occludedFlags[];
+};
+
+layout(binding = 4) uniform sampler2D depthPyramid;
+
+layout(std430, set = 1, binding = 0) readonly buffer ObjectBuffer {
+	mat4 models[];
+} objects;
+
+layout(push_constant) uniform CullConstants {
+	MeshletBuffer meshlets;
+	uint objectIndex;
+	uint firstMeshlet;
+	uint meshletCount;
+	uint firstDraw;
+	uint countIndex;
+	// 0 for the early phase, 1 for the late one
+	uint phase;
+} constants;
+
+// Leading entries of the count buffer, see s_meshletCullStatisticsCount
+const uint earlyOccludedIndex = 0;
+const uint lateOccludedIndex = 1;
+
+// True when the depth pyramid has surfaces in front of the whole sphere everywhere it covers the screen. The
+// sphere's bounding box is projected with the matrix the pyramid was built with, the level where its rectangle
+// spans at most two texels is sampled at the rectangle's corners.
+bool IsOccluded(vec3 center, float radius, mat4 viewProjection) {
+	vec2 rectMin = vec2(1.0);
+	vec2 rectMax = vec2(0.0);
+	float nearestDepth = 1.0;
+
+	for (int i = 0; i < 8; ++i) {
+		vec3 corner = center + radius * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+		vec4 clip = viewProjection * vec4(corner, 1.0);
+
+		// Crossing the near plane, the projection is unbounded
+		if (clip.z < 0.0 || clip.w <= 0.0) {
+			return false;
+		}
+
+		vec3 ndc = clip.xyz / clip.w;
+		rectMin = min(rectMin, ndc.xy * 0.5 + 0.5);
+		rectMax = max(rectMax, ndc.xy * 0.5 + 0.5);
+		nearestDepth = min(nearestDepth, ndc.z);
+	}
+
+	// Outside the view the pyramid was built for, it knows nothing about the sphere
+	if (any(lessThan(rectMax, vec2(0.0))) || any(greaterThan(rectMin, vec2(1.0)))) {
+		return false;
+	}
+
+	rectMin = clamp(rectMin, vec2(0.0), vec2(1.0));
+	rectMax = clamp(rectMax, vec2(0.0), vec2(1.0));
+
+	vec2 size = (rectMax - rectMin) * cull.pyramid.xy;
+	int level = int(min(ceil(log2(max(max(size.x, size.y), 1.0))), cull.pyramid.z - 1.0));
+	ivec2 levelSize = max(ivec2(cull.pyramid.xy) >> level, ivec2(1));
+
+	ivec2 first = clamp(ivec2(rectMin * vec2(levelSize)), ivec2(0), levelSize - 1);
+	ivec2 last = clamp(ivec2(rectMax * vec2(levelSize)), ivec2(0), levelSize - 1);
+
+	float depth = max(
+		max(texelFetch(depthPyramid, first, level).r, texelFetch(depthPyramid, ivec2(last.x, first.y), level).r),
+		max(texelFetch(depthPyramid, ivec2(first.x, last.y), level).r, texelFetch(depthPyramid, last, level).r));
+
+	return nearestDepth > depth;
+}
+
+void main() {
+	uint index = gl_GlobalInvocationID.x;
+	if (index >= constants.meshletCount) {
+		return;
+	}
+
+	Meshlet meshlet = constants.meshlets.meshlets[constants.firstMeshlet + index];
+	mat4 model = objects.models[constants.objectIndex];
+
+	vec3 scale = vec3(length(model[0].xyz), length(model[1].xyz), length(model[2].xyz));
+	float maxScale = max(scale.x, max(scale.y, scale.z));
+	float minScale = min(scale.x, min(scale.y, scale.z));
+
+	vec3 center = (model * vec4(meshlet.center, 1.0)).xyz;
+	float radius = meshlet.radius * maxScale;
+
+	bool visible = true;
+	for (int i = 0; i < 6; ++i) {
+		visible = visible && dot(cull.frustumPlanes[i].xyz, center) + cull.frustumPlanes[i].w >= -radius;
+	}
+
+	// Non-uniform scale bends the normals, the cone no longer bounds them
+	if (visible && meshlet.coneCutoff < 1.0 && maxScale - minScale <= 0.001 * maxScale) {
+		vec3 axis = normalize(mat3(model) * meshlet.coneAxis);
+		vec3 view = center - cull.cameraPosition.xyz;
+		visible = dot(view, axis) < meshlet.coneCutoff * length(view) + radius;
+	}
+
+	uint firstDraw = constants.firstDraw;
+	uint countIndex = constants.countIndex;
+
+	if (constants.phase == 0) {
+		bool occluded = visible && cull.pyramid.w > 0.0 && IsOccluded(center, radius, cull.previousViewProjection);
+		occludedFlags[constants.firstDraw + index] = occluded ? 1u : 0u;
+		if (occluded) {
+			atomicAdd(counts[earlyOccludedIndex], 1);
+			return;
+		}
+	}
+	else {
+		// Only what the early phase rejected as occluded is left to draw, into the late range
+		if (occludedFlags[constants.firstDraw + index] == 0) {
+			return;
+		}
+		if (IsOccluded(center, radius, cull.viewProjection)) {
+			atomicAdd(counts[lateOccludedIndex], 1);
+			return;
+		}
+		firstDraw += constants.meshletCount;
+		countIndex += 1;
+	}
+
+	if (!visible) {
+		return;
+	}
+
+	uint slot = atomicAdd(counts[countIndex], 1);
+	draws[firstDraw + slot] = DrawCommand(meshlet.indexCount, 1, meshlet.firstIndex, int(meshlet.firstVertex), constants.objectIndex);
+}
\ No newline at end of file
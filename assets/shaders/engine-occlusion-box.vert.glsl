@@ -0,0 +1,33 @@
+#version 450
+
+// Bounding box of an object guarded by an occlusion query, 36 vertices without any vertex buffer. Only depth tested,
+// the query counts the samples that pass.
+
+layout(push_constant) uniform BoxConstants {
+	mat4 viewProjection;
+	vec4 boundsMin;
+	vec4 boundsMax;
+} constants;
+
+// One record per render proxy, indexed by the draw's first instance
+layout(std430, set = 0, binding = 0) readonly buffer ObjectBuffer {
+	mat4 models[];
+} objects;
+
+// Corners are numbered by their bits, x in the lowest. Two triangles per face, the pipeline culls no faces so the
+// winding does not matter.
+const int corners[36] = int[36](
+	0, 2, 6, 0, 6, 4,
+	1, 5, 7, 1, 7, 3,
+	0, 4, 5, 0, 5, 1,
+	2, 3, 7, 2, 7, 6,
+	0, 1, 3, 0, 3, 2,
+	4, 6, 7, 4, 7, 5
+);
+
+void main() {
+	int corner = corners[gl_VertexIndex];
+	vec3 select = vec3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1);
+	vec3 position = mix(constants.boundsMin.xyz, constants.boundsMax.xyz, select);
+	gl_Position = constants.viewProjection * objects.models[gl_InstanceIndex] * vec4(position, 1.0);
+}
\ No newline at end of file
@@ -22,7 +22,7 @@ public:
 		auto entity = m_activeScene->CreateEntity("entity 1");
 		
 		mz::GeometryRendererComponent entityGeometryComponent;
-		entityGeometryComponent.geometry = m_geometrySystem->Acquire("tower2.fbx");
+		entityGeometryComponent.geometry = m_geometrySystem->AcquireAsync("tower2.fbx");
 		entity.AddComponent<mz::GeometryRendererComponent>(entityGeometryComponent);
 
 		mz::Transform3dComponent entityTransformComponent;
@@ -0,0 +1,92 @@
+#include "allocation_tracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace mz {
+	static std::atomic<uint64_t> s_allocationCount{ 0 };
+	static std::atomic<uint64_t> s_deallocationCount{ 0 };
+	static std::atomic<uint64_t> s_allocatedBytes{ 0 };
+	static thread_local uint64_t t_threadAllocationCount = 0;
+
+	uint64_t AllocationTracker::GetAllocationCount()
+	{
+		return s_allocationCount.load(std::memory_order_relaxed);
+	}
+
+	uint64_t AllocationTracker::GetDeallocationCount()
+	{
+		return s_deallocationCount.load(std::memory_order_relaxed);
+	}
+
+	uint64_t AllocationTracker::GetAllocatedBytes()
+	{
+		return s_allocatedBytes.load(std::memory_order_relaxed);
+	}
+
+	uint64_t AllocationTracker::GetThreadAllocationCount()
+	{
+		return t_threadAllocationCount;
+	}
+}
+
+#ifdef MZ_TRACK_ALLOCATIONS
+static void* TrackedAllocate(std::size_t size, std::size_t alignment)
+{
+	mz::s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+	mz::s_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	++mz::t_threadAllocationCount;
+
+	if (size == 0) {
+		size = 1;
+	}
+
+#if defined(_MSC_VER)
+	void* ptr = alignment > alignof(std::max_align_t) ? _aligned_malloc(size, alignment) : std::malloc(size);
+#else
+	void* ptr = alignment > alignof(std::max_align_t)
+		? std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1))
+		: std::malloc(size);
+#endif
+
+	if (!ptr) {
+		throw std::bad_alloc();
+	}
+
+	return ptr;
+}
+
+static void TrackedFree(void* ptr, std::size_t alignment)
+{
+	if (!ptr) {
+		return;
+	}
+
+	mz::s_deallocationCount.fetch_add(1, std::memory_order_relaxed);
+
+#if defined(_MSC_VER)
+	if (alignment > alignof(std::max_align_t)) {
+		_aligned_free(ptr);
+		return;
+	}
+#else
+	(void)alignment;
+#endif
+	std::free(ptr);
+}
+
+void* operator new(std::size_t size) { return TrackedAllocate(size, alignof(std::max_align_t)); }
+void* operator new[](std::size_t size) { return TrackedAllocate(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return TrackedAllocate(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return TrackedAllocate(size, static_cast<std::size_t>(alignment)); }
+
+void operator delete(void* ptr) noexcept { TrackedFree(ptr, alignof(std::max_align_t)); }
+void operator delete[](void* ptr) noexcept { TrackedFree(ptr, alignof(std::max_align_t)); }
+void operator delete(void* ptr, std::size_t) noexcept { TrackedFree(ptr, alignof(std::max_align_t)); }
+void operator delete[](void* ptr, std::size_t) noexcept { TrackedFree(ptr, alignof(std::max_align_t)); }
+void operator delete(void* ptr, std::align_val_t alignment) noexcept { TrackedFree(ptr, static_cast<std::size_t>(alignment)); }
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept { TrackedFree(ptr, static_cast<std::size_t>(alignment)); }
+void operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept { TrackedFree(ptr, static_cast<std::size_t>(alignment)); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t alignment) noexcept { TrackedFree(ptr, static_cast<std::size_t>(alignment)); }
+#endif
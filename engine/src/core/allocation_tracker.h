@@ -0,0 +1,35 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+
+namespace mz {
+	// Process-wide heap allocation counters.
+	// Counting is only active when the engine is built with MZ_TRACK_ALLOCATIONS,
+	// which replaces the global operator new/delete. Otherwise every query returns zero.
+	class AllocationTracker {
+	public:
+		static uint64_t GetAllocationCount();
+		static uint64_t GetDeallocationCount();
+		static uint64_t GetAllocatedBytes();
+		// Allocations made by the calling thread only, unaffected by work running on other threads
+		static uint64_t GetThreadAllocationCount();
+
+		inline static constexpr bool IsEnabled()
+		{
+#ifdef MZ_TRACK_ALLOCATIONS
+			return true;
+#else
+			return false;
+#endif
+		}
+	};
+
+	// Counts allocations the calling thread made between construction and the call to GetAllocationCount()
+	class AllocationScope {
+	public:
+		AllocationScope() : m_start(AllocationTracker::GetThreadAllocationCount()) {}
+		inline uint64_t GetAllocationCount() const { return AllocationTracker::GetThreadAllocationCount() - m_start; }
+	private:
+		uint64_t m_start;
+	};
+}
@@ -1,19 +1,26 @@
 #include "application.h"
 #include "engine/src/asserts.h"
+#include "engine/src/core/allocation_tracker.h"
 #include "engine/src/renderer/render_api.h"
 
 namespace mz {
-	#define BIND_EVENT_FN(x) std::bind(&Application::x, this, std::placeholders::_1)
+	#define BIND_EVENT_FN(x) [this](auto&&... args) -> decltype(auto) { return this->x(std::forward<decltype(args)>(args)...); }
 
 	Application* Application::s_Instance = nullptr;
 
-	Application::Application()
+	// Frames before the allocation check kicks in, lets caches and pools reach their steady-state size
+	static constexpr uint64_t s_allocationWarmupFrames = 10;
+
+	Application::Application() : m_frameAllocator(1024 * 1024)
 	{
 		MZ_CORE_INFO("Running Marzanna engine...");	
 
 		MZ_ASSERT(!s_Instance, "Application already exists!");
 		s_Instance = this;
 
+		// One thread is left for the main loop
+		m_jobSystem = std::make_unique<JobSystem>(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+
 		m_window = std::unique_ptr<Window>(Window::Create());
 		m_window->SetEventCallback(BIND_EVENT_FN(OnEvent));
 
@@ -22,6 +29,16 @@ namespace mz {
 
 		m_renderApi->Initialize();
 
+		// Cooked assets are resolved through the manifest written by mzcook
+		if (m_assetManifest.Load(AssetManifest::s_cookedRoot + AssetManifest::s_fileName)) {
+			MZ_CORE_INFO("Loaded asset manifest with {0} cooked assets", m_assetManifest.Size());
+		}
+		else {
+			MZ_CORE_WARN("No cooked asset manifest found, assets will be imported at runtime");
+		}
+
+		// Geometries hold references into the texture system, so it is created first and shut down last
+		m_textureSystem = std::make_unique<TextureSystem>();
 		m_geometrySystem = std::make_unique<GeometrySystem>();
 
 		m_activeScene = std::make_unique<Scene>();
@@ -36,7 +53,11 @@ namespace mz {
 		while (m_isRunning) {
 			if (m_isSuspended) continue;
 
+			BeginFrame();
+
 			m_window->OnUpdate();
+			m_geometrySystem->Update();
+			m_textureSystem->Update();
 			m_activeScene->OnGraphicsUpdate();
 
 			for (Layer* layer : m_layerStack) {
@@ -47,9 +68,34 @@ namespace mz {
 		Shutdown();
 		return true;
 	}
+
+	void Application::BeginFrame()
+	{
+		m_frameAllocator.Reset();
+
+#ifdef MZ_TRACK_ALLOCATIONS
+		// Steady-state frames are expected to run without touching the heap. Only the main thread is counted,
+		// job system workers allocate while loading assets in the background.
+		uint64_t allocations = AllocationTracker::GetThreadAllocationCount();
+		uint64_t frameAllocations = allocations - m_lastAllocationCount;
+		if (m_frameIndex > s_allocationWarmupFrames && frameAllocations > 0) {
+			MZ_CORE_WARN("Frame {0} performed {1} heap allocations", m_frameIndex - 1, frameAllocations);
+		}
+		// Re-read so the warning itself is not counted towards the next frame
+		m_lastAllocationCount = AllocationTracker::GetThreadAllocationCount();
+#endif
+
+		++m_frameIndex;
+	}
+
 	void Application::Shutdown()
 	{
+		// Loads still running reference the geometry system
+		m_jobSystem->WaitIdle();
+		// Releases the geometries its components hold while the geometry system is still alive
+		m_activeScene.reset();
 		m_geometrySystem->Shutdown();
+		m_textureSystem->Shutdown();
 		m_renderApi->Shutdown();
 	}
 
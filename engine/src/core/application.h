@@ -4,6 +4,10 @@
 #include "events/application_event.h"
 #include "engine/src/platform/windows_window.h"
 #include "engine/src/core/layer_stack.h"
+#include "engine/src/core/linear_allocator.h"
+#include "engine/src/core/job_system.h"
+#include "engine/src/system/asset_manifest.h"
+#include "engine/src/system/texture_system.h"
 #include "engine/src/renderer/render_api.h"
 #include "engine/src/system/scene/scene.h"
 
@@ -24,10 +28,18 @@ namespace mz {
 		inline Window& GetWindow() { return *m_window; }
 		inline RenderApiType GetRenderApiType() { return m_renderApi->GetType(); }
 		inline RenderAPI& GetRenderApi() { return *m_renderApi; }
+		// Scratch memory that is released at the start of every frame
+		inline LinearAllocator& GetFrameAllocator() { return m_frameAllocator; }
+		inline const AssetManifest& GetAssetManifest() const { return m_assetManifest; }
+		inline JobSystem& GetJobSystem() { return *m_jobSystem; }
+		inline GeometrySystem& GetGeometrySystem() { return *m_geometrySystem; }
+		inline TextureSystem& GetTextureSystem() { return *m_textureSystem; }
+		inline uint64_t GetFrameIndex() const { return m_frameIndex; }
 		
 		std::shared_ptr<Scene> m_activeScene;
 
 	protected:
+		std::unique_ptr<TextureSystem> m_textureSystem;
 		std::unique_ptr<GeometrySystem> m_geometrySystem;
 
 	private:
@@ -38,6 +50,14 @@ namespace mz {
 		int16_t m_width;
 		int16_t m_height;
 
+		LinearAllocator m_frameAllocator;
+		std::unique_ptr<JobSystem> m_jobSystem;
+		AssetManifest m_assetManifest;
+		uint64_t m_frameIndex = 0;
+		uint64_t m_lastAllocationCount = 0;
+
+		void BeginFrame();
+
 		bool OnWindowClose(WindowCloseEvent& e);
 		bool OnWindowResize(WindowResizeEvent& e);
 	
@@ -44,14 +44,12 @@ namespace mz {
 	};
 
 	class EventDispatcher {
-		template<typename T>
-		using EventFn = std::function<bool(T&)>;
-
 	public:
 		EventDispatcher(Event& event) : m_event(event) {}
 
-		template<typename T>
-		bool Dispatch(EventFn<T> func) {
+		// Takes the handler by template parameter so dispatching never wraps it in a std::function
+		template<typename T, typename F>
+		bool Dispatch(const F& func) {
 			if (m_event.GetEventType() == T::GetStaticType()) {
 				m_event.Handled = func(*(T*)&m_event);
 				return true;
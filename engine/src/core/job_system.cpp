@@ -0,0 +1,71 @@
+#include "job_system.h"
+
+namespace mz {
+	JobSystem::JobSystem(uint32_t workerCount)
+	{
+		workerCount = std::max(workerCount, 1u);
+		m_workers.reserve(workerCount);
+		for (uint32_t i = 0; i < workerCount; ++i) {
+			m_workers.emplace_back(&JobSystem::WorkerLoop, this);
+		}
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopping = true;
+		}
+		m_jobAvailable.notify_all();
+
+		// Workers drain the queue before exiting
+		for (std::thread& worker : m_workers) {
+			worker.join();
+		}
+	}
+
+	void JobSystem::Submit(std::function<void()> job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_jobs.push_back(std::move(job));
+		}
+		m_jobAvailable.notify_one();
+	}
+
+	void JobSystem::WaitIdle()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_idle.wait(lock, [this] { return m_jobs.empty() && m_runningJobs == 0; });
+	}
+
+	void JobSystem::WorkerLoop()
+	{
+		while (true) {
+			std::function<void()> job;
+
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_jobAvailable.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+
+				if (m_jobs.empty()) {
+					return;
+				}
+
+				job = std::move(m_jobs.front());
+				m_jobs.pop_front();
+				++m_runningJobs;
+			}
+
+			job();
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				--m_runningJobs;
+				if (m_jobs.empty() && m_runningJobs == 0) {
+					m_idle.notify_all();
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+
+namespace mz {
+	// Fixed pool of worker threads consuming a shared FIFO of jobs.
+	// Meant for coarse work such as asset loading, jobs must not touch GPU or scene state.
+	class JobSystem {
+	public:
+		explicit JobSystem(uint32_t workerCount);
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		void Submit(std::function<void()> job);
+		// Blocks until the queue is empty and no job is running
+		void WaitIdle();
+
+		inline uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+
+	private:
+		std::vector<std::thread> m_workers;
+		std::deque<std::function<void()>> m_jobs;
+
+		std::mutex m_mutex;
+		std::condition_variable m_jobAvailable;
+		std::condition_variable m_idle;
+		uint32_t m_runningJobs = 0;
+		bool m_stopping = false;
+
+		void WorkerLoop();
+	};
+}
@@ -0,0 +1,60 @@
+#include "linear_allocator.h"
+#include "engine/src/core/log.h"
+
+namespace mz {
+	LinearAllocator::LinearAllocator(size_t capacity) : m_capacity(capacity)
+	{
+		m_buffer = static_cast<uint8_t*>(::operator new(capacity, std::align_val_t{ alignof(std::max_align_t) }));
+	}
+
+	LinearAllocator::~LinearAllocator()
+	{
+		FreeOverflowBlocks();
+		::operator delete(m_buffer, std::align_val_t{ alignof(std::max_align_t) });
+	}
+
+	void* LinearAllocator::Allocate(size_t size, size_t alignment)
+	{
+		size_t alignedOffset = (m_offset + alignment - 1) & ~(alignment - 1);
+
+		if (alignedOffset + size <= m_capacity) {
+			m_offset = alignedOffset + size;
+			m_peak = std::max(m_peak, GetUsed());
+			return m_buffer + alignedOffset;
+		}
+
+		// Out of space for this frame, serve the request from the heap and remember to grow
+		void* block = ::operator new(size + alignment);
+		m_overflowBlocks.push_back(block);
+		m_overflowBytes += size + alignment;
+		m_peak = std::max(m_peak, GetUsed());
+
+		uintptr_t address = reinterpret_cast<uintptr_t>(block);
+		return reinterpret_cast<void*>((address + alignment - 1) & ~(uintptr_t)(alignment - 1));
+	}
+
+	void LinearAllocator::Reset()
+	{
+		if (!m_overflowBlocks.empty()) {
+			FreeOverflowBlocks();
+
+			size_t newCapacity = std::max(m_peak, m_capacity * 2);
+			MZ_CORE_WARN("Linear allocator overflowed, growing from {0} to {1} bytes", m_capacity, newCapacity);
+
+			::operator delete(m_buffer, std::align_val_t{ alignof(std::max_align_t) });
+			m_buffer = static_cast<uint8_t*>(::operator new(newCapacity, std::align_val_t{ alignof(std::max_align_t) }));
+			m_capacity = newCapacity;
+		}
+
+		m_offset = 0;
+	}
+
+	void LinearAllocator::FreeOverflowBlocks()
+	{
+		for (void* block : m_overflowBlocks) {
+			::operator delete(block);
+		}
+		m_overflowBlocks.clear();
+		m_overflowBytes = 0;
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+
+namespace mz {
+	// Bump allocator for transient data that lives at most one frame.
+	// Allocation is a pointer increment and Reset() releases everything at once.
+	// Requests that do not fit spill into overflow blocks, and the next Reset()
+	// grows the main block to the observed peak, so steady-state frames never touch the heap.
+	class LinearAllocator {
+	public:
+		explicit LinearAllocator(size_t capacity);
+		~LinearAllocator();
+
+		LinearAllocator(const LinearAllocator&) = delete;
+		LinearAllocator& operator=(const LinearAllocator&) = delete;
+
+		void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+		// Memory is uninitialized, only use with trivially constructible types
+		template<typename T>
+		T* AllocateArray(size_t count)
+		{
+			static_assert(std::is_trivially_destructible_v<T>, "Linear allocator never runs destructors!");
+			return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		void Reset();
+
+		inline size_t GetCapacity() const { return m_capacity; }
+		inline size_t GetUsed() const { return m_offset + m_overflowBytes; }
+		inline size_t GetPeak() const { return m_peak; }
+
+	private:
+		uint8_t* m_buffer = nullptr;
+		size_t m_capacity = 0;
+		size_t m_offset = 0;
+		size_t m_peak = 0;
+
+		std::vector<void*> m_overflowBlocks;
+		size_t m_overflowBytes = 0;
+
+		void FreeOverflowBlocks();
+	};
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "engine/src/asserts.h"
+
+namespace mz {
+	// 32-bit generational handle into a SlotMap. The low 24 bits are the slot index, the high 8 bits
+	// the generation the slot had when the handle was issued. Handles to freed slots stop resolving
+	// once the slot is reused, instead of aliasing the new occupant.
+	// Tag only keeps handles of different resource types from converting into each other.
+	template<typename Tag>
+	struct Handle {
+		static constexpr uint32_t s_indexBits = 24;
+		static constexpr uint32_t s_indexMask = (1u << s_indexBits) - 1;
+		static constexpr uint32_t s_invalidValue = std::numeric_limits<uint32_t>::max();
+		// The all-ones index is reserved so that no live handle can equal the invalid value
+		static constexpr uint32_t s_maxSlots = s_indexMask;
+
+		uint32_t value = s_invalidValue;
+
+		inline static Handle Make(uint32_t index, uint8_t generation) { return { (static_cast<uint32_t>(generation) << s_indexBits) | index }; }
+
+		inline uint32_t GetIndex() const { return value & s_indexMask; }
+		inline uint8_t GetGeneration() const { return static_cast<uint8_t>(value >> s_indexBits); }
+		inline bool IsValid() const { return value != s_invalidValue; }
+
+		inline bool operator==(const Handle& other) const { return value == other.value; }
+		inline bool operator!=(const Handle& other) const { return value != other.value; }
+	};
+
+	// Slot array with a free list and a reference count per slot. Lookups are a bounds and generation
+	// check plus an array access, and freed slots are reused before the array grows.
+	template<typename T, typename Tag>
+	class SlotMap {
+	public:
+		using HandleType = Handle<Tag>;
+
+		// Inserts with a reference count of one
+		HandleType Insert(T value)
+		{
+			uint32_t index;
+			if (!m_freeSlots.empty()) {
+				index = m_freeSlots.back();
+				m_freeSlots.pop_back();
+			}
+			else {
+				MZ_ASSERT_MSG(m_slots.size() < HandleType::s_maxSlots, "Slot map is full!");
+				index = static_cast<uint32_t>(m_slots.size());
+				m_slots.emplace_back();
+			}
+
+			Slot& slot = m_slots[index];
+			slot.value = std::move(value);
+			slot.refCount = 1;
+			slot.occupied = true;
+			++m_size;
+
+			return HandleType::Make(index, slot.generation);
+		}
+
+		// Frees the slot regardless of its reference count, outstanding handles stop resolving
+		void Remove(HandleType handle)
+		{
+			Slot* slot = Resolve(handle);
+			if (!slot) {
+				return;
+			}
+
+			slot->value = T();
+			slot->refCount = 0;
+			slot->occupied = false;
+			// Wraps after 256 reuses of the same slot, which is enough to catch stale handles in practice
+			++slot->generation;
+			m_freeSlots.push_back(handle.GetIndex());
+			--m_size;
+		}
+
+		inline T* Get(HandleType handle) { Slot* slot = Resolve(handle); return slot ? &slot->value : nullptr; }
+		inline const T* Get(HandleType handle) const { const Slot* slot = Resolve(handle); return slot ? &slot->value : nullptr; }
+		inline bool Contains(HandleType handle) const { return Resolve(handle) != nullptr; }
+
+		// Both return the new count, or zero for stale handles
+		uint32_t AddRef(HandleType handle)
+		{
+			Slot* slot = Resolve(handle);
+			return slot ? ++slot->refCount : 0;
+		}
+
+		uint32_t Release(HandleType handle)
+		{
+			Slot* slot = Resolve(handle);
+			if (!slot || slot->refCount == 0) {
+				return 0;
+			}
+			return --slot->refCount;
+		}
+
+		inline uint32_t GetRefCount(HandleType handle) const { const Slot* slot = Resolve(handle); return slot ? slot->refCount : 0; }
+		inline uint32_t Size() const { return m_size; }
+		inline uint32_t Capacity() const { return static_cast<uint32_t>(m_slots.size()); }
+
+		// Visits every occupied slot with its handle
+		template<typename F>
+		void ForEach(const F& function)
+		{
+			for (uint32_t i = 0; i < m_slots.size(); ++i) {
+				if (m_slots[i].occupied) {
+					function(HandleType::Make(i, m_slots[i].generation), m_slots[i].value);
+				}
+			}
+		}
+
+		template<typename F>
+		void ForEach(const F& function) const
+		{
+			for (uint32_t i = 0; i < m_slots.size(); ++i) {
+				if (m_slots[i].occupied) {
+					function(HandleType::Make(i, m_slots[i].generation), m_slots[i].value);
+				}
+			}
+		}
+
+		void Clear()
+		{
+			m_slots.clear();
+			m_freeSlots.clear();
+			m_size = 0;
+		}
+
+	private:
+		struct Slot {
+			T value = T();
+			uint32_t refCount = 0;
+			uint8_t generation = 0;
+			bool occupied = false;
+		};
+
+		std::vector<Slot> m_slots;
+		std::vector<uint32_t> m_freeSlots;
+		uint32_t m_size = 0;
+
+		inline Slot* Resolve(HandleType handle) { return const_cast<Slot*>(static_cast<const SlotMap*>(this)->Resolve(handle)); }
+		inline const Slot* Resolve(HandleType handle) const
+		{
+			uint32_t index = handle.GetIndex();
+			if (!handle.IsValid() || index >= m_slots.size()) {
+				return nullptr;
+			}
+
+			const Slot& slot = m_slots[index];
+			return slot.occupied && slot.generation == handle.GetGeneration() ? &slot : nullptr;
+		}
+	};
+}
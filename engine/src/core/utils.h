@@ -8,4 +8,42 @@ namespace mz {
 		seed ^= std::hash<T>{}(v)+0x9e3779b9 + (seed << 6) + (seed >> 2);
 		(HashCombine(seed, rest), ...);
 	};
-}
\ No newline at end of file
+
+	// 64-bit non-cryptographic hash of raw bytes (MurmurHash64A), used for content addressing
+	inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0)
+	{
+		const uint64_t m = 0xc6a4a7935bd1e995ull;
+		const int r = 47;
+
+		uint64_t h = seed ^ (size * m);
+
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		const uint8_t* end = bytes + (size & ~size_t(7));
+
+		for (; bytes != end; bytes += 8) {
+			uint64_t k;
+			memcpy(&k, bytes, sizeof(k));
+
+			k *= m;
+			k ^= k >> r;
+			k *= m;
+
+			h ^= k;
+			h *= m;
+		}
+
+		size_t remaining = size & 7;
+		if (remaining) {
+			uint64_t k = 0;
+			memcpy(&k, bytes, remaining);
+			h ^= k;
+			h *= m;
+		}
+
+		h ^= h >> r;
+		h *= m;
+		h ^= h >> r;
+
+		return h;
+	}
+}
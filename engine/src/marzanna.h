@@ -3,6 +3,13 @@
 #include "defines.h"
 #include "core/log.h"
 #include "core/log.cpp"
+#include "core/allocation_tracker.h"
+#include "core/allocation_tracker.cpp"
+#include "core/linear_allocator.h"
+#include "core/linear_allocator.cpp"
+#include "core/slot_map.h"
+#include "core/job_system.h"
+#include "core/job_system.cpp"
 #include "core/window.h"
 #include "core/entry.h"
 #include "core/application.h"
@@ -18,9 +25,28 @@
 #include "core/uuid.cpp"
 #include "system/file_reader.h"
 #include "system/file_reader.cpp"
+#include "system/mapped_file.h"
+#include "system/mapped_file.cpp"
+#include "system/mesh_file.h"
+#include "system/mesh_file.cpp"
+#include "system/vertex_deduplicator.h"
+#include "system/mesh_importer.h"
+#include "system/mesh_importer.cpp"
+#include "system/texture_file.h"
+#include "system/texture_file.cpp"
+#include "system/asset_manifest.h"
+#include "system/asset_manifest.cpp"
+#include "system/texture_system.h"
+#include "system/texture_system.cpp"
 #include "system/geometry_system.h"
 #include "system/geometry_system.cpp"
 #include "system/scene/components.h"
+#include "system/scene/transform_batch.h"
+#include "system/scene/transform_batch.cpp"
+#include "system/scene/render_proxy.h"
+#include "system/scene/render_proxy.cpp"
+#include "system/scene/transform_hierarchy.h"
+#include "system/scene/transform_hierarchy.cpp"
 #include "system/scene/scene.h"
 #include "system/scene/scene.cpp"
 #include "system/scene/entity.h"
@@ -42,6 +68,8 @@
 #include "renderer/geometry.cpp"
 #include "renderer/perspective_camera.h"
 #include "renderer/perspective_camera.cpp"
+#include "renderer/frustum.h"
+#include "renderer/frustum.cpp"
 #include "renderer/vulkan/vulkan_context.h"
 #include "renderer/vulkan/vulkan_renderer_backend.h"
 #include "renderer/vulkan/vulkan_renderer_backend.cpp"
@@ -54,6 +82,16 @@
 #include "renderer/vulkan/vulkan_swap_chain.cpp"
 #include "renderer/vulkan/vulkan_pipeline.h"
 #include "renderer/vulkan/vulkan_pipeline.cpp"
+#include "renderer/vulkan/vulkan_object_staging.h"
+#include "renderer/vulkan/vulkan_object_staging.cpp"
+#include "renderer/vulkan/vulkan_object_buffer.h"
+#include "renderer/vulkan/vulkan_object_buffer.cpp"
+#include "renderer/vulkan/vulkan_depth_pyramid.h"
+#include "renderer/vulkan/vulkan_depth_pyramid.cpp"
+#include "renderer/vulkan/vulkan_meshlet_culler.h"
+#include "renderer/vulkan/vulkan_meshlet_culler.cpp"
+#include "renderer/vulkan/vulkan_occlusion_queries.h"
+#include "renderer/vulkan/vulkan_occlusion_queries.cpp"
 #include "renderer/vulkan/vulkan_render_pass.h"
 #include "renderer/vulkan/vulkan_render_pass.cpp"
 #include "renderer/vulkan/vulkan_texture.h"
@@ -0,0 +1,29 @@
+#include "frustum.h"
+
+namespace mz {
+	Frustum::Frustum(const glm::mat4& viewProjection)
+	{
+		glm::mat4 rows = glm::transpose(viewProjection);
+
+		planes[0] = rows[3] + rows[0]; // left
+		planes[1] = rows[3] - rows[0]; // right
+		planes[2] = rows[3] + rows[1]; // bottom
+		planes[3] = rows[3] - rows[1]; // top
+		planes[4] = rows[2];           // near, clip space depth runs from 0 to 1
+		planes[5] = rows[3] - rows[2]; // far
+
+		for (glm::vec4& plane : planes) {
+			plane /= glm::length(glm::vec3(plane));
+		}
+	}
+
+	bool Frustum::IntersectsSphere(const glm::vec3& center, float radius) const
+	{
+		for (const glm::vec4& plane : planes) {
+			if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+				return false;
+			}
+		}
+		return true;
+	}
+}
\ No newline at end of file
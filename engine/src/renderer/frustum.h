@@ -0,0 +1,16 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+
+namespace mz {
+	// View frustum as six planes with inward facing normals in xyz and the distance in w
+	struct Frustum {
+		std::array<glm::vec4, 6> planes;
+
+		Frustum() = default;
+		// Planes are taken from the rows of the matrix, the result is in the space the matrix maps from
+		explicit Frustum(const glm::mat4& viewProjection);
+
+		bool IntersectsSphere(const glm::vec3& center, float radius) const;
+	};
+}
\ No newline at end of file
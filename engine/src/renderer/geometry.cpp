@@ -5,11 +5,17 @@ namespace mz {
 	Geometry::~Geometry()
 	{
 	}
-	Geometry* Geometry::Create(std::vector<Vertex3d> vertices, std::vector<uint32_t> indices, std::string textureName)
+	Geometry* Geometry::Create(const GeometryData& data, const Texture* texture)
 	{
 		switch (Application::Get().GetRenderApiType()) {
-			case RenderApiType::Vulkan:
-				return new VulkanGeometry(vertices, indices, textureName);
+			case RenderApiType::Vulkan: {
+				VulkanGeometry* geometry = new VulkanGeometry(data, texture);
+				if (!geometry->IsCreated()) {
+					delete geometry;
+					return nullptr;
+				}
+				return geometry;
+			}
 			default:
 				throw std::runtime_error("No render API type specified for geometry creation!");
 		}
@@ -2,12 +2,90 @@
 
 #include "engine/src/mzpch.h"
 #include "render_types.h"
+#include "texture.h"
+#include "engine/src/core/slot_map.h"
 
 namespace mz {
+	class Geometry;
+
+	// Reference to a geometry owned by the GeometrySystem. Stays valid while the geometry is
+	// loading, the system resolves it to a placeholder until the real mesh has been uploaded.
+	using GeometryHandle = Handle<Geometry>;
+
+	// Index range drawn with its own vertex offset, the indices are relative to firstVertex
+	struct GeometrySubmesh {
+		uint32_t firstIndex = 0;
+		uint32_t indexCount = 0;
+		uint32_t firstVertex = 0;
+		// Submeshes are ordered by slot, so runs sharing a material are adjacent
+		uint32_t materialSlot = 0;
+		// Object space
+		glm::vec3 boundsMin = glm::vec3(0.0f);
+		glm::vec3 boundsMax = glm::vec3(0.0f);
+	};
+
+	// Run of submeshes drawn together, a geometry has one per level of detail, finest first
+	struct GeometryLod {
+		uint32_t firstSubmesh = 0;
+		uint32_t submeshCount = 0;
+		// Object space distance the LOD may deviate from the full detail surface
+		float error = 0.0f;
+		// Meshlets covering the LOD's submeshes, none draws the submeshes whole
+		uint32_t firstMeshlet = 0;
+		uint32_t meshletCount = 0;
+	};
+
+	// Vertex and index data of a geometry to upload
+	struct GeometryData {
+		VertexFormat vertexFormat = VertexFormat::Float;
+		// Vertex3d or PackedVertex3d depending on vertexFormat
+		const void* vertices = nullptr;
+		uint32_t vertexCount = 0;
+		// uint16_t or uint32_t depending on indexStride
+		const void* indices = nullptr;
+		uint32_t indexCount = 0;
+		uint32_t indexStride = sizeof(uint32_t);
+		// Empty draws all indices as one submesh at vertex offset zero with the geometry's bounds
+		std::vector<GeometrySubmesh> submeshes;
+		// Empty draws all submeshes as the only LOD
+		std::vector<GeometryLod> lods;
+		// Referenced by the LODs, may be null
+		const Meshlet* meshlets = nullptr;
+		uint32_t meshletCount = 0;
+		// Object space bounds, packed positions are stored relative to them
+		glm::vec3 boundsMin = glm::vec3(0.0f);
+		glm::vec3 boundsMax = glm::vec3(0.0f);
+	};
+
 	class Geometry {
 	public:
 		virtual ~Geometry();
-		virtual void Draw(glm::mat4 model) const = 0;
-		static Geometry* Create(std::vector<Vertex3d> vertices, std::vector<uint32_t> indices, std::string textureName);
+		// Draws the submeshes of the given LOD with the transform stored at objectIndex in the GPU object buffer.
+		// LODs past the coarsest draw the coarsest.
+		virtual void Draw(uint32_t objectIndex, uint32_t lod) const = 0;
+		// Depth only draw for the depth prepass, fetches nothing but positions
+		virtual void DrawDepth(uint32_t objectIndex, uint32_t lod) const = 0;
+		// Records GPU culling of the LOD's meshlets for the object, this frame's Draw and DrawDepth of it then only
+		// draw the meshlets that passed. Returns false, recording nothing, when the LOD has no meshlets. With
+		// occlusion culling it is called again in the late phase, whose draws then only add what that phase found.
+		virtual bool CullMeshlets(uint32_t objectIndex, uint32_t lod) const = 0;
+		// Takes effect from the next frame, the previous texture must stay alive until the frames in flight have finished
+		virtual void SetTexture(const Texture* texture) = 0;
+		// GPU memory backing the vertex, index and meshlet buffers
+		virtual uint64_t GetSizeBytes() const = 0;
+		inline const std::vector<GeometrySubmesh>& GetSubmeshes() const { return m_submeshes; }
+		inline const std::vector<GeometryLod>& GetLods() const { return m_lods; }
+		// Object space bounds of the full detail geometry
+		inline const glm::vec3& GetBoundsMin() const { return m_boundsMin; }
+		inline const glm::vec3& GetBoundsMax() const { return m_boundsMax; }
+		// Vertex and index data is copied into GPU buffers, it only has to stay valid for the duration of the call.
+		// The texture is shared and must outlive the geometry.
+		static Geometry* Create(const GeometryData& data, const Texture* texture);
+	protected:
+		// Submeshes of every LOD, neither is empty once created
+		std::vector<GeometrySubmesh> m_submeshes;
+		std::vector<GeometryLod> m_lods;
+		glm::vec3 m_boundsMin = glm::vec3(0.0f);
+		glm::vec3 m_boundsMax = glm::vec3(0.0f);
 	};
 }
\ No newline at end of file
@@ -13,6 +13,10 @@ namespace mz {
 
         inline const glm::mat4& GetViewMatrix() const { return m_viewMatrix; }
         inline const glm::mat4& GetProjectionMatrix() const { return m_projectionMatrix; }
+        inline const glm::vec3& GetPosition() const { return m_position; }
+        // Vertical field of view in degrees
+        inline float GetFOV() const { return m_fov; }
+        inline float GetNearClip() const { return m_nearClip; }
 	private:
         void UpdateViewMatrix();
         void UpdateProjectionMatrix();
@@ -35,7 +35,7 @@ namespace mz {
 		m_rendererBackend->Shutdown();
 	}
 	
-	bool RenderAPI::DrawFrame(RenderApiDrawCallArgs args) {
+	bool RenderAPI::DrawFrame(const RenderApiDrawCallArgs& args) {
 		if (m_rendererBackend->BeginFrame()) {
 			RendererGlobalState globalState = {};
 			RendererGeometryData geometryData = {};
@@ -43,12 +43,153 @@ namespace mz {
 			globalState.projection = testCamera->GetProjectionMatrix();
 			globalState.view = testCamera->GetViewMatrix();
 
-			for (GeometryWithPosition geometryToDraw : args.geometries) {
-				geometryToDraw.geometry->Draw(geometryToDraw.model);
+			// Object records are copied before the render pass begins, only the changed ones are uploaded
+			RendererObjectData objects;
+			objects.transforms = args.transforms;
+			objects.count = args.count;
+			objects.dirtyIndices = args.dirtyIndices;
+			objects.dirtyCount = args.dirtyCount;
+			bool objectsUploaded = m_rendererBackend->UploadObjects(objects);
+
+			// Records past the buffer's contents would be read out of bounds, the frame is still presented empty
+			RenderApiDrawCallArgs drawArgs = args;
+			if (!objectsUploaded) {
+				MZ_CORE_ERROR("Failed to upload object data!");
+				drawArgs.count = 0;
+			}
+
+			PrepareOcclusionQueries(drawArgs);
+
+			if (m_meshletCullingEnabled) {
+				CullMeshlets(drawArgs, globalState);
+			}
+
+			m_rendererBackend->BeginMainRenderPass(m_depthPrepassEnabled);
+			DrawObjects(drawArgs);
+
+			// Meshlets the previous frame's depth hid are tested again against the depth drawn so far
+			if (m_rendererBackend->BeginLateCulling()) {
+				for (uint32_t i = 0; i < drawArgs.count; ++i) {
+					if (!IsHidden(i)) {
+						drawArgs.geometries[i]->CullMeshlets(i, drawArgs.lods ? drawArgs.lods[i] : 0);
+					}
+				}
+				m_rendererBackend->EndCulling();
+
+				m_rendererBackend->ResumeMainRenderPass(m_depthPrepassEnabled);
+				DrawObjects(drawArgs);
+			}
+
+			// Tested against the frame's complete depth, the results decide a later frame's draws
+			if (!m_occlusionQueries.empty()) {
+				m_rendererBackend->DrawOcclusionQueries(m_occlusionQueries.data(), static_cast<uint32_t>(m_occlusionQueries.size()),
+					globalState.projection * globalState.view);
 			}
 
 			m_rendererBackend->UpdateGlobalState(globalState);
-			return m_rendererBackend->EndFrame();
+
+			// Report a failed upload so the caller keeps its change list for the next frame
+			return m_rendererBackend->EndFrame() && objectsUploaded;
+		}
+
+		return false;
+	}
+
+	void RenderAPI::PrepareOcclusionQueries(const RenderApiDrawCallArgs& args)
+	{
+		m_occlusionQueries.clear();
+		m_queryHidden.clear();
+		if (!m_occlusionQueriesEnabled || !args.occlusionQueries) {
+			return;
+		}
+
+		m_queryHidden.assign(args.count, 0);
+		glm::vec3 cameraPosition = testCamera->GetPosition();
+		// Twice the near clip distance reaches the corners of the near plane at any usual field of view
+		float margin = 2.0f * testCamera->GetNearClip();
+
+		for (uint32_t i = 0; i < args.count; ++i) {
+			uint32_t key = args.occlusionQueries[i];
+			if (key == 0) {
+				continue;
+			}
+
+			const Geometry* geometry = args.geometries[i];
+			const glm::mat4& model = args.transforms[i];
+			glm::vec3 center = 0.5f * (geometry->GetBoundsMin() + geometry->GetBoundsMax());
+			glm::vec3 extent = 0.5f * (geometry->GetBoundsMax() - geometry->GetBoundsMin());
+			glm::vec3 worldCenter = glm::vec3(model * glm::vec4(center, 1.0f));
+			glm::vec3 worldExtent = glm::abs(glm::vec3(model[0])) * extent.x
+				+ glm::abs(glm::vec3(model[1])) * extent.y
+				+ glm::abs(glm::vec3(model[2])) * extent.z;
+
+			// From inside its bounds, or with the near plane cutting them, the box no longer covers the object's
+			// visible surfaces. Such objects are drawn unguarded.
+			if (glm::all(glm::lessThanEqual(glm::abs(cameraPosition - worldCenter), worldExtent + margin))) {
+				continue;
+			}
+
+			// Hidden objects are queried all the same, that is how they come back into view
+			m_queryHidden[i] = m_rendererBackend->IsObjectOccluded(i, key) ? 1 : 0;
+
+			RendererOcclusionQuery query;
+			query.objectIndex = i;
+			query.key = key;
+			query.boundsMin = geometry->GetBoundsMin();
+			query.boundsMax = geometry->GetBoundsMax();
+			m_occlusionQueries.push_back(query);
+		}
+	}
+
+	void RenderAPI::CullMeshlets(const RenderApiDrawCallArgs& args, const RendererGlobalState& globalState)
+	{
+		// The backend sizes its buffers for the whole frame up front, the geometries then fill their ranges
+		RendererCullingState state;
+		state.viewProjection = globalState.projection * globalState.view;
+		state.cameraPosition = testCamera->GetPosition();
+		state.objectCount = args.count;
+		state.occlusion = m_occlusionCullingEnabled;
+		for (uint32_t i = 0; i < args.count; ++i) {
+			if (IsHidden(i)) {
+				continue;
+			}
+
+			const std::vector<GeometryLod>& lods = args.geometries[i]->GetLods();
+			const GeometryLod& lod = lods[std::min<size_t>(args.lods ? args.lods[i] : 0, lods.size() - 1)];
+			if (lod.meshletCount > 0) {
+				state.meshletCount += lod.meshletCount;
+				++state.culledObjectCount;
+			}
+		}
+
+		if (state.meshletCount == 0 || !m_rendererBackend->BeginCulling(state)) {
+			return;
+		}
+
+		for (uint32_t i = 0; i < args.count; ++i) {
+			if (!IsHidden(i)) {
+				args.geometries[i]->CullMeshlets(i, args.lods ? args.lods[i] : 0);
+			}
+		}
+
+		m_rendererBackend->EndCulling();
+	}
+
+	void RenderAPI::DrawObjects(const RenderApiDrawCallArgs& args)
+	{
+		if (m_depthPrepassEnabled) {
+			for (uint32_t i = 0; i < args.count; ++i) {
+				if (!IsHidden(i)) {
+					args.geometries[i]->DrawDepth(i, args.lods ? args.lods[i] : 0);
+				}
+			}
+			m_rendererBackend->EndDepthPrepass();
+		}
+
+		for (uint32_t i = 0; i < args.count; ++i) {
+			if (!IsHidden(i)) {
+				args.geometries[i]->Draw(i, args.lods ? args.lods[i] : 0);
+			}
 		}
 	}
 }
\ No newline at end of file
@@ -16,13 +16,20 @@ namespace mz {
 		const Window* window;
 	};
 
-	struct GeometryWithPosition {
-		const Geometry* geometry;
-		glm::mat4 model;
-	};
-
+	// Views into the scene's persistent render proxies, valid for the duration of the call
 	struct RenderApiDrawCallArgs {
-		std::vector<GeometryWithPosition> geometries;
+		const glm::mat4* transforms = nullptr;
+		const Geometry* const* geometries = nullptr;
+		// LOD to draw per object, null draws full detail
+		const uint8_t* lods = nullptr;
+		// Occlusion query key per object, zero draws the object unguarded and null guards none. See
+		// RenderProxyList::GetOcclusionQueries().
+		const uint32_t* occlusionQueries = nullptr;
+		uint32_t count = 0;
+
+		// Indices of transforms that changed since the last successful DrawFrame
+		const uint32_t* dirtyIndices = nullptr;
+		uint32_t dirtyCount = 0;
 	};
 
 	class RenderAPI {
@@ -30,11 +37,43 @@ namespace mz {
 		RenderAPI(const RenderApiArgs args);
 		bool Initialize();
 		void Shutdown();
-		bool DrawFrame(RenderApiDrawCallArgs args);
+		bool DrawFrame(const RenderApiDrawCallArgs& args);
 		void OnResize();
 		inline RenderApiType GetType() { return RenderApiType::Vulkan; }
+		inline const RendererFrameStats& GetFrameStats() const { return m_rendererBackend->GetFrameStats(); }
+		inline const PerspectiveCamera& GetCamera() const { return *testCamera; }
+		// Lays down depth with position only draws before shading, so every pixel is shaded once
+		inline void SetDepthPrepassEnabled(bool enabled) { m_depthPrepassEnabled = enabled; }
+		inline bool IsDepthPrepassEnabled() const { return m_depthPrepassEnabled; }
+		// Culls the meshlets of geometries that have them on the GPU, where the device supports it. Geometries
+		// without cooked meshlets are culled by their submeshes' bounds.
+		inline void SetMeshletCullingEnabled(bool enabled) { m_meshletCullingEnabled = enabled; }
+		inline bool IsMeshletCullingEnabled() const { return m_meshletCullingEnabled; }
+		// Also culls meshlets hidden behind the previous frame's depth, drawing what turns out visible in a second
+		// pass. Only takes effect with meshlet culling.
+		inline void SetOcclusionCullingEnabled(bool enabled) { m_occlusionCullingEnabled = enabled; }
+		inline bool IsOcclusionCullingEnabled() const { return m_occlusionCullingEnabled; }
+		// Skips the draws of objects guarded by an occlusion query while their last finished query found them
+		// hidden. The results are a few frames old, objects coming into view may appear that much late.
+		inline void SetOcclusionQueriesEnabled(bool enabled) { m_occlusionQueriesEnabled = enabled; }
+		inline bool IsOcclusionQueriesEnabled() const { return m_occlusionQueriesEnabled; }
 	private:
 		std::unique_ptr<RendererBackend> m_rendererBackend;
+		bool m_depthPrepassEnabled = true;
+		bool m_meshletCullingEnabled = true;
+		bool m_occlusionCullingEnabled = true;
+		bool m_occlusionQueriesEnabled = true;
+
+		// The frame's occlusion queries, and per object whether the last results hide it, empty when none is guarded
+		std::vector<RendererOcclusionQuery> m_occlusionQueries;
+		std::vector<uint8_t> m_queryHidden;
+
+		// Lists the guarded objects to query this frame and marks those the last results hide
+		void PrepareOcclusionQueries(const RenderApiDrawCallArgs& args);
+		inline bool IsHidden(uint32_t objectIndex) const { return !m_queryHidden.empty() && m_queryHidden[objectIndex]; }
+		void CullMeshlets(const RenderApiDrawCallArgs& args, const RendererGlobalState& globalState);
+		// Records the depth prepass, if enabled, and the shading draws of every object
+		void DrawObjects(const RenderApiDrawCallArgs& args);
 
 		PerspectiveCamera* testCamera;
 	};
@@ -14,24 +14,112 @@ namespace mz {
 		glm::vec3 color;
 		glm::vec3 normal;
 		glm::vec2 texCoord;
+	};
+
+	// Quantized counterpart of Vertex3d, 20 instead of 44 bytes. Positions are unsigned normalized within
+	// the mesh bounds (w is padding), normals octahedral encoded in signed normalized xy, texture
+	// coordinates half floats.
+	struct PackedVertex3d {
+		uint16_t pos[4];
+		uint8_t color[4];
+		int16_t normal[2];
+		uint16_t texCoord[2];
+	};
+
+	// Vertex layouts a geometry can be stored in. Values are stored in .mzmesh files, only append.
+	enum class VertexFormat : uint32_t {
+		Float = 0,
+		Packed = 1
+	};
+
+	static constexpr uint32_t s_vertexFormatCount = 2;
 
-		bool operator==(const Vertex3d& other) const {
-			return pos == other.pos && color == other.color && texCoord == other.texCoord;
+	inline uint32_t GetVertexStride(VertexFormat format)
+	{
+		switch (format) {
+		case VertexFormat::Float: return sizeof(Vertex3d);
+		case VertexFormat::Packed: return sizeof(PackedVertex3d);
 		}
+
+		return 0;
+	}
+
+	// Geometry is uploaded as two vertex streams, the position that leads every layout and the remaining
+	// attributes, so that depth only passes fetch positions alone
+	inline uint32_t GetPositionStride(VertexFormat format)
+	{
+		switch (format) {
+		case VertexFormat::Float: return sizeof(Vertex3d::pos);
+		case VertexFormat::Packed: return sizeof(PackedVertex3d::pos);
+		}
+
+		return 0;
+	}
+
+	static_assert(offsetof(Vertex3d, pos) == 0 && offsetof(PackedVertex3d, pos) == 0, "Positions must lead the vertex layouts");
+
+	// Texel formats shared by the cooked texture container and the renderer.
+	// Values are stored in .mztex files, only append.
+	enum class TextureFormat : uint32_t {
+		RGBA8_SRGB = 0,
+		// Block compressed, 4x4 texel blocks of 8 (BC1) or 16 (BC3, BC7) bytes
+		BC1_RGB_SRGB = 1,
+		BC3_SRGB = 2,
+		BC7_SRGB = 3
 	};
 
+	inline bool IsBlockCompressed(TextureFormat format)
+	{
+		return format != TextureFormat::RGBA8_SRGB;
+	}
+
+	// Bytes one mip level of the given size occupies in upload layout, 0 for unknown formats
+	inline uint64_t GetTextureLevelSize(TextureFormat format, uint32_t width, uint32_t height)
+	{
+		uint64_t blocksX = (uint64_t(width) + 3) / 4;
+		uint64_t blocksY = (uint64_t(height) + 3) / 4;
+
+		switch (format) {
+		case TextureFormat::RGBA8_SRGB: return uint64_t(width) * height * 4;
+		case TextureFormat::BC1_RGB_SRGB: return blocksX * blocksY * 8;
+		case TextureFormat::BC3_SRGB:
+		case TextureFormat::BC7_SRGB: return blocksX * blocksY * 16;
+		}
+
+		return 0;
+	}
+
 	struct UniformBufferObject {
 		alignas(16) glm::mat4 view;
 		alignas(16) glm::mat4 proj;
 	};
-}
 
-namespace std {
-	template<> struct hash<mz::Vertex3d> {
-		size_t operator()(mz::Vertex3d const& vertex) const {
-			size_t seed = 0;
-			mz::HashCombine(seed, vertex.pos, vertex.color, vertex.texCoord);
-			return seed;
-		}
+	// Run of up to s_maxMeshletTriangles triangles over up to s_maxMeshletVertices vertices of one submesh, culled as a
+	// unit on the GPU. Stored as is in .mzmesh files and uploaded unchanged, the layout matches the std430 struct of
+	// engine-meshlet-cull.comp.
+	struct Meshlet {
+		// Absolute into the geometry's index buffer
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		// Vertex offset of the submesh the indices are local to
+		uint32_t firstVertex;
+		// Distinct vertices the indices reference
+		uint32_t vertexCount;
+		// Object space bounding sphere
+		glm::vec3 center;
+		float radius;
+		// Normal cone, every triangle faces away from an eye with dot(center - eye, coneAxis) >= coneCutoff * length(center - eye) + radius.
+		// A cutoff of 1 never culls.
+		glm::vec3 coneAxis;
+		float coneCutoff;
+	};
+
+	static constexpr uint32_t s_maxMeshletVertices = 64;
+	static constexpr uint32_t s_maxMeshletTriangles = 124;
+
+	// Per draw push constant, maps packed positions back to object space: offset + scale * position
+	struct VertexDequantization {
+		alignas(16) glm::vec4 positionOffset;
+		alignas(16) glm::vec4 positionScale;
 	};
 }
\ No newline at end of file
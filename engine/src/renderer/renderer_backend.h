@@ -18,16 +18,86 @@ namespace mz {
 	struct RendererGeometryData {
 	};
 
+	// Per-object GPU records. Only the records listed in dirtyIndices are uploaded.
+	struct RendererObjectData {
+		const glm::mat4* transforms = nullptr;
+		uint32_t count = 0;
+		const uint32_t* dirtyIndices = nullptr;
+		uint32_t dirtyCount = 0;
+	};
+
+	// Inputs of the GPU culling pass, the counts size its buffers for the frame
+	struct RendererCullingState {
+		glm::mat4 viewProjection;
+		glm::vec3 cameraPosition;
+		// Objects passed to DrawFrame, and how many of them have meshlets in the LOD they are drawn at
+		uint32_t objectCount = 0;
+		uint32_t culledObjectCount = 0;
+		// Summed over the culled objects
+		uint32_t meshletCount = 0;
+		// Also test against the depth pyramid, drawing in an early and a late phase, see BeginLateCulling()
+		bool occlusion = false;
+	};
+
+	// Bounds of an object guarded by an occlusion query, see DrawOcclusionQueries()
+	struct RendererOcclusionQuery {
+		uint32_t objectIndex = 0;
+		// RenderApiDrawCallArgs::occlusionQueries of the object, the result only applies to the same key
+		uint32_t key = 0;
+		// Object space, placed by the object's GPU record
+		glm::vec3 boundsMin = glm::vec3(0.0f);
+		glm::vec3 boundsMax = glm::vec3(0.0f);
+	};
+
+	struct RendererFrameStats {
+		uint32_t uploadedObjects = 0;
+		uint32_t uploadRegions = 0;
+		uint64_t uploadedBytes = 0;
+		// Meshlets the culling pass tested and rejected. Read back without stalling, so they describe the frame
+		// that most recently finished on the GPU, a few frames behind.
+		uint32_t testedMeshlets = 0;
+		uint32_t culledMeshlets = 0;
+		// Of the culled meshlets, those hidden behind the depth drawn. Meshlets the previous frame's depth hid but
+		// the current frame's did not were drawn late and are counted as disoccluded.
+		uint32_t occludedMeshlets = 0;
+		uint32_t disoccludedMeshlets = 0;
+		// Occlusion queries read back and how many of them found their object hidden, as far behind as the meshlets
+		uint32_t queriedObjects = 0;
+		uint32_t queryOccludedObjects = 0;
+	};
+
 	class RendererBackend {
 	protected:
 		std::string m_name;
 	public:
 		virtual bool Initialize() = 0;
 		virtual void Shutdown() = 0;
+		// Starts recording the frame, transfers are recorded before BeginMainRenderPass()
 		virtual bool BeginFrame() = 0;
+		virtual bool UploadObjects(const RendererObjectData& objects) = 0;
+		// Starts the GPU culling pass, geometries record their CullMeshlets() until EndCulling(). Returns false,
+		// recording nothing, when the device cannot cull on the GPU. After UploadObjects(), before BeginMainRenderPass().
+		virtual bool BeginCulling(const RendererCullingState& state) = 0;
+		virtual void EndCulling() = 0;
+		// With a depth prepass the geometries' depth only draws follow, then EndDepthPrepass() switches to shading
+		virtual void BeginMainRenderPass(bool depthPrepass) = 0;
+		// Ends the early phase of an occlusion culled frame once its draws are recorded: the depth drawn so far is
+		// reduced into the depth pyramid and geometries record their CullMeshlets() for the late phase until
+		// EndCulling(). Returns false, recording nothing, when the frame does not cull occlusion.
+		virtual bool BeginLateCulling() = 0;
+		// Continues the main render pass after the late culling pass, keeping what was drawn, for the late draws
+		virtual void ResumeMainRenderPass(bool depthPrepass) = 0;
+		virtual void EndDepthPrepass() = 0;
+		// Tests the bounds of the listed objects against the depth drawn so far, writing nothing. After the last draw
+		// of the main render pass. The results are read without waiting once the frame has finished on the GPU.
+		virtual void DrawOcclusionQueries(const RendererOcclusionQuery* queries, uint32_t count, const glm::mat4& viewProjection) = 0;
+		// Whether the object's query in the most recently finished frame, made with the same key, found its bounds
+		// hidden. False without such a query.
+		virtual bool IsObjectOccluded(uint32_t objectIndex, uint32_t key) const = 0;
 		virtual bool EndFrame() = 0;
 		virtual void OnResize() = 0;
 		virtual void UpdateGlobalState(RendererGlobalState globalState) = 0;
+		virtual const RendererFrameStats& GetFrameStats() const = 0;
 		inline virtual ~RendererBackend() {}
 	};
 }
\ No newline at end of file
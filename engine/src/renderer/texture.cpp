@@ -5,34 +5,29 @@ namespace mz {
 	{
 	}
 
-	Texture* Texture::CreateTexture(stbi_uc* pixels, int32_t width, int32_t height, int32_t channels)
+	Texture* Texture::CreateTexture(TextureFormat format, const TextureLevel* levels, uint32_t levelCount, uint32_t firstResidentLevel)
 	{
 		switch (Application::Get().GetRenderApiType()) {
-		case RenderApiType::Vulkan:
-			return new VulkanTexture(pixels, width, height, channels);
+		case RenderApiType::Vulkan: {
+			VulkanTexture* texture = new VulkanTexture(format, levels, levelCount, firstResidentLevel);
+			if (!texture->IsCreated()) {
+				delete texture;
+				return nullptr;
+			}
+			return texture;
+		}
 		default:
 			throw std::runtime_error("No render API type specified for texture creation!");
 		}
 	}
 
-	bool Texture::LoadTexture(std::string name, Texture** outTexture)
+	bool Texture::IsFormatSupported(TextureFormat format)
 	{
-		int32_t width, height, channels;
-		std::string filePath = "assets/textures/" + name;
-		stbi_uc* pixels = stbi_load(filePath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
-
-		if (!pixels) {
-			MZ_CORE_WARN("Failed to load texture {0}!", name);
+		switch (Application::Get().GetRenderApiType()) {
+		case RenderApiType::Vulkan:
+			return VulkanTexture::IsFormatSupported(format);
+		default:
 			return false;
 		}
-
-		MZ_CORE_TRACE("Loaded texture {0}.", name);
-
-		Texture* vulkanTexture = Texture::CreateTexture(pixels, width, height, channels);
-		*outTexture = vulkanTexture;
-
-		stbi_image_free(pixels);
-
-		return true;
 	}
 }
\ No newline at end of file
@@ -1,12 +1,44 @@
 #pragma once
 
 #include "engine/src/mzpch.h"
+#include "render_types.h"
+#include "engine/src/core/slot_map.h"
 
 namespace mz {
+	class Texture;
+
+	// Reference to a texture owned by the TextureSystem
+	using TextureHandle = Handle<Texture>;
+
+	// One mip level of texel data in upload layout, largest level first
+	struct TextureLevel {
+		uint32_t width;
+		uint32_t height;
+		const uint8_t* data;
+		size_t size;
+	};
+
 	class Texture {
 	public:
 		virtual ~Texture();
-		static Texture* CreateTexture(stbi_uc* pixels, int32_t width, int32_t height, int32_t channels);
-		static bool LoadTexture(std::string filepath, Texture** outTexture);
+		// GPU memory backing the texture including all mip levels
+		virtual uint64_t GetSizeBytes() const = 0;
+
+		// Mip residency. Only levels [GetFirstResidentLevel(), GetLevelCount()) of the chain the texture
+		// was created from are in GPU memory, level 0 being the largest.
+		virtual uint32_t GetLevelCount() const = 0;
+		virtual uint32_t GetFirstResidentLevel() const = 0;
+		// Starts moving the resident range to begin at firstResidentLevel without waiting for the GPU. Levels
+		// describe the whole chain again and only have to stay valid for the duration of the call. Returns
+		// false if nothing changes, a previous request is still in flight or the new image could not be created.
+		virtual bool RequestResidency(const TextureLevel* levels, uint32_t levelCount, uint32_t firstResidentLevel) = 0;
+		virtual bool IsResidencyPending() const = 0;
+		// Swaps in finished requests and frees images no frame uses anymore, call once per frame
+		virtual void UpdateResidency() = 0;
+
+		// Texel data is copied into the GPU image, it only has to stay valid for the duration of the call.
+		// Levels above firstResidentLevel are left out until they are requested. Returns null if the GPU image could not be created.
+		static Texture* CreateTexture(TextureFormat format, const TextureLevel* levels, uint32_t levelCount, uint32_t firstResidentLevel = 0);
+		static bool IsFormatSupported(TextureFormat format);
 	};
 }
\ No newline at end of file
@@ -34,8 +34,14 @@ namespace mz {
 		VkCommandPool graphicsCommandPool;
 
 		VkPhysicalDeviceProperties physicalDeviceProperties;
+		// Optional features, enabled when the device has them
+		bool textureCompressionBC = false;
+		// Indirect count draws, first instance and buffer device addresses, see VulkanMeshletCuller
+		bool meshletCulling = false;
 
 		VkFormat depthFormat;
+		// The depth format can be sampled, required to build the depth pyramid for occlusion culling
+		bool depthSampling = false;
 	};
 
 	struct VulkanSwapChainInfo {
@@ -65,15 +71,94 @@ namespace mz {
 
 	struct VulkanRenderPassInfo {
 		VkRenderPass handle;
+		// Compatible pass loading the attachments instead of clearing them, continues the frame after a compute pass
+		VkRenderPass resumeHandle;
 	};
 
 	struct VulkanPipelineInfo {
 		VkPipelineLayout layout;
-		VkPipeline handle;
+		// Color, depth tested color and depth only pipeline per VertexFormat, all created with the layout above. The
+		// depth tested ones shade against a depth buffer the prepass already filled, without writing it.
+		std::array<VkPipeline, s_vertexFormatCount> handles{};
+		std::array<VkPipeline, s_vertexFormatCount> depthTestedHandles{};
+		std::array<VkPipeline, s_vertexFormatCount> depthHandles{};
+		// Pipeline bound in the current command buffer, geometries only rebind when theirs differs
+		VkPipeline boundHandle = VK_NULL_HANDLE;
+		// Whether color draws of the current pass use depthTestedHandles
+		bool depthTested = false;
 		VkDescriptorSetLayout descriptorSetLayout;
 		VkDescriptorPool descriptorPool;
 	};
 
+	// Per-object records read by the vertex shader, owned by VulkanObjectBuffer
+	struct VulkanObjectBufferInfo {
+		VkDescriptorSetLayout descriptorSetLayout;
+		VkDescriptorSet descriptorSet;
+	};
+
+	// Invocations per workgroup of engine-meshlet-cull.comp, one per meshlet
+	static constexpr uint32_t s_meshletCullGroupSize = 64;
+
+	// Leading entries of the count buffer: meshlets the early phase found occluded in the previous frame's depth,
+	// and how many of them the late phase still found occluded in the current frame's
+	static constexpr uint32_t s_meshletCullStatisticsCount = 2;
+
+	// Push constants of engine-meshlet-cull.comp, one dispatch per object and phase
+	struct MeshletCullConstants {
+		VkDeviceAddress meshlets;
+		uint32_t objectIndex;
+		uint32_t firstMeshlet;
+		uint32_t meshletCount;
+		uint32_t firstDraw;
+		uint32_t countIndex;
+		// VulkanMeshletCullingInfo::phase
+		uint32_t phase;
+	};
+
+	// Indirect draws the culling pass reserved for one object this frame. With occlusion culling the late phase's
+	// draws follow the early ones at firstDraw + maxDrawCount and are counted at countIndex + 1.
+	struct VulkanMeshletDrawRange {
+		uint32_t firstDraw = 0;
+		uint32_t countIndex = 0;
+		// Zero when the object was not culled, it is then drawn whole
+		uint32_t maxDrawCount = 0;
+	};
+
+	// Meshlet culling pass, owned by VulkanMeshletCuller. Geometries record their dispatches and indirect
+	// draws against the current frame's buffers.
+	struct VulkanMeshletCullingInfo {
+		VkPipelineLayout layout;
+		VkPipeline handle;
+		VkDescriptorSetLayout descriptorSetLayout;
+		// True between BeginCulling and the end of the frame
+		bool active = false;
+		// The frame tests occlusion and draws in two phases: the early one draws what the previous frame's depth
+		// did not occlude, the late one what the early phase's depth shows was wrongly rejected
+		bool occlusion = false;
+		uint32_t phase = 0;
+		VkBuffer drawBuffer = VK_NULL_HANDLE;
+		VkBuffer countBuffer = VK_NULL_HANDLE;
+		uint32_t drawCapacity = 0;
+		uint32_t countCapacity = 0;
+		uint32_t reservedDraws = 0;
+		uint32_t reservedCounts = 0;
+		// Indexed by object
+		std::vector<VulkanMeshletDrawRange> objectRanges;
+	};
+
+	// Hierarchical depth buffer, owned by VulkanDepthPyramid. Every level holds the farthest depth of the texels
+	// it covers, the first is the largest power of two that fits the swap chain extent.
+	struct VulkanDepthPyramidInfo {
+		// All levels, in general layout, sampled with the sampler below
+		VkImageView view = VK_NULL_HANDLE;
+		VkSampler sampler = VK_NULL_HANDLE;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t levelCount = 0;
+		// Changes whenever the image is recreated, descriptors written with an older version are stale
+		uint32_t version = 0;
+	};
+
 	struct UniformBuffer {
 		VkBuffer handle;
 		VkDeviceMemory memory;
@@ -93,10 +178,17 @@ namespace mz {
 
 		VulkanRenderPassInfo mainRenderPass;
 		VulkanPipelineInfo graphicsRenderingPipeline;
+		VulkanObjectBufferInfo objectBuffer;
+		VulkanMeshletCullingInfo meshletCulling;
+		VulkanDepthPyramidInfo depthPyramid;
 
 		std::vector<VkCommandBuffer> commandBuffers;
 
 		uint32_t currentFrame = 0;
+		// Frames handed to the queue so far, and how many of them the GPU has finished. Resources a frame
+		// referenced can be destroyed once completedFrameCount reaches the submittedFrameCount seen at that time.
+		uint64_t submittedFrameCount = 0;
+		uint64_t completedFrameCount = 0;
 		bool framebufferResized = false;
 
 		std::vector<UniformBuffer> uniformBuffers;
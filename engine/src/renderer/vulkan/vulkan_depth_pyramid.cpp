@@ -0,0 +1,360 @@
+#include "vulkan_depth_pyramid.h"
+#include "vulkan_functions.h"
+#include "shaders/vulkan_shader_utils.h"
+
+namespace mz {
+	bool VulkanDepthPyramid::Create()
+	{
+		if (!CreatePipeline()) {
+			MZ_CORE_ERROR("Failed to create depth pyramid pipeline!");
+			return false;
+		}
+
+		VkSamplerCreateInfo samplerInfo{};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_NEAREST;
+		samplerInfo.minFilter = VK_FILTER_NEAREST;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+		if (vkCreateSampler(s_contextPtr->device.logicalDevice, &samplerInfo, s_contextPtr->allocator, &m_sampler) != VK_SUCCESS) {
+			MZ_CORE_ERROR("Failed to create depth pyramid sampler!");
+			return false;
+		}
+		s_contextPtr->depthPyramid.sampler = m_sampler;
+
+		std::array<VkDescriptorPoolSize, 2> poolSizes{};
+		poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		poolSizes[0].descriptorCount = s_maxLevelCount;
+		poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		poolSizes[1].descriptorCount = s_maxLevelCount;
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+		poolInfo.maxSets = s_maxLevelCount;
+
+		if (vkCreateDescriptorPool(s_contextPtr->device.logicalDevice, &poolInfo, s_contextPtr->allocator, &m_descriptorPool) != VK_SUCCESS) {
+			MZ_CORE_ERROR("Failed to create depth pyramid descriptor pool!");
+			return false;
+		}
+
+		// One set per possible level, resizing only rewrites them
+		std::vector<VkDescriptorSetLayout> layouts(s_maxLevelCount, m_descriptorSetLayout);
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = m_descriptorPool;
+		allocInfo.descriptorSetCount = s_maxLevelCount;
+		allocInfo.pSetLayouts = layouts.data();
+
+		m_descriptorSets.resize(s_maxLevelCount);
+		if (vkAllocateDescriptorSets(s_contextPtr->device.logicalDevice, &allocInfo, m_descriptorSets.data()) != VK_SUCCESS) {
+			MZ_CORE_ERROR("Failed to allocate depth pyramid descriptor sets!");
+			return false;
+		}
+
+		if (!CreateImage()) {
+			return false;
+		}
+
+		WriteDescriptorSets();
+		return true;
+	}
+
+	void VulkanDepthPyramid::Destroy()
+	{
+		VkDevice device = s_contextPtr->device.logicalDevice;
+
+		DestroyImage();
+		vkDestroySampler(device, m_sampler, s_contextPtr->allocator);
+		vkDestroyDescriptorPool(device, m_descriptorPool, s_contextPtr->allocator);
+		vkDestroyPipeline(device, m_pipeline, s_contextPtr->allocator);
+		vkDestroyPipelineLayout(device, m_pipelineLayout, s_contextPtr->allocator);
+		vkDestroyDescriptorSetLayout(device, m_descriptorSetLayout, s_contextPtr->allocator);
+		s_contextPtr->depthPyramid.sampler = VK_NULL_HANDLE;
+	}
+
+	bool VulkanDepthPyramid::Resize()
+	{
+		DestroyImage();
+		if (!CreateImage()) {
+			return false;
+		}
+
+		// The depth attachment was recreated as well
+		WriteDescriptorSets();
+		return true;
+	}
+
+	void VulkanDepthPyramid::Build(VkCommandBuffer commandBuffer)
+	{
+		const VulkanDepthPyramidInfo& pyramid = s_contextPtr->depthPyramid;
+		if (!s_contextPtr->device.depthSampling || m_image == VK_NULL_HANDLE) {
+			return;
+		}
+
+		VkFormat depthFormat = s_contextPtr->device.depthFormat;
+		VkImageAspectFlags depthAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+		if (depthFormat == VK_FORMAT_D32_SFLOAT_S8_UINT || depthFormat == VK_FORMAT_D24_UNORM_S8_UINT) {
+			depthAspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+		}
+
+		// The depth writes have to land before they are read, and the culling pass's reads of the previous
+		// contents have to finish before the pyramid is overwritten
+		std::array<VkImageMemoryBarrier, 2> barriers{};
+		for (VkImageMemoryBarrier& barrier : barriers) {
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.subresourceRange.baseArrayLayer = 0;
+			barrier.subresourceRange.layerCount = 1;
+			barrier.subresourceRange.baseMipLevel = 0;
+		}
+
+		barriers[0].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		barriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barriers[0].oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		barriers[0].newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+		barriers[0].image = s_contextPtr->swapChain.depthImage;
+		barriers[0].subresourceRange.aspectMask = depthAspect;
+		barriers[0].subresourceRange.levelCount = 1;
+
+		barriers[1].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barriers[1].dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barriers[1].oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+		barriers[1].newLayout = VK_IMAGE_LAYOUT_GENERAL;
+		barriers[1].image = m_image;
+		barriers[1].subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barriers[1].subresourceRange.levelCount = pyramid.levelCount;
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0,
+			0, nullptr,
+			0, nullptr,
+			static_cast<uint32_t>(barriers.size()), barriers.data());
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+
+		ReduceConstants constants{};
+		constants.sourceSize = glm::uvec2(s_contextPtr->swapChain.extent.width, s_contextPtr->swapChain.extent.height);
+
+		for (uint32_t level = 0; level < pyramid.levelCount; ++level) {
+			constants.destinationSize = glm::uvec2(std::max(pyramid.width >> level, 1u), std::max(pyramid.height >> level, 1u));
+
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &m_descriptorSets[level], 0, nullptr);
+			vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+			vkCmdDispatch(
+				commandBuffer,
+				(constants.destinationSize.x + s_reduceGroupSize - 1) / s_reduceGroupSize,
+				(constants.destinationSize.y + s_reduceGroupSize - 1) / s_reduceGroupSize,
+				1);
+
+			// The next level reads this one, the culling pass all of them
+			VkImageMemoryBarrier levelBarrier = barriers[1];
+			levelBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			levelBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			levelBarrier.subresourceRange.baseMipLevel = level;
+			levelBarrier.subresourceRange.levelCount = 1;
+
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				0,
+				0, nullptr,
+				0, nullptr,
+				1, &levelBarrier);
+
+			constants.sourceSize = constants.destinationSize;
+		}
+
+		// Back to the attachment layout the resumed pass and the next frame's pass expect
+		barriers[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barriers[0].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		barriers[0].oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+		barriers[0].newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			0,
+			0, nullptr,
+			0, nullptr,
+			1, &barriers[0]);
+	}
+
+	bool VulkanDepthPyramid::CreatePipeline()
+	{
+		std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+		bindings[0].binding = 0;
+		bindings[0].descriptorCount = 1;
+		bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		bindings[1].binding = 1;
+		bindings[1].descriptorCount = 1;
+		bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+		layoutInfo.pBindings = bindings.data();
+
+		if (vkCreateDescriptorSetLayout(s_contextPtr->device.logicalDevice, &layoutInfo, s_contextPtr->allocator, &m_descriptorSetLayout) != VK_SUCCESS) {
+			return false;
+		}
+
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(ReduceConstants);
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &m_descriptorSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		if (vkCreatePipelineLayout(s_contextPtr->device.logicalDevice, &pipelineLayoutInfo, s_contextPtr->allocator, &m_pipelineLayout) != VK_SUCCESS) {
+			return false;
+		}
+
+		auto shaderCode = EngineReadFile(s_reduceShaderFileName);
+		VkShaderModule shaderModule = CreateShaderModule(shaderCode, s_contextPtr->device.logicalDevice);
+
+		VkComputePipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		pipelineInfo.stage.module = shaderModule;
+		pipelineInfo.stage.pName = "main";
+		pipelineInfo.layout = m_pipelineLayout;
+
+		VkResult result = vkCreateComputePipelines(s_contextPtr->device.logicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, s_contextPtr->allocator, &m_pipeline);
+		vkDestroyShaderModule(s_contextPtr->device.logicalDevice, shaderModule, s_contextPtr->allocator);
+
+		return result == VK_SUCCESS;
+	}
+
+	bool VulkanDepthPyramid::CreateImage()
+	{
+		VulkanDepthPyramidInfo& pyramid = s_contextPtr->depthPyramid;
+
+		// Largest power of two not above the extent, so every level halves the previous one exactly and only the
+		// first reduction has to cover an uneven footprint
+		auto previousPowerOfTwo = [](uint32_t value) {
+			uint32_t result = 1;
+			while (result * 2 <= value) {
+				result *= 2;
+			}
+			return result;
+		};
+
+		pyramid.width = previousPowerOfTwo(std::max(s_contextPtr->swapChain.extent.width, 1u));
+		pyramid.height = previousPowerOfTwo(std::max(s_contextPtr->swapChain.extent.height, 1u));
+		pyramid.levelCount = 1;
+		while ((std::max(pyramid.width, pyramid.height) >> pyramid.levelCount) > 0 && pyramid.levelCount < s_maxLevelCount) {
+			++pyramid.levelCount;
+		}
+
+		if (!VulkanFunctions::CreateImage(
+			pyramid.width, pyramid.height,
+			pyramid.levelCount,
+			VK_FORMAT_R32_SFLOAT,
+			VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			m_image,
+			m_imageMemory)) {
+			MZ_CORE_ERROR("Failed to create depth pyramid image!");
+			return false;
+		}
+
+		pyramid.view = VulkanFunctions::CreateImageView(m_image, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, pyramid.levelCount);
+
+		m_levelViews.resize(pyramid.levelCount);
+		for (uint32_t level = 0; level < pyramid.levelCount; ++level) {
+			VkImageViewCreateInfo viewInfo{};
+			viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			viewInfo.image = m_image;
+			viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			viewInfo.format = VK_FORMAT_R32_SFLOAT;
+			viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			viewInfo.subresourceRange.baseMipLevel = level;
+			viewInfo.subresourceRange.levelCount = 1;
+			viewInfo.subresourceRange.baseArrayLayer = 0;
+			viewInfo.subresourceRange.layerCount = 1;
+
+			if (vkCreateImageView(s_contextPtr->device.logicalDevice, &viewInfo, s_contextPtr->allocator, &m_levelViews[level]) != VK_SUCCESS) {
+				MZ_CORE_ERROR("Failed to create depth pyramid level view!");
+				return false;
+			}
+		}
+
+		// Stays in general layout, written as a storage image and sampled in the same passes
+		VulkanFunctions::TransitionImageLayout(m_image, VK_FORMAT_R32_SFLOAT, pyramid.levelCount, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+
+		++pyramid.version;
+		MZ_CORE_TRACE("Created {0}x{1} depth pyramid with {2} levels", pyramid.width, pyramid.height, pyramid.levelCount);
+		return true;
+	}
+
+	void VulkanDepthPyramid::DestroyImage()
+	{
+		VkDevice device = s_contextPtr->device.logicalDevice;
+
+		for (VkImageView view : m_levelViews) {
+			vkDestroyImageView(device, view, s_contextPtr->allocator);
+		}
+		m_levelViews.clear();
+
+		vkDestroyImageView(device, s_contextPtr->depthPyramid.view, s_contextPtr->allocator);
+		vkDestroyImage(device, m_image, s_contextPtr->allocator);
+		vkFreeMemory(device, m_imageMemory, s_contextPtr->allocator);
+		s_contextPtr->depthPyramid.view = VK_NULL_HANDLE;
+		m_image = VK_NULL_HANDLE;
+		m_imageMemory = VK_NULL_HANDLE;
+	}
+
+	void VulkanDepthPyramid::WriteDescriptorSets()
+	{
+		const VulkanDepthPyramidInfo& pyramid = s_contextPtr->depthPyramid;
+
+		// Without a sampleable depth format the first level is never built, its set stays unwritten
+		uint32_t firstLevel = s_contextPtr->device.depthSampling ? 0 : 1;
+		for (uint32_t level = firstLevel; level < pyramid.levelCount; ++level) {
+			VkDescriptorImageInfo sourceInfo{};
+			sourceInfo.sampler = m_sampler;
+			sourceInfo.imageView = level == 0 ? s_contextPtr->swapChain.depthImageView : m_levelViews[level - 1];
+			sourceInfo.imageLayout = level == 0 ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+
+			VkDescriptorImageInfo destinationInfo{};
+			destinationInfo.imageView = m_levelViews[level];
+			destinationInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+			for (uint32_t i = 0; i < descriptorWrites.size(); ++i) {
+				descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				descriptorWrites[i].dstSet = m_descriptorSets[level];
+				descriptorWrites[i].dstBinding = i;
+				descriptorWrites[i].dstArrayElement = 0;
+				descriptorWrites[i].descriptorCount = 1;
+			}
+			descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			descriptorWrites[0].pImageInfo = &sourceInfo;
+			descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			descriptorWrites[1].pImageInfo = &destinationInfo;
+
+			vkUpdateDescriptorSets(s_contextPtr->device.logicalDevice, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+		}
+	}
+}
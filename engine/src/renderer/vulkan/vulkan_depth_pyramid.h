@@ -0,0 +1,56 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "vulkan_context.h"
+
+namespace mz {
+	// Hierarchical depth buffer for occlusion culling. A compute pass reduces the depth attachment into the first
+	// level and every further level into the next, keeping the farthest depth, so a single texel of the level that
+	// matches a bounding rectangle's size tells whether anything drawn so far covers it. The image is shared by the
+	// frames in flight, the queue runs them in order and every use is fenced by barriers.
+	class VulkanDepthPyramid {
+	public:
+		bool Create();
+		void Destroy();
+		// Matches the pyramid to the swap chain extent after it was recreated, the GPU must be idle
+		bool Resize();
+		// Reduces the depth attachment drawn so far into the pyramid. Outside of a render pass, the attachment is
+		// back in its attachment layout afterwards.
+		void Build(VkCommandBuffer commandBuffer);
+
+		inline static void SetContextPointer(std::shared_ptr<VulkanContext> contextPtr) { s_contextPtr = contextPtr; }
+	private:
+		inline static std::shared_ptr<VulkanContext> s_contextPtr = nullptr;
+		inline static const std::string s_reduceShaderFileName = "assets/shaders/engine-depth-pyramid.comp.spv";
+
+		// Invocations per workgroup side of engine-depth-pyramid.comp, one per destination texel
+		static constexpr uint32_t s_reduceGroupSize = 8;
+		// Enough for a 32k extent
+		static constexpr uint32_t s_maxLevelCount = 16;
+
+		// Push constants of engine-depth-pyramid.comp
+		struct ReduceConstants {
+			glm::uvec2 sourceSize;
+			glm::uvec2 destinationSize;
+		};
+
+		VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+		VkPipeline m_pipeline = VK_NULL_HANDLE;
+		VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
+		VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+		// Nearest filtering with clamped coordinates, the shaders only fetch texels
+		VkSampler m_sampler = VK_NULL_HANDLE;
+
+		VkImage m_image = VK_NULL_HANDLE;
+		VkDeviceMemory m_imageMemory = VK_NULL_HANDLE;
+		// One view per level, written by one reduction and read by the next
+		std::vector<VkImageView> m_levelViews;
+		// The reduction into level i reads the depth attachment for i = 0, level i - 1 otherwise
+		std::vector<VkDescriptorSet> m_descriptorSets;
+
+		bool CreatePipeline();
+		bool CreateImage();
+		void DestroyImage();
+		void WriteDescriptorSets();
+	};
+}
\ No newline at end of file
@@ -56,11 +56,42 @@ namespace mz {
 			queueCreateInfos.push_back(queueCreateInfo);
 		}
 
+		VkPhysicalDeviceFeatures supportedFeatures;
+		vkGetPhysicalDeviceFeatures(s_contextPtr->device.physicalDevice, &supportedFeatures);
+
 		VkPhysicalDeviceFeatures deviceFeatures{};
 		deviceFeatures.samplerAnisotropy = VK_TRUE;
+		// Cooked textures are block compressed, without it they fall back to their source images
+		deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+		s_contextPtr->device.textureCompressionBC = supportedFeatures.textureCompressionBC == VK_TRUE;
+
+		// Vulkan 1.2 features can only be queried and chained on devices that report 1.2
+		VkPhysicalDeviceVulkan12Features supportedFeatures12{};
+		supportedFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		bool vulkan12 = s_contextPtr->device.physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_2;
+		if (vulkan12) {
+			VkPhysicalDeviceFeatures2 supportedFeatures2{};
+			supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			supportedFeatures2.pNext = &supportedFeatures12;
+			vkGetPhysicalDeviceFeatures2(s_contextPtr->device.physicalDevice, &supportedFeatures2);
+		}
+
+		// Meshlet culling writes indirect draws on the GPU: their count comes from a buffer, the first instance selects
+		// the object record and the meshlets are read through buffer device addresses. Without them meshes draw whole.
+		bool meshletCulling = vulkan12 && supportedFeatures.multiDrawIndirect && supportedFeatures.drawIndirectFirstInstance
+			&& supportedFeatures12.drawIndirectCount && supportedFeatures12.bufferDeviceAddress;
+		deviceFeatures.multiDrawIndirect = meshletCulling ? VK_TRUE : VK_FALSE;
+		deviceFeatures.drawIndirectFirstInstance = meshletCulling ? VK_TRUE : VK_FALSE;
+		s_contextPtr->device.meshletCulling = meshletCulling;
+
+		VkPhysicalDeviceVulkan12Features deviceFeatures12{};
+		deviceFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		deviceFeatures12.drawIndirectCount = meshletCulling ? VK_TRUE : VK_FALSE;
+		deviceFeatures12.bufferDeviceAddress = meshletCulling ? VK_TRUE : VK_FALSE;
 		
 		VkDeviceCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		createInfo.pNext = vulkan12 ? &deviceFeatures12 : nullptr;
 
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
 		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());;
@@ -194,8 +225,17 @@ namespace mz {
 
 	bool VulkanDevice::FindDepthFormat()
 	{
-		if (FindSupportedFormat(
-			{ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT },
+		std::vector<VkFormat> candidates = { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT };
+
+		// Prefer a format the depth pyramid can sample
+		s_contextPtr->device.depthSampling = FindSupportedFormat(
+			candidates,
+			VK_IMAGE_TILING_OPTIMAL,
+			VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT,
+			s_contextPtr->device.depthFormat);
+
+		if (s_contextPtr->device.depthSampling || FindSupportedFormat(
+			candidates,
 			VK_IMAGE_TILING_OPTIMAL,
 			VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT,
 			s_contextPtr->device.depthFormat)) 
@@ -8,8 +8,13 @@ namespace mz {
 		bufferInfo.usage = usage;
 		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+		// Handles are left null on failure, so callers can destroy them unconditionally
+		buffer = VK_NULL_HANDLE;
+		bufferMemory = VK_NULL_HANDLE;
+
 		if (vkCreateBuffer(s_contextPtr->device.logicalDevice, &bufferInfo, s_contextPtr->allocator, &buffer) != VK_SUCCESS) {
 			MZ_CORE_ERROR("Failed to create buffer!");
+			buffer = VK_NULL_HANDLE;
 			return false;
 		}
 
@@ -21,8 +26,19 @@ namespace mz {
 		allocInfo.allocationSize = memRequirements.size;
 		allocInfo.memoryTypeIndex = VulkanFunctions::FindDeviceMemoryType(memRequirements.memoryTypeBits, properties);
 
+		// Buffers read through their device address need memory allocated for it
+		VkMemoryAllocateFlagsInfo allocFlagsInfo{};
+		allocFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+		allocFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+		if (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
+			allocInfo.pNext = &allocFlagsInfo;
+		}
+
 		if (vkAllocateMemory(s_contextPtr->device.logicalDevice, &allocInfo, s_contextPtr->allocator, &bufferMemory) != VK_SUCCESS) {
 			MZ_CORE_ERROR("Failed to allocate memory for buffer!");
+			vkDestroyBuffer(s_contextPtr->device.logicalDevice, buffer, s_contextPtr->allocator);
+			buffer = VK_NULL_HANDLE;
+			bufferMemory = VK_NULL_HANDLE;
 			return false;
 		}
 
@@ -48,6 +64,7 @@ namespace mz {
 	bool VulkanFunctions::CreateImage(
 		uint32_t width, 
 		uint32_t height, 
+		uint32_t mipLevels,
 		VkFormat format, 
 		VkImageTiling tiling, 
 		VkImageUsageFlags usage, 
@@ -61,7 +78,7 @@ namespace mz {
 		imageInfo.extent.width = width;
 		imageInfo.extent.height = height;
 		imageInfo.extent.depth = 1;
-		imageInfo.mipLevels = 1;
+		imageInfo.mipLevels = mipLevels;
 		imageInfo.arrayLayers = 1;
 		imageInfo.format = format;
 		imageInfo.tiling = tiling;
@@ -70,8 +87,13 @@ namespace mz {
 		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+		// Handles are left null on failure, so callers can destroy them unconditionally
+		image = VK_NULL_HANDLE;
+		imageMemory = VK_NULL_HANDLE;
+
 		if (vkCreateImage(s_contextPtr->device.logicalDevice, &imageInfo, s_contextPtr->allocator, &image) != VK_SUCCESS) {
 			MZ_CORE_ERROR("Failed to create Vulkan image!");
+			image = VK_NULL_HANDLE;
 			return false;
 		}
 
@@ -85,6 +107,9 @@ namespace mz {
 
 		if (vkAllocateMemory(s_contextPtr->device.logicalDevice, &allocInfo, s_contextPtr->allocator, &imageMemory) != VK_SUCCESS) {
 			MZ_CORE_ERROR("Failed to allocate Vulkan image memory!");
+			vkDestroyImage(s_contextPtr->device.logicalDevice, image, s_contextPtr->allocator);
+			image = VK_NULL_HANDLE;
+			imageMemory = VK_NULL_HANDLE;
 			return false;
 		}
 
@@ -127,7 +152,7 @@ namespace mz {
 		vkFreeCommandBuffers(s_contextPtr->device.logicalDevice, s_contextPtr->device.graphicsCommandPool, 1, &commandBuffer);
 	}
 	
-	void VulkanFunctions::TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout)
+	void VulkanFunctions::TransitionImageLayout(VkImage image, VkFormat format, uint32_t mipLevels, VkImageLayout oldLayout, VkImageLayout newLayout)
 	{
 		VkCommandBuffer commandBuffer = VulkanFunctions::BeginSingleUseCommands();
 
@@ -144,7 +169,7 @@ namespace mz {
 		barrier.image = image;
 		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 		barrier.subresourceRange.baseMipLevel = 0;
-		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.levelCount = mipLevels;
 		barrier.subresourceRange.baseArrayLayer = 0;
 		barrier.subresourceRange.layerCount = 1;
 
@@ -162,6 +187,14 @@ namespace mz {
 			sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
 			destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
 		}
+		else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_GENERAL) {
+			// Storage images written and read by compute shaders
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+			sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+			destinationStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		}
 		else {
 			MZ_CORE_ERROR("Unsupported layout transition");
 		}
@@ -179,40 +212,23 @@ namespace mz {
 
 	}
 	
-	void VulkanFunctions::CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
+	void VulkanFunctions::CopyBufferToImage(VkBuffer buffer, VkImage image, const VkBufferImageCopy* regions, uint32_t regionCount)
 	{
 		VkCommandBuffer commandBuffer = VulkanFunctions::BeginSingleUseCommands();
 
-		VkBufferImageCopy region{};
-		region.bufferOffset = 0;
-		region.bufferRowLength = 0;
-		region.bufferImageHeight = 0;
-
-		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		region.imageSubresource.mipLevel = 0;
-		region.imageSubresource.baseArrayLayer = 0;
-		region.imageSubresource.layerCount = 1;
-
-		region.imageOffset = { 0, 0, 0 };
-		region.imageExtent = {
-			width,
-			height,
-			1
-		};
-
 		vkCmdCopyBufferToImage(
 			commandBuffer,
 			buffer,
 			image,
 			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			1,
-			&region
+			regionCount,
+			regions
 		);
 
 		VulkanFunctions::EndSingleTimeCommands(commandBuffer);
 	}
 	
-	VkImageView VulkanFunctions::CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags)
+	VkImageView VulkanFunctions::CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels)
 	{
 		VkImageViewCreateInfo viewInfo{};
 		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -221,7 +237,7 @@ namespace mz {
 		viewInfo.format = format;
 		viewInfo.subresourceRange.aspectMask = aspectFlags;
 		viewInfo.subresourceRange.baseMipLevel = 0;
-		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.levelCount = mipLevels;
 		viewInfo.subresourceRange.baseArrayLayer = 0;
 		viewInfo.subresourceRange.layerCount = 1;
 
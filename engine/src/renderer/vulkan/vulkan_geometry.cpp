@@ -2,51 +2,213 @@
 #include "vulkan_functions.h"
 
 namespace mz {
-	VulkanGeometry::VulkanGeometry(std::vector<Vertex3d> vertices, std::vector<uint32_t> indices, std::string textureName)
+	VulkanGeometry::VulkanGeometry(const GeometryData& data, const Texture* texture)
 	{
+		m_vertexFormat = data.vertexFormat;
 		m_vertexBufferOffset = s_contextPtr->vertexBufferOffset;
-		m_vertexCount = vertices.size();
+		m_vertexCount = data.vertexCount;
 
 		m_indexBufferOffset = s_contextPtr->indexBufferOffset;
-		m_indexCount = indices.size();
+		m_indexCount = data.indexCount;
+		m_indexType = data.indexStride == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+
+		m_submeshes = data.submeshes;
+		if (m_submeshes.empty()) {
+			GeometrySubmesh submesh;
+			submesh.indexCount = data.indexCount;
+			submesh.boundsMin = data.boundsMin;
+			submesh.boundsMax = data.boundsMax;
+			m_submeshes.push_back(submesh);
+		}
 
-		CreateVertexBuffer(vertices);
-		CreateIndexBuffer(indices);
+		m_lods = data.lods;
+		if (m_lods.empty()) {
+			GeometryLod lod;
+			lod.submeshCount = static_cast<uint32_t>(m_submeshes.size());
+			m_lods.push_back(lod);
+		}
 
-		s_contextPtr->indexBufferOffset += indices.size();
-		s_contextPtr->vertexBufferOffset += vertices.size();
+		m_boundsMin = data.boundsMin;
+		m_boundsMax = data.boundsMax;
 
-		m_textureName = textureName;
+		// Float vertices are already in object space, the packed vertex shader is the only one reading this
+		m_dequantization.positionOffset = glm::vec4(data.boundsMin, 0.0f);
+		m_dequantization.positionScale = glm::vec4(data.boundsMax - data.boundsMin, 0.0f);
 
-		CreateDescriptorSets();
+		m_created = CreateVertexBuffer(data.vertices, data.vertexCount)
+			&& CreateIndexBuffer(data.indices, VkDeviceSize(data.indexStride) * data.indexCount);
+		if (data.meshletCount > 0 && s_contextPtr->device.meshletCulling) {
+			CreateMeshletBuffer(data.meshlets, data.meshletCount);
+		}
+		else if (s_contextPtr->device.meshletCulling) {
+			// Without cooked meshlets every submesh is culled whole by its bounds, so occlusion culling reaches
+			// small meshes too
+			std::vector<Meshlet> submeshMeshlets;
+			for (GeometryLod& lod : m_lods) {
+				lod.firstMeshlet = static_cast<uint32_t>(submeshMeshlets.size());
+				lod.meshletCount = lod.submeshCount;
+				for (uint32_t i = lod.firstSubmesh; i < lod.firstSubmesh + lod.submeshCount; ++i) {
+					const GeometrySubmesh& submesh = m_submeshes[i];
+					Meshlet meshlet{};
+					meshlet.firstIndex = submesh.firstIndex;
+					meshlet.indexCount = submesh.indexCount;
+					meshlet.firstVertex = submesh.firstVertex;
+					meshlet.center = 0.5f * (submesh.boundsMin + submesh.boundsMax);
+					meshlet.radius = glm::length(submesh.boundsMax - meshlet.center);
+					// Never cone culled, a whole submesh faces every way
+					meshlet.coneCutoff = 1.0f;
+					submeshMeshlets.push_back(meshlet);
+				}
+			}
+			CreateMeshletBuffer(submeshMeshlets.data(), static_cast<uint32_t>(submeshMeshlets.size()));
+		}
+
+		s_contextPtr->indexBufferOffset += data.indexCount;
+		s_contextPtr->vertexBufferOffset += data.vertexCount;
+
+		m_texture = static_cast<const VulkanTexture*>(texture);
+		if (m_created && !CreateDescriptorSets()) {
+			MZ_CORE_ERROR("Failed to allocate geometry descriptor sets!");
+			m_created = false;
+		}
 	}
 
 	VulkanGeometry::~VulkanGeometry()
 	{
-		vkDeviceWaitIdle(s_contextPtr->device.logicalDevice);
+		// Frames in flight may still draw or cull the geometry, its resources are destroyed once they have finished
+		RetiredResources retired;
+		retired.buffers = { m_meshletBuffer, m_indexBuffer, m_vertexBuffer };
+		retired.memories = { m_meshletBufferMemory, m_indexBufferMemory, m_vertexBufferMemory };
+		retired.descriptorSets = std::move(m_descriptorSets);
+		retired.lastUseFrame = s_contextPtr->submittedFrameCount;
+		s_retiredResources.push_back(std::move(retired));
+	}
+
+	void VulkanGeometry::DestroyRetiredResources(bool force)
+	{
+		for (size_t i = 0; i < s_retiredResources.size();) {
+			RetiredResources& retired = s_retiredResources[i];
+			if (!force && retired.lastUseFrame > s_contextPtr->completedFrameCount) {
+				++i;
+				continue;
+			}
+
+			// The pool is created with VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT, so its sets can be reused
+			if (!retired.descriptorSets.empty()) {
+				vkFreeDescriptorSets(s_contextPtr->device.logicalDevice, s_contextPtr->graphicsRenderingPipeline.descriptorPool,
+					static_cast<uint32_t>(retired.descriptorSets.size()), retired.descriptorSets.data());
+			}
+
+			// Null handles of buffers that were never created are ignored
+			for (size_t j = 0; j < retired.buffers.size(); ++j) {
+				vkDestroyBuffer(s_contextPtr->device.logicalDevice, retired.buffers[j], s_contextPtr->allocator);
+				vkFreeMemory(s_contextPtr->device.logicalDevice, retired.memories[j], s_contextPtr->allocator);
+			}
+
+			s_retiredResources[i] = std::move(s_retiredResources.back());
+			s_retiredResources.pop_back();
+		}
+	}
+
+	void VulkanGeometry::Draw(uint32_t objectIndex, uint32_t lod) const
+	{
+		const VulkanPipelineInfo& pipeline = s_contextPtr->graphicsRenderingPipeline;
+		const auto& handles = pipeline.depthTested ? pipeline.depthTestedHandles : pipeline.handles;
+		RecordDraw(handles[static_cast<uint32_t>(m_vertexFormat)], 2, objectIndex, lod);
+	}
+
+	void VulkanGeometry::DrawDepth(uint32_t objectIndex, uint32_t lod) const
+	{
+		// Only the position stream is fetched
+		RecordDraw(s_contextPtr->graphicsRenderingPipeline.depthHandles[static_cast<uint32_t>(m_vertexFormat)], 1, objectIndex, lod);
+	}
+	
+	bool VulkanGeometry::CullMeshlets(uint32_t objectIndex, uint32_t lod) const
+	{
+		VulkanMeshletCullingInfo& culling = s_contextPtr->meshletCulling;
+		const GeometryLod& range = m_lods[std::min<size_t>(lod, m_lods.size() - 1)];
+
+		if (!culling.active || range.meshletCount == 0 || m_meshletBufferAddress == 0 || objectIndex >= culling.objectRanges.size()) {
+			return false;
+		}
+
+		VulkanMeshletDrawRange& drawRange = culling.objectRanges[objectIndex];
+
+		// The early phase reserves the ranges of both, the late phase only runs for objects the early one culled
+		if (culling.phase == 0) {
+			uint32_t rangeCount = culling.occlusion ? 2 : 1;
+			if (culling.reservedDraws + range.meshletCount * rangeCount > culling.drawCapacity
+				|| culling.reservedCounts + rangeCount > culling.countCapacity) {
+				return false;
+			}
+
+			drawRange.firstDraw = culling.reservedDraws;
+			drawRange.countIndex = culling.reservedCounts;
+			drawRange.maxDrawCount = range.meshletCount;
+			culling.reservedDraws += range.meshletCount * rangeCount;
+			culling.reservedCounts += rangeCount;
+		}
+		else if (drawRange.maxDrawCount == 0) {
+			return false;
+		}
 
-		// Index buffer
-		vkDestroyBuffer(s_contextPtr->device.logicalDevice, m_indexBuffer, s_contextPtr->allocator);
-		vkFreeMemory(s_contextPtr->device.logicalDevice, m_indexBufferMemory, s_contextPtr->allocator);
+		MeshletCullConstants constants{};
+		constants.meshlets = m_meshletBufferAddress;
+		constants.objectIndex = objectIndex;
+		constants.firstMeshlet = range.firstMeshlet;
+		constants.meshletCount = range.meshletCount;
+		constants.firstDraw = drawRange.firstDraw;
+		constants.countIndex = drawRange.countIndex;
+		constants.phase = culling.phase;
 
-		// Vertex buffer
-		vkDestroyBuffer(s_contextPtr->device.logicalDevice, m_vertexBuffer, s_contextPtr->allocator);
-		vkFreeMemory(s_contextPtr->device.logicalDevice, m_vertexBufferMemory, s_contextPtr->allocator);
+		// The culler has bound the pipeline and its descriptor sets
+		VkCommandBuffer commandBuffer = s_contextPtr->commandBuffers[s_contextPtr->currentFrame];
+		vkCmdPushConstants(commandBuffer, culling.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+		vkCmdDispatch(commandBuffer, (range.meshletCount + s_meshletCullGroupSize - 1) / s_meshletCullGroupSize, 1, 1);
 
-		delete m_texture;
+		return true;
+	}
+	
+	void VulkanGeometry::SetTexture(const Texture* texture)
+	{
+		// Every frame's set is rewritten before its next use, while it is idle
+		m_texture = static_cast<const VulkanTexture*>(texture);
+		m_descriptorTextureVersions.fill(std::numeric_limits<uint32_t>::max());
 	}
 
-	void VulkanGeometry::Draw(glm::mat4 model) const
+	void VulkanGeometry::RecordDraw(VkPipeline pipelineHandle, uint32_t streamCount, uint32_t objectIndex, uint32_t lod) const
 	{
 		VkCommandBuffer commandBuffer = s_contextPtr->commandBuffers[s_contextPtr->currentFrame];
 
-		VkBuffer vertexBuffers[] = { m_vertexBuffer };
-		VkDeviceSize offsets[] = { 0 };
-		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+		// The late phase only draws what the early one wrongly rejected, objects that were not culled are done
+		const VulkanMeshletCullingInfo& culling = s_contextPtr->meshletCulling;
+		bool culled = objectIndex < culling.objectRanges.size() && culling.objectRanges[objectIndex].maxDrawCount > 0;
+		if (culling.phase == 1 && !culled) {
+			return;
+		}
+
+		// All pipelines share one layout, so switching keeps the bound descriptor sets
+		VulkanPipelineInfo& pipeline = s_contextPtr->graphicsRenderingPipeline;
+		if (pipeline.boundHandle != pipelineHandle) {
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineHandle);
+			pipeline.boundHandle = pipelineHandle;
+		}
+
+		if (m_vertexFormat == VertexFormat::Packed) {
+			vkCmdPushConstants(commandBuffer, pipeline.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(VertexDequantization), &m_dequantization);
+		}
+
+		// Binding 0 is the position stream, binding 1 the remaining attributes
+		VkBuffer vertexBuffers[] = { m_vertexBuffer, m_vertexBuffer };
+		VkDeviceSize offsets[] = { 0, m_attributeStreamOffset };
+		vkCmdBindVertexBuffers(commandBuffer, 0, streamCount, vertexBuffers, offsets);
 
-		vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-		
-		vkCmdPushConstants(commandBuffer, s_contextPtr->graphicsRenderingPipeline.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &model);
+		vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer, 0, m_indexType);
+
+		// The set of the current frame is idle here, the frame that last used it has been waited for
+		if (m_descriptorTextureVersions[s_contextPtr->currentFrame] != m_texture->GetVersion()) {
+			WriteTextureDescriptor(s_contextPtr->currentFrame);
+		}
 
 		vkCmdBindDescriptorSets(
 			commandBuffer,
@@ -58,12 +220,39 @@ namespace mz {
 			0,
 			nullptr);
 
-		vkCmdDrawIndexed(commandBuffer, m_indexCount, 1, 0, 0, 0);
+		// The culling pass wrote one command per surviving meshlet and their number, the late phase's follow the early ones
+		if (culled) {
+			const VulkanMeshletDrawRange& drawRange = culling.objectRanges[objectIndex];
+			uint32_t firstDraw = drawRange.firstDraw + culling.phase * drawRange.maxDrawCount;
+			uint32_t countIndex = drawRange.countIndex + culling.phase;
+			vkCmdDrawIndexedIndirectCount(
+				commandBuffer,
+				culling.drawBuffer,
+				VkDeviceSize(firstDraw) * sizeof(VkDrawIndexedIndirectCommand),
+				culling.countBuffer,
+				VkDeviceSize(countIndex) * sizeof(uint32_t),
+				drawRange.maxDrawCount,
+				sizeof(VkDrawIndexedIndirectCommand));
+			return;
+		}
+
+		// The instance index selects the record in the object buffer, the vertex offset rebases the submesh local indices
+		const GeometryLod& range = m_lods[std::min<size_t>(lod, m_lods.size() - 1)];
+		for (uint32_t i = range.firstSubmesh; i < range.firstSubmesh + range.submeshCount; ++i) {
+			const GeometrySubmesh& submesh = m_submeshes[i];
+			vkCmdDrawIndexed(commandBuffer, submesh.indexCount, 1, submesh.firstIndex, static_cast<int32_t>(submesh.firstVertex), objectIndex);
+		}
 	}
-	
-	bool VulkanGeometry::CreateVertexBuffer(std::vector<Vertex3d> vertices)
+
+	bool VulkanGeometry::CreateVertexBuffer(const void* vertices, uint32_t vertexCount)
 	{
-		VkDeviceSize bufferSize = sizeof(Vertex3d) * vertices.size();
+		// Positions lead every vertex layout, they are split off into their own stream followed by the rest
+		VkDeviceSize vertexStride = GetVertexStride(m_vertexFormat);
+		VkDeviceSize positionStride = GetPositionStride(m_vertexFormat);
+		VkDeviceSize attributeStride = vertexStride - positionStride;
+		// Vertex buffer offsets only need to be aligned to the attribute formats, 16 covers all of them
+		m_attributeStreamOffset = (positionStride * vertexCount + 15) & ~VkDeviceSize(15);
+		VkDeviceSize bufferSize = m_attributeStreamOffset + attributeStride * vertexCount;
 
 		VkBuffer stagingBuffer;
 		VkDeviceMemory stagingBufferMemory;
@@ -73,62 +262,130 @@ namespace mz {
 			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
 			stagingBuffer,
 			stagingBufferMemory)) {
-			MZ_CORE_CRITICAL("Failed to create staging buffer!");
+			MZ_CORE_ERROR("Failed to create vertex staging buffer!");
 			return false;
 		}
 
-
 		void* data;
 		vkMapMemory(s_contextPtr->device.logicalDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, vertices.data(), (size_t)bufferSize);
+		// The split is done while filling the staging buffer, which touches every byte anyway
+		const uint8_t* source = static_cast<const uint8_t*>(vertices);
+		uint8_t* positions = static_cast<uint8_t*>(data);
+		uint8_t* attributes = positions + m_attributeStreamOffset;
+		for (uint32_t i = 0; i < vertexCount; ++i) {
+			memcpy(positions + i * positionStride, source, (size_t)positionStride);
+			memcpy(attributes + i * attributeStride, source + positionStride, (size_t)attributeStride);
+			source += vertexStride;
+		}
 		vkUnmapMemory(s_contextPtr->device.logicalDevice, stagingBufferMemory);
 
-		if (!VulkanFunctions::CreateBuffer(
+		bool created = VulkanFunctions::CreateBuffer(
 			bufferSize,
 			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 			m_vertexBuffer,
-			m_vertexBufferMemory)) {
-			MZ_CORE_CRITICAL("Failed to create vertex buffer!");
-			return false;
-		}
+			m_vertexBufferMemory);
 
-		VulkanFunctions::CopyBuffer(stagingBuffer, m_vertexBuffer, bufferSize);
+		if (created) {
+			VulkanFunctions::CopyBuffer(stagingBuffer, m_vertexBuffer, bufferSize);
+			m_sizeBytes += bufferSize;
+		}
+		else {
+			MZ_CORE_ERROR("Failed to create vertex buffer!");
+		}
 
 		vkDestroyBuffer(s_contextPtr->device.logicalDevice, stagingBuffer, s_contextPtr->allocator);
 		vkFreeMemory(s_contextPtr->device.logicalDevice, stagingBufferMemory, s_contextPtr->allocator);
+
+		return created;
 	}
-	
 
-	bool VulkanGeometry::CreateIndexBuffer(std::vector<uint32_t> indices)
+	bool VulkanGeometry::CreateIndexBuffer(const void* indices, VkDeviceSize bufferSize)
 	{
-		VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
-
 		VkBuffer stagingBuffer;
 		VkDeviceMemory stagingBufferMemory;
-		VulkanFunctions::CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+		if (!VulkanFunctions::CreateBuffer(
+			bufferSize,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			stagingBuffer,
+			stagingBufferMemory)) {
+			MZ_CORE_ERROR("Failed to create index staging buffer!");
+			return false;
+		}
 
 		void* data;
 		vkMapMemory(s_contextPtr->device.logicalDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, indices.data(), (size_t)bufferSize);
+		memcpy(data, indices, (size_t)bufferSize);
 		vkUnmapMemory(s_contextPtr->device.logicalDevice, stagingBufferMemory);
 
-		if (!VulkanFunctions::CreateBuffer(
+		bool created = VulkanFunctions::CreateBuffer(
 			bufferSize,
 			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 			m_indexBuffer,
-			m_indexBufferMemory)) {
-			MZ_CORE_CRITICAL("Failed to create index buffer!");
+			m_indexBufferMemory);
+
+		if (created) {
+			VulkanFunctions::CopyBuffer(stagingBuffer, m_indexBuffer, bufferSize);
+			m_sizeBytes += bufferSize;
+		}
+		else {
+			MZ_CORE_ERROR("Failed to create index buffer!");
+		}
+
+		vkDestroyBuffer(s_contextPtr->device.logicalDevice, stagingBuffer, s_contextPtr->allocator);
+		vkFreeMemory(s_contextPtr->device.logicalDevice, stagingBufferMemory, s_contextPtr->allocator);
+
+		return created;
+	}
+
+	bool VulkanGeometry::CreateMeshletBuffer(const Meshlet* meshlets, uint32_t meshletCount)
+	{
+		VkDeviceSize bufferSize = VkDeviceSize(meshletCount) * sizeof(Meshlet);
+
+		VkBuffer stagingBuffer;
+		VkDeviceMemory stagingBufferMemory;
+		if (!VulkanFunctions::CreateBuffer(
+			bufferSize,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			stagingBuffer,
+			stagingBufferMemory)) {
+			MZ_CORE_ERROR("Failed to create meshlet staging buffer!");
 			return false;
 		}
 
-		VulkanFunctions::CopyBuffer(stagingBuffer, m_indexBuffer, bufferSize);
+		void* data;
+		vkMapMemory(s_contextPtr->device.logicalDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
+		memcpy(data, meshlets, (size_t)bufferSize);
+		vkUnmapMemory(s_contextPtr->device.logicalDevice, stagingBufferMemory);
+
+		bool created = VulkanFunctions::CreateBuffer(
+			bufferSize,
+			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			m_meshletBuffer,
+			m_meshletBufferMemory);
+
+		if (created) {
+			VulkanFunctions::CopyBuffer(stagingBuffer, m_meshletBuffer, bufferSize);
+			m_sizeBytes += bufferSize;
+
+			VkBufferDeviceAddressInfo addressInfo{};
+			addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+			addressInfo.buffer = m_meshletBuffer;
+			m_meshletBufferAddress = vkGetBufferDeviceAddress(s_contextPtr->device.logicalDevice, &addressInfo);
+		}
+		else {
+			// Without an address the geometry is drawn whole
+			MZ_CORE_ERROR("Failed to create meshlet buffer!");
+		}
 
 		vkDestroyBuffer(s_contextPtr->device.logicalDevice, stagingBuffer, s_contextPtr->allocator);
 		vkFreeMemory(s_contextPtr->device.logicalDevice, stagingBufferMemory, s_contextPtr->allocator);
 
-		return true;
+		return created;
 	}
 
 	bool VulkanGeometry::CreateDescriptorSets()
@@ -142,45 +399,50 @@ namespace mz {
 
 		m_descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
 		if (vkAllocateDescriptorSets(s_contextPtr->device.logicalDevice, &allocInfo, m_descriptorSets.data()) != VK_SUCCESS) {
+			m_descriptorSets.clear();
 			return false;
 		}
 
-		// TODO: TEST CODE
-		Texture::LoadTexture(m_textureName, &m_texture);
-		VulkanTexture* vulkanTexturePtr = static_cast<VulkanTexture*>(m_texture);
-		// TODO: END TEST CODE
-
 		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
 			VkDescriptorBufferInfo bufferInfo{};
 			bufferInfo.buffer = s_contextPtr->uniformBuffers[i].handle;
 			bufferInfo.offset = 0;
 			bufferInfo.range = sizeof(UniformBufferObject);
 
-			VkDescriptorImageInfo imageInfo{};
-			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			imageInfo.imageView = vulkanTexturePtr->GetImageView();
-			imageInfo.sampler = s_contextPtr->textureSampler;
-
-			std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
-
-			descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			descriptorWrites[0].dstSet = m_descriptorSets[i];
-			descriptorWrites[0].dstBinding = 0;
-			descriptorWrites[0].dstArrayElement = 0;
-			descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			descriptorWrites[0].descriptorCount = 1;
-			descriptorWrites[0].pBufferInfo = &bufferInfo;
+			VkWriteDescriptorSet descriptorWrite{};
+			descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrite.dstSet = m_descriptorSets[i];
+			descriptorWrite.dstBinding = 0;
+			descriptorWrite.dstArrayElement = 0;
+			descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			descriptorWrite.descriptorCount = 1;
+			descriptorWrite.pBufferInfo = &bufferInfo;
 
-			descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			descriptorWrites[1].dstSet = m_descriptorSets[i];
-			descriptorWrites[1].dstBinding = 1;
-			descriptorWrites[1].dstArrayElement = 0;
-			descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			descriptorWrites[1].descriptorCount = 1;
-			descriptorWrites[1].pImageInfo = &imageInfo;
+			vkUpdateDescriptorSets(s_contextPtr->device.logicalDevice, 1, &descriptorWrite, 0, nullptr);
 
-			vkUpdateDescriptorSets(s_contextPtr->device.logicalDevice, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+			WriteTextureDescriptor(static_cast<uint32_t>(i));
 		}
 		return true;
 	}
+
+	void VulkanGeometry::WriteTextureDescriptor(uint32_t frame) const
+	{
+		VkDescriptorImageInfo imageInfo{};
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageInfo.imageView = m_texture->GetImageView();
+		imageInfo.sampler = s_contextPtr->textureSampler;
+
+		VkWriteDescriptorSet descriptorWrite{};
+		descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrite.dstSet = m_descriptorSets[frame];
+		descriptorWrite.dstBinding = 1;
+		descriptorWrite.dstArrayElement = 0;
+		descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		descriptorWrite.descriptorCount = 1;
+		descriptorWrite.pImageInfo = &imageInfo;
+
+		vkUpdateDescriptorSets(s_contextPtr->device.logicalDevice, 1, &descriptorWrite, 0, nullptr);
+
+		m_descriptorTextureVersions[frame] = m_texture->GetVersion();
+	}
 }
\ No newline at end of file
@@ -3,36 +3,78 @@
 #include "engine/src/mzpch.h"
 #include "engine/src/renderer/geometry.h"
 #include "vulkan_context.h"
+#include "vulkan_texture.h"
 
 namespace mz {
 	class VulkanGeometry : public Geometry {
 	public:
-		VulkanGeometry(std::vector<Vertex3d> vertices, std::vector<uint32_t> indices, std::string textureName);
+		VulkanGeometry(const GeometryData& data, const Texture* texture);
 		~VulkanGeometry();
 		inline static void SetContextPointer(std::shared_ptr<VulkanContext> contextPtr) { s_contextPtr = contextPtr; }
-		virtual void Draw(glm::mat4 model) const override;
+		virtual void Draw(uint32_t objectIndex, uint32_t lod) const override;
+		virtual void DrawDepth(uint32_t objectIndex, uint32_t lod) const override;
+		virtual bool CullMeshlets(uint32_t objectIndex, uint32_t lod) const override;
+		virtual void SetTexture(const Texture* texture) override;
+		virtual uint64_t GetSizeBytes() const override { return m_sizeBytes; }
+		// False when a buffer or the descriptor sets could not be created, Geometry::Create then drops the geometry
+		inline bool IsCreated() const { return m_created; }
+		// Frees the buffers and descriptor sets of deleted geometries that no submitted frame uses anymore, all of
+		// them when force is set. Called once per frame after the fence wait and at shutdown.
+		static void DestroyRetiredResources(bool force);
 	private:
 		inline static std::shared_ptr<VulkanContext> s_contextPtr = nullptr;
 
+		// Buffers and descriptor sets of a deleted geometry that frames already submitted may still read
+		struct RetiredResources {
+			std::array<VkBuffer, 3> buffers;
+			std::array<VkDeviceMemory, 3> memories;
+			std::vector<VkDescriptorSet> descriptorSets;
+			uint64_t lastUseFrame;
+		};
+
+		inline static std::vector<RetiredResources> s_retiredResources;
+
+		VertexFormat m_vertexFormat;
+		VertexDequantization m_dequantization;
 		uint32_t m_vertexCount;
 		uint32_t m_vertexBufferOffset;
 
 		uint32_t m_indexCount;
 		uint32_t m_indexBufferOffset;
+		VkIndexType m_indexType;
 
-		VkBuffer m_vertexBuffer;
-		VkDeviceMemory m_vertexBufferMemory;
+		// Holds the position stream followed by the attribute stream
+		VkBuffer m_vertexBuffer = VK_NULL_HANDLE;
+		VkDeviceSize m_attributeStreamOffset;
+		VkDeviceMemory m_vertexBufferMemory = VK_NULL_HANDLE;
 
-		VkBuffer m_indexBuffer;
-		VkDeviceMemory m_indexBufferMemory;
+		VkBuffer m_indexBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_indexBufferMemory = VK_NULL_HANDLE;
 
-		std::string m_textureName;
-		Texture* m_texture;
+		// Read by the culling pass through its address, only created when the device can cull meshlets. Holds one
+		// meshlet per submesh when the geometry came without cooked ones.
+		VkBuffer m_meshletBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_meshletBufferMemory = VK_NULL_HANDLE;
+		VkDeviceAddress m_meshletBufferAddress = 0;
 
+		// All buffers together
+		uint64_t m_sizeBytes = 0;
+		bool m_created = false;
+
+		// Empty when the allocation failed
 		std::vector<VkDescriptorSet> m_descriptorSets;
 
-		bool CreateVertexBuffer(std::vector<Vertex3d> vertices);
-		bool CreateIndexBuffer(std::vector<uint32_t> indices);
+		// Streaming replaces the texture's image view, each frame's set is rewritten before its next use
+		const VulkanTexture* m_texture;
+		mutable std::array<uint32_t, MAX_FRAMES_IN_FLIGHT> m_descriptorTextureVersions;
+
+		bool CreateVertexBuffer(const void* vertices, uint32_t vertexCount);
+		bool CreateIndexBuffer(const void* indices, VkDeviceSize bufferSize);
+		bool CreateMeshletBuffer(const Meshlet* meshlets, uint32_t meshletCount);
 		bool CreateDescriptorSets();
+		void WriteTextureDescriptor(uint32_t frame) const;
+		// Binds the first streamCount vertex streams and draws the LOD with the given pipeline, the meshlets that
+		// passed the current culling phase when the object was culled and all submeshes in the early phase otherwise
+		void RecordDraw(VkPipeline pipelineHandle, uint32_t streamCount, uint32_t objectIndex, uint32_t lod) const;
 	};
 }
\ No newline at end of file
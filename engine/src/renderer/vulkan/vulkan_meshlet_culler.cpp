@@ -0,0 +1,540 @@
+#include "vulkan_meshlet_culler.h"
+#include "vulkan_functions.h"
+#include "shaders/vulkan_shader_utils.h"
+#include "engine/src/renderer/frustum.h"
+
+namespace mz {
+	bool VulkanMeshletCuller::Create()
+	{
+		if (!CreatePipeline()) {
+			MZ_CORE_ERROR("Failed to create meshlet culling pipeline!");
+			return false;
+		}
+
+		for (FrameResources& frame : m_frames) {
+			if (!VulkanFunctions::CreateBuffer(
+				sizeof(CullUniforms),
+				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				frame.uniformBuffer.handle,
+				frame.uniformBuffer.memory)) {
+				MZ_CORE_ERROR("Failed to create meshlet culling uniform buffer!");
+				return false;
+			}
+			vkMapMemory(s_contextPtr->device.logicalDevice, frame.uniformBuffer.memory, 0, sizeof(CullUniforms), 0, &frame.uniformBuffer.mapped);
+
+			// Small to start with, Begin grows them to the frame's needs
+			if (!CreateDrawBuffer(frame, 1024) || !CreateCountBuffers(frame, 64)) {
+				return false;
+			}
+		}
+
+		if (!CreateDescriptorSets()) {
+			MZ_CORE_ERROR("Failed to create meshlet culling descriptor sets!");
+			return false;
+		}
+
+		// Reads the depth pyramid's view, which has to exist by now
+		for (FrameResources& frame : m_frames) {
+			WriteDescriptorSet(frame);
+		}
+
+		return true;
+	}
+
+	void VulkanMeshletCuller::Destroy()
+	{
+		VkDevice device = s_contextPtr->device.logicalDevice;
+
+		for (FrameResources& frame : m_frames) {
+			DestroyCountBuffers(frame);
+			DestroyDrawBuffer(frame);
+			vkDestroyBuffer(device, frame.uniformBuffer.handle, s_contextPtr->allocator);
+			vkFreeMemory(device, frame.uniformBuffer.memory, s_contextPtr->allocator);
+		}
+
+		vkDestroyDescriptorPool(device, m_descriptorPool, s_contextPtr->allocator);
+		vkDestroyPipeline(device, s_contextPtr->meshletCulling.handle, s_contextPtr->allocator);
+		vkDestroyPipelineLayout(device, s_contextPtr->meshletCulling.layout, s_contextPtr->allocator);
+		vkDestroyDescriptorSetLayout(device, s_contextPtr->meshletCulling.descriptorSetLayout, s_contextPtr->allocator);
+	}
+
+	void VulkanMeshletCuller::BeginFrame(RendererFrameStats& stats)
+	{
+		VulkanMeshletCullingInfo& culling = s_contextPtr->meshletCulling;
+		culling.active = false;
+		culling.occlusion = false;
+		culling.phase = 0;
+		culling.reservedDraws = 0;
+		culling.reservedCounts = 0;
+		culling.objectRanges.clear();
+
+		// The frame's fence has signaled, the copy recorded by its last submission is complete
+		FrameResources& frame = m_frames[s_contextPtr->currentFrame];
+		if (frame.readbackCounts > 0) {
+			uint32_t visibleMeshlets = 0;
+			for (uint32_t i = s_meshletCullStatisticsCount; i < frame.readbackCounts; ++i) {
+				visibleMeshlets += frame.readbackMapped[i];
+			}
+
+			uint32_t earlyOccluded = frame.readbackMapped[0];
+			uint32_t lateOccluded = std::min(frame.readbackMapped[1], earlyOccluded);
+
+			stats.testedMeshlets = frame.readbackMeshlets;
+			stats.culledMeshlets = frame.readbackMeshlets - std::min(visibleMeshlets, frame.readbackMeshlets);
+			stats.occludedMeshlets = lateOccluded;
+			stats.disoccludedMeshlets = earlyOccluded - lateOccluded;
+		}
+		frame.readbackCounts = 0;
+		frame.readbackMeshlets = 0;
+	}
+
+	bool VulkanMeshletCuller::Begin(VkCommandBuffer commandBuffer, const RendererCullingState& state)
+	{
+		VulkanMeshletCullingInfo& culling = s_contextPtr->meshletCulling;
+		FrameResources& frame = m_frames[s_contextPtr->currentFrame];
+
+		if (state.meshletCount == 0 || state.culledObjectCount == 0) {
+			return false;
+		}
+
+		// The late phase gets its own draws and count after the early ones of every object
+		const VulkanDepthPyramidInfo& pyramid = s_contextPtr->depthPyramid;
+		bool occlusion = state.occlusion && s_contextPtr->device.depthSampling && pyramid.view != VK_NULL_HANDLE;
+		uint32_t rangesPerObject = occlusion ? 2 : 1;
+		uint32_t requiredDraws = state.meshletCount * rangesPerObject;
+		uint32_t requiredCounts = s_meshletCullStatisticsCount + state.culledObjectCount * rangesPerObject;
+
+		// Nothing recorded so far this frame references the buffers and the frame's previous submission has
+		// finished, so they can be replaced without waiting
+		bool resized = false;
+		if (requiredDraws > frame.drawCapacity) {
+			DestroyDrawBuffer(frame);
+			if (!CreateDrawBuffer(frame, std::max(requiredDraws, frame.drawCapacity * 2))) {
+				return false;
+			}
+			resized = true;
+		}
+
+		if (requiredCounts > frame.countCapacity) {
+			DestroyCountBuffers(frame);
+			if (!CreateCountBuffers(frame, std::max(requiredCounts, frame.countCapacity * 2))) {
+				return false;
+			}
+			resized = true;
+		}
+
+		if (resized || frame.pyramidVersion != pyramid.version) {
+			WriteDescriptorSet(frame);
+		}
+
+		CullUniforms uniforms{};
+		Frustum frustum(state.viewProjection);
+		for (size_t i = 0; i < frustum.planes.size(); ++i) {
+			uniforms.frustumPlanes[i] = frustum.planes[i];
+		}
+		uniforms.cameraPosition = glm::vec4(state.cameraPosition, 1.0f);
+		uniforms.viewProjection = state.viewProjection;
+		uniforms.previousViewProjection = m_pyramidViewProjection;
+
+		// A recreated pyramid holds nothing yet, the early phase then draws everything in view
+		bool history = occlusion && m_pyramidValid && m_pyramidVersion == pyramid.version;
+		uniforms.pyramid = glm::vec4(
+			static_cast<float>(pyramid.width), static_cast<float>(pyramid.height), static_cast<float>(pyramid.levelCount),
+			history ? 1.0f : 0.0f);
+		memcpy(frame.uniformBuffer.mapped, &uniforms, sizeof(uniforms));
+		m_viewProjection = state.viewProjection;
+
+		vkCmdFillBuffer(commandBuffer, frame.countBuffer, 0, VkDeviceSize(requiredCounts) * sizeof(uint32_t), 0);
+
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.buffer = frame.countBuffer;
+		barrier.offset = 0;
+		barrier.size = VK_WHOLE_SIZE;
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0,
+			0, nullptr,
+			1, &barrier,
+			0, nullptr);
+
+		Bind(commandBuffer, frame);
+
+		culling.active = true;
+		culling.occlusion = occlusion;
+		culling.phase = 0;
+		culling.drawBuffer = frame.drawBuffer;
+		culling.countBuffer = frame.countBuffer;
+		culling.drawCapacity = frame.drawCapacity;
+		culling.countCapacity = frame.countCapacity;
+		culling.reservedCounts = s_meshletCullStatisticsCount;
+		culling.objectRanges.assign(state.objectCount, VulkanMeshletDrawRange{});
+
+		return true;
+	}
+
+	bool VulkanMeshletCuller::BeginLate(VkCommandBuffer commandBuffer)
+	{
+		VulkanMeshletCullingInfo& culling = s_contextPtr->meshletCulling;
+		if (!culling.active || !culling.occlusion) {
+			return false;
+		}
+
+		FrameResources& frame = m_frames[s_contextPtr->currentFrame];
+
+		// The early phase's flags and statistics are read and its counts sit next to the late ones, which the
+		// early indirect draws may still be reading
+		std::array<VkBufferMemoryBarrier, 2> barriers{};
+		for (VkBufferMemoryBarrier& barrier : barriers) {
+			barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.offset = 0;
+			barrier.size = VK_WHOLE_SIZE;
+		}
+		barriers[0].buffer = frame.occludedBuffer;
+		barriers[1].buffer = frame.countBuffer;
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0,
+			0, nullptr,
+			static_cast<uint32_t>(barriers.size()), barriers.data(),
+			0, nullptr);
+
+		// Building the pyramid bound its own pipeline
+		Bind(commandBuffer, frame);
+		culling.phase = 1;
+
+		return true;
+	}
+
+	void VulkanMeshletCuller::End(VkCommandBuffer commandBuffer)
+	{
+		FrameResources& frame = m_frames[s_contextPtr->currentFrame];
+
+		std::array<VkBufferMemoryBarrier, 2> barriers{};
+		for (VkBufferMemoryBarrier& barrier : barriers) {
+			barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.offset = 0;
+			barrier.size = VK_WHOLE_SIZE;
+		}
+		barriers[0].buffer = frame.drawBuffer;
+		barriers[1].buffer = frame.countBuffer;
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+			0,
+			0, nullptr,
+			static_cast<uint32_t>(barriers.size()), barriers.data(),
+			0, nullptr);
+	}
+
+	void VulkanMeshletCuller::OnDepthPyramidBuilt()
+	{
+		m_pyramidViewProjection = m_viewProjection;
+		m_pyramidVersion = s_contextPtr->depthPyramid.version;
+		m_pyramidValid = true;
+	}
+
+	void VulkanMeshletCuller::RecordReadback(VkCommandBuffer commandBuffer)
+	{
+		const VulkanMeshletCullingInfo& culling = s_contextPtr->meshletCulling;
+		if (!culling.active || culling.reservedCounts <= s_meshletCullStatisticsCount) {
+			return;
+		}
+
+		FrameResources& frame = m_frames[s_contextPtr->currentFrame];
+
+		// After the indirect draws that read the counts, and seeing the culling pass's writes
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.buffer = frame.countBuffer;
+		barrier.offset = 0;
+		barrier.size = VK_WHOLE_SIZE;
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0,
+			0, nullptr,
+			1, &barrier,
+			0, nullptr);
+
+		VkBufferCopy region{ 0, 0, VkDeviceSize(culling.reservedCounts) * sizeof(uint32_t) };
+		vkCmdCopyBuffer(commandBuffer, frame.countBuffer, frame.readbackBuffer, 1, &region);
+
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		barrier.buffer = frame.readbackBuffer;
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+			0,
+			0, nullptr,
+			1, &barrier,
+			0, nullptr);
+
+		frame.readbackCounts = culling.reservedCounts;
+		frame.readbackMeshlets = culling.reservedDraws;
+	}
+
+	bool VulkanMeshletCuller::CreatePipeline()
+	{
+		VulkanMeshletCullingInfo& culling = s_contextPtr->meshletCulling;
+
+		std::array<VkDescriptorSetLayoutBinding, 5> bindings{};
+		for (uint32_t i = 0; i < bindings.size(); ++i) {
+			bindings[i].binding = i;
+			bindings[i].descriptorCount = 1;
+			bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+
+		// Uniforms, then indirect commands, draw counts and occlusion flags, then the depth pyramid
+		bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[4].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+		layoutInfo.pBindings = bindings.data();
+
+		if (vkCreateDescriptorSetLayout(s_contextPtr->device.logicalDevice, &layoutInfo, s_contextPtr->allocator, &culling.descriptorSetLayout) != VK_SUCCESS) {
+			return false;
+		}
+
+		std::array<VkDescriptorSetLayout, 2> setLayouts = { culling.descriptorSetLayout, s_contextPtr->objectBuffer.descriptorSetLayout };
+
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(MeshletCullConstants);
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+		pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		if (vkCreatePipelineLayout(s_contextPtr->device.logicalDevice, &pipelineLayoutInfo, s_contextPtr->allocator, &culling.layout) != VK_SUCCESS) {
+			return false;
+		}
+
+		auto shaderCode = EngineReadFile(s_meshletCullShaderFileName);
+		VkShaderModule shaderModule = CreateShaderModule(shaderCode, s_contextPtr->device.logicalDevice);
+
+		VkComputePipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		pipelineInfo.stage.module = shaderModule;
+		pipelineInfo.stage.pName = "main";
+		pipelineInfo.layout = culling.layout;
+
+		VkResult result = vkCreateComputePipelines(s_contextPtr->device.logicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, s_contextPtr->allocator, &culling.handle);
+		vkDestroyShaderModule(s_contextPtr->device.logicalDevice, shaderModule, s_contextPtr->allocator);
+
+		return result == VK_SUCCESS;
+	}
+
+	bool VulkanMeshletCuller::CreateDescriptorSets()
+	{
+		std::array<VkDescriptorPoolSize, 3> poolSizes{};
+		poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		poolSizes[0].descriptorCount = MAX_FRAMES_IN_FLIGHT;
+		poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSizes[1].descriptorCount = 3 * MAX_FRAMES_IN_FLIGHT;
+		poolSizes[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		poolSizes[2].descriptorCount = MAX_FRAMES_IN_FLIGHT;
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+		poolInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
+
+		if (vkCreateDescriptorPool(s_contextPtr->device.logicalDevice, &poolInfo, s_contextPtr->allocator, &m_descriptorPool) != VK_SUCCESS) {
+			return false;
+		}
+
+		for (FrameResources& frame : m_frames) {
+			VkDescriptorSetAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			allocInfo.descriptorPool = m_descriptorPool;
+			allocInfo.descriptorSetCount = 1;
+			allocInfo.pSetLayouts = &s_contextPtr->meshletCulling.descriptorSetLayout;
+
+			if (vkAllocateDescriptorSets(s_contextPtr->device.logicalDevice, &allocInfo, &frame.descriptorSet) != VK_SUCCESS) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void VulkanMeshletCuller::WriteDescriptorSet(FrameResources& frame)
+	{
+		std::array<VkDescriptorBufferInfo, 4> bufferInfos{};
+		bufferInfos[0] = { frame.uniformBuffer.handle, 0, sizeof(CullUniforms) };
+		bufferInfos[1] = { frame.drawBuffer, 0, VK_WHOLE_SIZE };
+		bufferInfos[2] = { frame.countBuffer, 0, VK_WHOLE_SIZE };
+		bufferInfos[3] = { frame.occludedBuffer, 0, VK_WHOLE_SIZE };
+
+		std::array<VkWriteDescriptorSet, 5> descriptorWrites{};
+		for (uint32_t i = 0; i < bufferInfos.size(); ++i) {
+			descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[i].dstSet = frame.descriptorSet;
+			descriptorWrites[i].dstBinding = i;
+			descriptorWrites[i].dstArrayElement = 0;
+			descriptorWrites[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorWrites[i].descriptorCount = 1;
+			descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+		}
+
+		// Only read when the frame culls occlusion, but the set has to be complete either way
+		const VulkanDepthPyramidInfo& pyramid = s_contextPtr->depthPyramid;
+		VkDescriptorImageInfo pyramidInfo{ pyramid.sampler, pyramid.view, VK_IMAGE_LAYOUT_GENERAL };
+
+		descriptorWrites[4].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[4].dstSet = frame.descriptorSet;
+		descriptorWrites[4].dstBinding = 4;
+		descriptorWrites[4].dstArrayElement = 0;
+		descriptorWrites[4].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		descriptorWrites[4].descriptorCount = 1;
+		descriptorWrites[4].pImageInfo = &pyramidInfo;
+
+		vkUpdateDescriptorSets(s_contextPtr->device.logicalDevice, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+		frame.pyramidVersion = pyramid.version;
+	}
+
+	void VulkanMeshletCuller::Bind(VkCommandBuffer commandBuffer, const FrameResources& frame)
+	{
+		const VulkanMeshletCullingInfo& culling = s_contextPtr->meshletCulling;
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, culling.handle);
+
+		// Set 1 is the object buffer, laid out as in the vertex shaders
+		std::array<VkDescriptorSet, 2> descriptorSets = { frame.descriptorSet, s_contextPtr->objectBuffer.descriptorSet };
+		vkCmdBindDescriptorSets(
+			commandBuffer,
+			VK_PIPELINE_BIND_POINT_COMPUTE,
+			culling.layout,
+			0,
+			static_cast<uint32_t>(descriptorSets.size()),
+			descriptorSets.data(),
+			0,
+			nullptr);
+	}
+
+	bool VulkanMeshletCuller::CreateDrawBuffer(FrameResources& frame, uint32_t capacity)
+	{
+		if (!VulkanFunctions::CreateBuffer(
+			VkDeviceSize(capacity) * sizeof(VkDrawIndexedIndirectCommand),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			frame.drawBuffer,
+			frame.drawMemory)) {
+			MZ_CORE_ERROR("Failed to create meshlet draw buffer!");
+			return false;
+		}
+
+		if (!VulkanFunctions::CreateBuffer(
+			VkDeviceSize(capacity) * sizeof(uint32_t),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			frame.occludedBuffer,
+			frame.occludedMemory)) {
+			MZ_CORE_ERROR("Failed to create meshlet occlusion flag buffer!");
+			return false;
+		}
+
+		frame.drawCapacity = capacity;
+		return true;
+	}
+
+	void VulkanMeshletCuller::DestroyDrawBuffer(FrameResources& frame)
+	{
+		vkDestroyBuffer(s_contextPtr->device.logicalDevice, frame.occludedBuffer, s_contextPtr->allocator);
+		vkFreeMemory(s_contextPtr->device.logicalDevice, frame.occludedMemory, s_contextPtr->allocator);
+		vkDestroyBuffer(s_contextPtr->device.logicalDevice, frame.drawBuffer, s_contextPtr->allocator);
+		vkFreeMemory(s_contextPtr->device.logicalDevice, frame.drawMemory, s_contextPtr->allocator);
+		frame.occludedBuffer = VK_NULL_HANDLE;
+		frame.occludedMemory = VK_NULL_HANDLE;
+		frame.drawBuffer = VK_NULL_HANDLE;
+		frame.drawMemory = VK_NULL_HANDLE;
+		frame.drawCapacity = 0;
+	}
+
+	bool VulkanMeshletCuller::CreateCountBuffers(FrameResources& frame, uint32_t capacity)
+	{
+		VkDeviceSize size = VkDeviceSize(capacity) * sizeof(uint32_t);
+
+		if (!VulkanFunctions::CreateBuffer(
+			size,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			frame.countBuffer,
+			frame.countMemory)) {
+			MZ_CORE_ERROR("Failed to create meshlet draw count buffer!");
+			return false;
+		}
+
+		if (!VulkanFunctions::CreateBuffer(
+			size,
+			VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			frame.readbackBuffer,
+			frame.readbackMemory)) {
+			MZ_CORE_ERROR("Failed to create meshlet draw count readback buffer!");
+			return false;
+		}
+
+		void* mapped;
+		vkMapMemory(s_contextPtr->device.logicalDevice, frame.readbackMemory, 0, size, 0, &mapped);
+		frame.readbackMapped = static_cast<const uint32_t*>(mapped);
+		frame.countCapacity = capacity;
+
+		return true;
+	}
+
+	void VulkanMeshletCuller::DestroyCountBuffers(FrameResources& frame)
+	{
+		if (frame.readbackMapped) {
+			vkUnmapMemory(s_contextPtr->device.logicalDevice, frame.readbackMemory);
+		}
+
+		vkDestroyBuffer(s_contextPtr->device.logicalDevice, frame.readbackBuffer, s_contextPtr->allocator);
+		vkFreeMemory(s_contextPtr->device.logicalDevice, frame.readbackMemory, s_contextPtr->allocator);
+		vkDestroyBuffer(s_contextPtr->device.logicalDevice, frame.countBuffer, s_contextPtr->allocator);
+		vkFreeMemory(s_contextPtr->device.logicalDevice, frame.countMemory, s_contextPtr->allocator);
+		frame.readbackBuffer = VK_NULL_HANDLE;
+		frame.readbackMemory = VK_NULL_HANDLE;
+		frame.readbackMapped = nullptr;
+		frame.countBuffer = VK_NULL_HANDLE;
+		frame.countMemory = VK_NULL_HANDLE;
+		frame.countCapacity = 0;
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "engine/src/renderer/renderer_backend.h"
+#include "vulkan_context.h"
+
+namespace mz {
+	// Compute pass culling meshlets against the frustum, their normal cones and the depth pyramid. Every frame in
+	// flight has its own indirect command, draw count and uniform buffers, so growing them never waits for the GPU.
+	// Geometries record one dispatch per object into the reserved ranges and draw the survivors with
+	// vkCmdDrawIndexedIndirectCount. The draw counts are copied back after the frame and read once its fence has
+	// signaled, never stalling.
+	//
+	// With occlusion culling the early phase tests against the pyramid of the previous frame's depth. The late
+	// phase tests what it rejected against the pyramid of the early draws, see engine-meshlet-cull.comp.
+	class VulkanMeshletCuller {
+	public:
+		bool Create();
+		void Destroy();
+
+		// Forgets the previous use of the current frame's buffers and reports the culling results it read back
+		void BeginFrame(RendererFrameStats& stats);
+		// Sizes the current frame's buffers, clears the draw counts and binds the pipeline for the early phase.
+		// Outside of a render pass.
+		bool Begin(VkCommandBuffer commandBuffer, const RendererCullingState& state);
+		// Binds the pipeline for the late phase once the pyramid holds the early draws' depth. Returns false,
+		// recording nothing, when the frame does not cull occlusion.
+		bool BeginLate(VkCommandBuffer commandBuffer);
+		// Makes the written draws visible to the indirect draws, after either phase
+		void End(VkCommandBuffer commandBuffer);
+		// The pyramid was built from the frame's final depth, the next frame's early phase tests against it
+		void OnDepthPyramidBuilt();
+		// Copies the draw counts for BeginFrame to read, after the last indirect draw
+		void RecordReadback(VkCommandBuffer commandBuffer);
+
+		inline static void SetContextPointer(std::shared_ptr<VulkanContext> contextPtr) { s_contextPtr = contextPtr; }
+	private:
+		inline static std::shared_ptr<VulkanContext> s_contextPtr = nullptr;
+		inline static const std::string s_meshletCullShaderFileName = "assets/shaders/engine-meshlet-cull.comp.spv";
+
+		// Uniform block of engine-meshlet-cull.comp
+		struct CullUniforms {
+			std::array<glm::vec4, 6> frustumPlanes;
+			glm::vec4 cameraPosition;
+			glm::mat4 viewProjection;
+			glm::mat4 previousViewProjection;
+			glm::vec4 pyramid;
+		};
+
+		struct FrameResources {
+			VkBuffer drawBuffer = VK_NULL_HANDLE;
+			VkDeviceMemory drawMemory = VK_NULL_HANDLE;
+			// Occlusion flag per draw slot, passed from the early phase to the late one
+			VkBuffer occludedBuffer = VK_NULL_HANDLE;
+			VkDeviceMemory occludedMemory = VK_NULL_HANDLE;
+			uint32_t drawCapacity = 0;
+
+			// Draw counts and their host visible copy, both countCapacity entries
+			VkBuffer countBuffer = VK_NULL_HANDLE;
+			VkDeviceMemory countMemory = VK_NULL_HANDLE;
+			VkBuffer readbackBuffer = VK_NULL_HANDLE;
+			VkDeviceMemory readbackMemory = VK_NULL_HANDLE;
+			const uint32_t* readbackMapped = nullptr;
+			uint32_t countCapacity = 0;
+
+			UniformBuffer uniformBuffer{};
+			VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+			// VulkanDepthPyramidInfo::version the set was written with
+			uint32_t pyramidVersion = 0;
+
+			// Objects and meshlets the readback copy of the frame's last submission covers, zero when nothing was copied
+			uint32_t readbackCounts = 0;
+			uint32_t readbackMeshlets = 0;
+		};
+
+		std::array<FrameResources, MAX_FRAMES_IN_FLIGHT> m_frames;
+		VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+
+		// The current frame's matrix, and the one the pyramid's contents were last built with for the given version
+		// of the pyramid. The queue runs the frames in order, so the next frame reads what this one recorded.
+		glm::mat4 m_viewProjection = glm::mat4(1.0f);
+		glm::mat4 m_pyramidViewProjection = glm::mat4(1.0f);
+		uint32_t m_pyramidVersion = 0;
+		bool m_pyramidValid = false;
+
+		bool CreatePipeline();
+		bool CreateDescriptorSets();
+		void WriteDescriptorSet(FrameResources& frame);
+		// Binds the pipeline and the frame's sets for a phase
+		void Bind(VkCommandBuffer commandBuffer, const FrameResources& frame);
+		bool CreateDrawBuffer(FrameResources& frame, uint32_t capacity);
+		void DestroyDrawBuffer(FrameResources& frame);
+		bool CreateCountBuffers(FrameResources& frame, uint32_t capacity);
+		void DestroyCountBuffers(FrameResources& frame);
+	};
+}
\ No newline at end of file
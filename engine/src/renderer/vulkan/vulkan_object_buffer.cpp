@@ -0,0 +1,285 @@
+#include "vulkan_object_buffer.h"
+#include "vulkan_functions.h"
+
+namespace mz {
+	bool VulkanObjectBuffer::Create(uint32_t initialCapacity)
+	{
+		if (!CreateDeviceBuffer(initialCapacity)) {
+			return false;
+		}
+
+		if (!CreateStagingRing(initialCapacity)) {
+			return false;
+		}
+
+		if (!CreateDescriptorSets()) {
+			MZ_CORE_ERROR("Failed to create object buffer descriptor sets!");
+			return false;
+		}
+
+		for (uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; ++frame) {
+			WriteDescriptorSet(frame);
+		}
+		s_contextPtr->objectBuffer.descriptorSet = m_descriptorSets[s_contextPtr->currentFrame];
+		return true;
+	}
+
+	void VulkanObjectBuffer::Destroy()
+	{
+		vkDestroyDescriptorPool(s_contextPtr->device.logicalDevice, m_descriptorPool, s_contextPtr->allocator);
+		vkDestroyDescriptorSetLayout(s_contextPtr->device.logicalDevice, s_contextPtr->objectBuffer.descriptorSetLayout, s_contextPtr->allocator);
+
+		// The GPU is idle at shutdown, the current buffers are retired along with the rest
+		if (m_stagingMapped) {
+			vkUnmapMemory(s_contextPtr->device.logicalDevice, m_stagingMemory);
+			m_stagingMapped = nullptr;
+		}
+		Retire(m_stagingBuffer, m_stagingMemory);
+		Retire(m_buffer, m_memory);
+		DestroyRetiredBuffers(true);
+
+		m_stagingBuffer = VK_NULL_HANDLE;
+		m_stagingMemory = VK_NULL_HANDLE;
+		m_stagingCapacity = 0;
+		m_buffer = VK_NULL_HANDLE;
+		m_memory = VK_NULL_HANDLE;
+		m_capacity = 0;
+	}
+
+	bool VulkanObjectBuffer::Upload(VkCommandBuffer commandBuffer, const RendererObjectData& objects, RendererFrameStats& stats)
+	{
+		DestroyRetiredBuffers(false);
+
+		// Rare, the previous buffer stays in use when the larger one cannot be created
+		bool fits = objects.count <= m_capacity || CreateDeviceBuffer(std::max(objects.count, m_capacity * 2));
+
+		// The frame's previous submission has finished, so its set can follow a replaced buffer
+		uint32_t frame = s_contextPtr->currentFrame;
+		if (m_descriptorVersions[frame] != m_bufferVersion) {
+			WriteDescriptorSet(frame);
+		}
+		s_contextPtr->objectBuffer.descriptorSet = m_descriptorSets[frame];
+
+		if (!fits) {
+			return false;
+		}
+
+		bool fullUpload = m_fullUploadPending;
+		uint32_t uploadCount = fullUpload ? objects.count : objects.dirtyCount;
+		if (uploadCount > m_stagingCapacity && !CreateStagingRing(std::max(uploadCount, m_stagingCapacity * 2))) {
+			return false;
+		}
+
+		m_fullUploadPending = false;
+		if (uploadCount == 0) {
+			return true;
+		}
+
+		// The fence of this frame has been waited on, so its staging slice is free to overwrite
+		VkDeviceSize sliceOffset = s_contextPtr->currentFrame * m_stagingCapacity * s_recordSize;
+		uploadCount = VulkanObjectStaging::StageRecords(objects, fullUpload, m_stagingMapped + sliceOffset, sliceOffset, m_copyRegions);
+
+		if (m_copyRegions.empty()) {
+			return true;
+		}
+
+		// Previous frames may still be reading the records about to be overwritten
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0,
+			0, nullptr,
+			0, nullptr,
+			0, nullptr);
+
+		vkCmdCopyBuffer(commandBuffer, m_stagingBuffer, m_buffer, static_cast<uint32_t>(m_copyRegions.size()), m_copyRegions.data());
+
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.buffer = m_buffer;
+		barrier.offset = 0;
+		barrier.size = VK_WHOLE_SIZE;
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0,
+			0, nullptr,
+			1, &barrier,
+			0, nullptr);
+
+		stats.uploadedObjects += uploadCount;
+		stats.uploadRegions += static_cast<uint32_t>(m_copyRegions.size());
+		stats.uploadedBytes += uploadCount * s_recordSize;
+
+		return true;
+	}
+
+	void VulkanObjectBuffer::Bind(VkCommandBuffer commandBuffer) const
+	{
+		vkCmdBindDescriptorSets(
+			commandBuffer,
+			VK_PIPELINE_BIND_POINT_GRAPHICS,
+			s_contextPtr->graphicsRenderingPipeline.layout,
+			1,
+			1,
+			&s_contextPtr->objectBuffer.descriptorSet,
+			0,
+			nullptr);
+	}
+
+	bool VulkanObjectBuffer::CreateDeviceBuffer(uint32_t capacity)
+	{
+		VkBuffer buffer;
+		VkDeviceMemory memory;
+		if (!VulkanFunctions::CreateBuffer(
+			capacity * s_recordSize,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			buffer,
+			memory)) {
+			MZ_CORE_ERROR("Failed to create object buffer!");
+			return false;
+		}
+
+		Retire(m_buffer, m_memory);
+		m_buffer = buffer;
+		m_memory = memory;
+		m_capacity = capacity;
+		++m_bufferVersion;
+
+		// The new buffer starts empty
+		m_fullUploadPending = true;
+		return true;
+	}
+
+	bool VulkanObjectBuffer::CreateStagingRing(uint32_t recordsPerFrame)
+	{
+		VkDeviceSize size = recordsPerFrame * s_recordSize * MAX_FRAMES_IN_FLIGHT;
+
+		VkBuffer buffer;
+		VkDeviceMemory memory;
+		if (!VulkanFunctions::CreateBuffer(
+			size,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			buffer,
+			memory)) {
+			MZ_CORE_ERROR("Failed to create object staging buffer!");
+			return false;
+		}
+
+		// Copies of frames in flight still read the old ring, only the host is done with its mapping
+		if (m_stagingMapped) {
+			vkUnmapMemory(s_contextPtr->device.logicalDevice, m_stagingMemory);
+		}
+		Retire(m_stagingBuffer, m_stagingMemory);
+
+		void* mapped;
+		vkMapMemory(s_contextPtr->device.logicalDevice, memory, 0, size, 0, &mapped);
+		m_stagingBuffer = buffer;
+		m_stagingMemory = memory;
+		m_stagingMapped = static_cast<uint8_t*>(mapped);
+		m_stagingCapacity = recordsPerFrame;
+
+		return true;
+	}
+
+	void VulkanObjectBuffer::Retire(VkBuffer buffer, VkDeviceMemory memory)
+	{
+		if (buffer == VK_NULL_HANDLE) {
+			return;
+		}
+
+		// Every frame submitted so far may still reference the buffer
+		m_retired.push_back({ buffer, memory, s_contextPtr->submittedFrameCount });
+	}
+
+	void VulkanObjectBuffer::DestroyRetiredBuffers(bool force)
+	{
+		for (size_t i = 0; i < m_retired.size();) {
+			if (force || m_retired[i].lastUseFrame <= s_contextPtr->completedFrameCount) {
+				vkDestroyBuffer(s_contextPtr->device.logicalDevice, m_retired[i].buffer, s_contextPtr->allocator);
+				vkFreeMemory(s_contextPtr->device.logicalDevice, m_retired[i].memory, s_contextPtr->allocator);
+				m_retired[i] = m_retired.back();
+				m_retired.pop_back();
+			}
+			else {
+				++i;
+			}
+		}
+	}
+
+	bool VulkanObjectBuffer::CreateDescriptorSets()
+	{
+		VkDescriptorSetLayoutBinding objectLayoutBinding{};
+		objectLayoutBinding.binding = 0;
+		objectLayoutBinding.descriptorCount = 1;
+		objectLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		objectLayoutBinding.pImmutableSamplers = nullptr;
+		// The meshlet culling pass reads the transforms too
+		objectLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = 1;
+		layoutInfo.pBindings = &objectLayoutBinding;
+
+		if (vkCreateDescriptorSetLayout(s_contextPtr->device.logicalDevice, &layoutInfo, s_contextPtr->allocator, &s_contextPtr->objectBuffer.descriptorSetLayout) != VK_SUCCESS) {
+			return false;
+		}
+
+		VkDescriptorPoolSize poolSize{};
+		poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSize.descriptorCount = MAX_FRAMES_IN_FLIGHT;
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.poolSizeCount = 1;
+		poolInfo.pPoolSizes = &poolSize;
+		poolInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
+
+		if (vkCreateDescriptorPool(s_contextPtr->device.logicalDevice, &poolInfo, s_contextPtr->allocator, &m_descriptorPool) != VK_SUCCESS) {
+			return false;
+		}
+
+		std::array<VkDescriptorSetLayout, MAX_FRAMES_IN_FLIGHT> layouts;
+		layouts.fill(s_contextPtr->objectBuffer.descriptorSetLayout);
+
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = m_descriptorPool;
+		allocInfo.descriptorSetCount = MAX_FRAMES_IN_FLIGHT;
+		allocInfo.pSetLayouts = layouts.data();
+
+		if (vkAllocateDescriptorSets(s_contextPtr->device.logicalDevice, &allocInfo, m_descriptorSets.data()) != VK_SUCCESS) {
+			return false;
+		}
+
+		return true;
+	}
+
+	void VulkanObjectBuffer::WriteDescriptorSet(uint32_t frame)
+	{
+		VkDescriptorBufferInfo bufferInfo{};
+		bufferInfo.buffer = m_buffer;
+		bufferInfo.offset = 0;
+		bufferInfo.range = VK_WHOLE_SIZE;
+
+		VkWriteDescriptorSet descriptorWrite{};
+		descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrite.dstSet = m_descriptorSets[frame];
+		descriptorWrite.dstBinding = 0;
+		descriptorWrite.dstArrayElement = 0;
+		descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descriptorWrite.descriptorCount = 1;
+		descriptorWrite.pBufferInfo = &bufferInfo;
+
+		vkUpdateDescriptorSets(s_contextPtr->device.logicalDevice, 1, &descriptorWrite, 0, nullptr);
+		m_descriptorVersions[frame] = m_bufferVersion;
+	}
+}
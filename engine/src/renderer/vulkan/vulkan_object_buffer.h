@@ -0,0 +1,70 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "engine/src/renderer/renderer_backend.h"
+#include "vulkan_context.h"
+#include "vulkan_object_staging.h"
+
+namespace mz {
+	// Device local storage buffer holding one record per render proxy, read in the vertex shader
+	// through gl_InstanceIndex and by the meshlet culling pass. Each frame only the changed records are written into that frame's
+	// slice of a host visible staging ring and scattered into place with vkCmdCopyBuffer regions. Growing either
+	// buffer never waits for the GPU: the replaced one is retired until the frames that may read it have finished.
+	class VulkanObjectBuffer {
+	public:
+		bool Create(uint32_t initialCapacity);
+		void Destroy();
+
+		// Records transfer commands, must be called outside of a render pass. Selects the current frame's descriptor
+		// set. Returns false when the records could not all be written, the frame must not draw them then.
+		bool Upload(VkCommandBuffer commandBuffer, const RendererObjectData& objects, RendererFrameStats& stats);
+		void Bind(VkCommandBuffer commandBuffer) const;
+
+		inline static void SetContextPointer(std::shared_ptr<VulkanContext> contextPtr) { s_contextPtr = contextPtr; }
+	private:
+		inline static std::shared_ptr<VulkanContext> s_contextPtr = nullptr;
+
+		static constexpr VkDeviceSize s_recordSize = VulkanObjectStaging::s_recordSize;
+
+		VkBuffer m_buffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_memory = VK_NULL_HANDLE;
+		uint32_t m_capacity = 0;
+		// Bumped whenever the device buffer is replaced, descriptor sets written with an older one are stale
+		uint32_t m_bufferVersion = 0;
+		// A replaced device buffer starts empty, set until a full upload into it has been recorded
+		bool m_fullUploadPending = false;
+
+		// One slice of m_stagingCapacity records per frame in flight
+		VkBuffer m_stagingBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_stagingMemory = VK_NULL_HANDLE;
+		uint8_t* m_stagingMapped = nullptr;
+		uint32_t m_stagingCapacity = 0;
+
+		VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+		// One set per frame in flight, a frame's set is only rewritten once its previous submission has finished.
+		// VulkanObjectBufferInfo::descriptorSet is the current frame's.
+		std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> m_descriptorSets{};
+		std::array<uint32_t, MAX_FRAMES_IN_FLIGHT> m_descriptorVersions{};
+
+		struct RetiredBuffer {
+			VkBuffer buffer;
+			VkDeviceMemory memory;
+			uint64_t lastUseFrame;
+		};
+
+		// Replaced buffers frames in flight may still read, destroyed once completedFrameCount reaches lastUseFrame
+		std::vector<RetiredBuffer> m_retired;
+
+		// Reused every frame so steady-state uploads do not allocate
+		std::vector<VkBufferCopy> m_copyRegions;
+
+		// Both keep the current buffer when the new one cannot be created, and retire it otherwise
+		bool CreateDeviceBuffer(uint32_t capacity);
+		bool CreateStagingRing(uint32_t recordsPerFrame);
+		void Retire(VkBuffer buffer, VkDeviceMemory memory);
+		// Destroys the retired buffers the GPU is done with, all of them when force is set
+		void DestroyRetiredBuffers(bool force);
+		bool CreateDescriptorSets();
+		void WriteDescriptorSet(uint32_t frame);
+	};
+}
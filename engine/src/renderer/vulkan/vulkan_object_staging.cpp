@@ -0,0 +1,41 @@
+#include "vulkan_object_staging.h"
+
+namespace mz {
+	uint32_t VulkanObjectStaging::StageRecords(const RendererObjectData& objects, bool fullUpload, uint8_t* staging, VkDeviceSize sliceOffset,
+		std::vector<VkBufferCopy>& outRegions)
+	{
+		glm::mat4* records = reinterpret_cast<glm::mat4*>(staging);
+		outRegions.clear();
+
+		if (fullUpload) {
+			if (objects.count > 0) {
+				memcpy(records, objects.transforms, objects.count * s_recordSize);
+				outRegions.push_back({ sliceOffset, 0, objects.count * s_recordSize });
+			}
+			return objects.count;
+		}
+
+		uint32_t written = 0;
+		for (uint32_t i = 0; i < objects.dirtyCount; ++i) {
+			uint32_t index = objects.dirtyIndices[i];
+			if (index >= objects.count) {
+				continue;
+			}
+
+			records[written] = objects.transforms[index];
+			VkDeviceSize dstOffset = index * s_recordSize;
+
+			// Records are packed back to back in staging, so adjacent destinations merge into one region
+			if (!outRegions.empty() && outRegions.back().dstOffset + outRegions.back().size == dstOffset) {
+				outRegions.back().size += s_recordSize;
+			}
+			else {
+				outRegions.push_back({ sliceOffset + written * s_recordSize, dstOffset, s_recordSize });
+			}
+
+			++written;
+		}
+
+		return written;
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "engine/src/renderer/renderer_backend.h"
+
+namespace mz {
+	// Host side of the object buffer's delta upload. Packs the records of a frame back to back into its staging
+	// slice and builds the copy regions scattering them into place. Touches no Vulkan objects, so the packing can be
+	// measured without a device.
+	class VulkanObjectStaging {
+	public:
+		static constexpr VkDeviceSize s_recordSize = sizeof(glm::mat4);
+
+		// Writes every record when fullUpload is set and only the dirty ones otherwise. Returns the number of
+		// records written, outRegions is cleared first and adjacent destinations share one region.
+		static uint32_t StageRecords(const RendererObjectData& objects, bool fullUpload, uint8_t* staging, VkDeviceSize sliceOffset,
+			std::vector<VkBufferCopy>& outRegions);
+	};
+}
\ No newline at end of file
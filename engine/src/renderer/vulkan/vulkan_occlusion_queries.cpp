@@ -0,0 +1,274 @@
+#include "vulkan_occlusion_queries.h"
+#include "shaders/vulkan_shader_utils.h"
+#include "engine/src/system/file_reader.h"
+
+namespace mz {
+	bool VulkanOcclusionQueries::Create()
+	{
+		if (!CreatePipeline()) {
+			MZ_CORE_ERROR("Failed to create occlusion query pipeline!");
+			return false;
+		}
+
+		// Small to start with, BeginFrame grows them to what the frames ask for
+		for (FrameResources& frame : m_frames) {
+			if (!CreatePool(frame, 64)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void VulkanOcclusionQueries::Destroy()
+	{
+		for (FrameResources& frame : m_frames) {
+			DestroyPool(frame);
+		}
+
+		vkDestroyPipeline(s_contextPtr->device.logicalDevice, m_pipeline, s_contextPtr->allocator);
+		vkDestroyPipelineLayout(s_contextPtr->device.logicalDevice, m_pipelineLayout, s_contextPtr->allocator);
+	}
+
+	void VulkanOcclusionQueries::BeginFrame(VkCommandBuffer commandBuffer, RendererFrameStats& stats)
+	{
+		FrameResources& frame = m_frames[s_contextPtr->currentFrame];
+
+		// The frame's fence has signaled, so every query it recorded is available and nothing waits. Frames are
+		// read in submission order, newer results replace older ones.
+		uint32_t queryCount = static_cast<uint32_t>(frame.objects.size());
+		if (queryCount > 0) {
+			m_readback.resize(queryCount * 2);
+			VkResult result = vkGetQueryPoolResults(
+				s_contextPtr->device.logicalDevice,
+				frame.pool,
+				0, queryCount,
+				m_readback.size() * sizeof(uint32_t), m_readback.data(),
+				2 * sizeof(uint32_t),
+				VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+			if (result == VK_SUCCESS || result == VK_NOT_READY) {
+				for (uint32_t i = 0; i < queryCount; ++i) {
+					if (m_readback[i * 2 + 1] == 0) {
+						continue;
+					}
+
+					const QueriedObject& object = frame.objects[i];
+					if (object.objectIndex >= m_results.size()) {
+						m_results.resize(object.objectIndex + 1);
+					}
+
+					bool hidden = m_readback[i * 2] == 0;
+					m_results[object.objectIndex].hiddenKey = hidden ? object.key : 0;
+					m_results[object.objectIndex].frameNumber = frame.frameNumber;
+
+					++stats.queriedObjects;
+					stats.queryOccludedObjects += hidden ? 1 : 0;
+				}
+			}
+		}
+		frame.objects.clear();
+
+		// Nothing references the pool anymore, it can be replaced without waiting
+		if (frame.requiredCapacity > frame.capacity) {
+			uint32_t capacity = std::max(frame.requiredCapacity, frame.capacity * 2);
+			DestroyPool(frame);
+			if (!CreatePool(frame, capacity)) {
+				return;
+			}
+		}
+
+		vkCmdResetQueryPool(commandBuffer, frame.pool, 0, frame.capacity);
+	}
+
+	void VulkanOcclusionQueries::Draw(VkCommandBuffer commandBuffer, const RendererOcclusionQuery* queries, uint32_t count, const glm::mat4& viewProjection)
+	{
+		FrameResources& frame = m_frames[s_contextPtr->currentFrame];
+		frame.requiredCapacity = std::max(frame.requiredCapacity, count);
+		frame.frameNumber = s_contextPtr->submittedFrameCount;
+
+		uint32_t recorded = std::min(count, frame.capacity);
+		if (recorded == 0) {
+			return;
+		}
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
+		// The geometries' pipelines are no longer bound, the next render pass binds them again
+		s_contextPtr->graphicsRenderingPipeline.boundHandle = VK_NULL_HANDLE;
+
+		vkCmdBindDescriptorSets(
+			commandBuffer,
+			VK_PIPELINE_BIND_POINT_GRAPHICS,
+			m_pipelineLayout,
+			0,
+			1,
+			&s_contextPtr->objectBuffer.descriptorSet,
+			0,
+			nullptr);
+
+		vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
+			offsetof(BoxConstants, viewProjection), sizeof(glm::mat4), &viewProjection);
+
+		for (uint32_t i = 0; i < recorded; ++i) {
+			const RendererOcclusionQuery& query = queries[i];
+			std::array<glm::vec4, 2> bounds = { glm::vec4(query.boundsMin, 0.0f), glm::vec4(query.boundsMax, 0.0f) };
+			vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
+				offsetof(BoxConstants, boundsMin), sizeof(bounds), bounds.data());
+
+			// Any passing sample is enough, precise counts may cost more on some devices
+			vkCmdBeginQuery(commandBuffer, frame.pool, i, 0);
+			vkCmdDraw(commandBuffer, s_boxVertexCount, 1, 0, query.objectIndex);
+			vkCmdEndQuery(commandBuffer, frame.pool, i);
+
+			frame.objects.push_back(QueriedObject{ query.objectIndex, query.key });
+		}
+	}
+
+	bool VulkanOcclusionQueries::IsOccluded(uint32_t objectIndex, uint32_t key) const
+	{
+		if (key == 0 || objectIndex >= m_results.size()) {
+			return false;
+		}
+
+		// Only the most recently finished frame counts, an object it did not query may have come into view since
+		const ObjectResult& result = m_results[objectIndex];
+		return result.hiddenKey == key && result.frameNumber + MAX_FRAMES_IN_FLIGHT >= s_contextPtr->submittedFrameCount;
+	}
+
+	bool VulkanOcclusionQueries::CreatePipeline()
+	{
+		// Set 0 is the object buffer, laid out as in the vertex shaders
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(BoxConstants);
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &s_contextPtr->objectBuffer.descriptorSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		if (vkCreatePipelineLayout(s_contextPtr->device.logicalDevice, &pipelineLayoutInfo, s_contextPtr->allocator, &m_pipelineLayout) != VK_SUCCESS) {
+			return false;
+		}
+
+		auto vertShaderCode = EngineReadFile(s_boxShaderFileName);
+		VkShaderModule vertexShaderModule = CreateShaderModule(vertShaderCode, s_contextPtr->device.logicalDevice);
+
+		VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
+		vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+		vertShaderStageInfo.module = vertexShaderModule;
+		vertShaderStageInfo.pName = "main";
+
+		// The corners come from the vertex index
+		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+		VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+		inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+		// Set by the render pass, see VulkanRendererBackend::BeginRenderPass
+		VkPipelineViewportStateCreateInfo viewportState{};
+		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		viewportState.viewportCount = 1;
+		viewportState.scissorCount = 1;
+
+		// Either side of a face may be the one in view, the back faces also count from close up
+		VkPipelineRasterizationStateCreateInfo rasterizer{};
+		rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		rasterizer.depthClampEnable = VK_FALSE;
+		rasterizer.rasterizerDiscardEnable = VK_FALSE;
+		rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+		rasterizer.lineWidth = 1.0f;
+		rasterizer.cullMode = VK_CULL_MODE_NONE;
+		rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+		rasterizer.depthBiasEnable = VK_FALSE;
+
+		VkPipelineMultisampleStateCreateInfo multisampling{};
+		multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+		multisampling.minSampleShading = 1.0f;
+
+		// Tested against the frame's depth without changing it, surfaces lying on the box still count as visible
+		VkPipelineDepthStencilStateCreateInfo depthStencil{};
+		depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		depthStencil.depthTestEnable = VK_TRUE;
+		depthStencil.depthWriteEnable = VK_FALSE;
+		depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+		depthStencil.depthBoundsTestEnable = VK_FALSE;
+		depthStencil.stencilTestEnable = VK_FALSE;
+
+		VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+		colorBlendAttachment.colorWriteMask = 0;
+		colorBlendAttachment.blendEnable = VK_FALSE;
+
+		VkPipelineColorBlendStateCreateInfo colorBlending{};
+		colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		colorBlending.logicOpEnable = VK_FALSE;
+		colorBlending.attachmentCount = 1;
+		colorBlending.pAttachments = &colorBlendAttachment;
+
+		std::array<VkDynamicState, 2> dynamicStates = {
+			VK_DYNAMIC_STATE_VIEWPORT,
+			VK_DYNAMIC_STATE_SCISSOR
+		};
+
+		VkPipelineDynamicStateCreateInfo dynamicState{};
+		dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+		dynamicState.pDynamicStates = dynamicStates.data();
+
+		// No fragment stage, like the depth only pipelines
+		VkGraphicsPipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		pipelineInfo.stageCount = 1;
+		pipelineInfo.pStages = &vertShaderStageInfo;
+		pipelineInfo.pVertexInputState = &vertexInputInfo;
+		pipelineInfo.pInputAssemblyState = &inputAssembly;
+		pipelineInfo.pViewportState = &viewportState;
+		pipelineInfo.pRasterizationState = &rasterizer;
+		pipelineInfo.pMultisampleState = &multisampling;
+		pipelineInfo.pDepthStencilState = &depthStencil;
+		pipelineInfo.pColorBlendState = &colorBlending;
+		pipelineInfo.pDynamicState = &dynamicState;
+		pipelineInfo.layout = m_pipelineLayout;
+		pipelineInfo.renderPass = s_contextPtr->mainRenderPass.handle;
+		pipelineInfo.subpass = 0;
+		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+		VkResult result = vkCreateGraphicsPipelines(s_contextPtr->device.logicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, s_contextPtr->allocator, &m_pipeline);
+		vkDestroyShaderModule(s_contextPtr->device.logicalDevice, vertexShaderModule, s_contextPtr->allocator);
+
+		return result == VK_SUCCESS;
+	}
+
+	bool VulkanOcclusionQueries::CreatePool(FrameResources& frame, uint32_t capacity)
+	{
+		VkQueryPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		poolInfo.queryType = VK_QUERY_TYPE_OCCLUSION;
+		poolInfo.queryCount = capacity;
+
+		if (vkCreateQueryPool(s_contextPtr->device.logicalDevice, &poolInfo, s_contextPtr->allocator, &frame.pool) != VK_SUCCESS) {
+			MZ_CORE_ERROR("Failed to create occlusion query pool!");
+			frame.pool = VK_NULL_HANDLE;
+			frame.capacity = 0;
+			return false;
+		}
+
+		frame.capacity = capacity;
+		return true;
+	}
+
+	void VulkanOcclusionQueries::DestroyPool(FrameResources& frame)
+	{
+		vkDestroyQueryPool(s_contextPtr->device.logicalDevice, frame.pool, s_contextPtr->allocator);
+		frame.pool = VK_NULL_HANDLE;
+		frame.capacity = 0;
+	}
+}
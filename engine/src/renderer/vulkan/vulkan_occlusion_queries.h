@@ -0,0 +1,74 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "engine/src/renderer/renderer_backend.h"
+#include "vulkan_context.h"
+
+namespace mz {
+	// Hardware occlusion queries guarding expensive objects. Every query draws the object's bounding box against the
+	// depth drawn so far, writing nothing, and counts the samples that pass. Each frame in flight has its own query
+	// pool, read with vkGetQueryPoolResults once the frame's fence has signaled, so the results never stall the CPU
+	// or the GPU. They describe the frame that most recently finished on the GPU.
+	class VulkanOcclusionQueries {
+	public:
+		bool Create();
+		void Destroy();
+
+		// Reads the results of the current frame's previous submission, grows its pool if that ran out and resets
+		// it. Once the command buffer has begun, outside of a render pass.
+		void BeginFrame(VkCommandBuffer commandBuffer, RendererFrameStats& stats);
+		// Inside the main render pass, after its last draw. Queries past the pool's capacity are left out this
+		// frame, their objects count as visible until the grown pool covers them.
+		void Draw(VkCommandBuffer commandBuffer, const RendererOcclusionQuery* queries, uint32_t count, const glm::mat4& viewProjection);
+		// See RendererBackend::IsObjectOccluded
+		bool IsOccluded(uint32_t objectIndex, uint32_t key) const;
+
+		inline static void SetContextPointer(std::shared_ptr<VulkanContext> contextPtr) { s_contextPtr = contextPtr; }
+	private:
+		inline static std::shared_ptr<VulkanContext> s_contextPtr = nullptr;
+		inline static const std::string s_boxShaderFileName = "assets/shaders/engine-occlusion-box.vert.spv";
+
+		// Vertices of the box, see engine-occlusion-box.vert
+		static constexpr uint32_t s_boxVertexCount = 36;
+
+		// Push constants of engine-occlusion-box.vert, the matrix is pushed once per frame and the bounds per query
+		struct BoxConstants {
+			glm::mat4 viewProjection;
+			glm::vec4 boundsMin;
+			glm::vec4 boundsMax;
+		};
+
+		struct QueriedObject {
+			uint32_t objectIndex;
+			uint32_t key;
+		};
+
+		struct FrameResources {
+			VkQueryPool pool = VK_NULL_HANDLE;
+			uint32_t capacity = 0;
+			// Most queries a frame asked for, the pool grows to it once the frame's submission has finished
+			uint32_t requiredCapacity = 0;
+			// Object and key per query of the frame's last submission, and the frame number it was recorded as
+			std::vector<QueriedObject> objects;
+			uint64_t frameNumber = 0;
+		};
+
+		// Latest result per object: the key of a query that found it hidden or zero, and the frame it was made in
+		struct ObjectResult {
+			uint32_t hiddenKey = 0;
+			uint64_t frameNumber = 0;
+		};
+
+		std::array<FrameResources, MAX_FRAMES_IN_FLIGHT> m_frames;
+		std::vector<ObjectResult> m_results;
+		// Sample count and availability per query, filled by vkGetQueryPoolResults
+		std::vector<uint32_t> m_readback;
+
+		VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+		VkPipeline m_pipeline = VK_NULL_HANDLE;
+
+		bool CreatePipeline();
+		bool CreatePool(FrameResources& frame, uint32_t capacity);
+		void DestroyPool(FrameResources& frame);
+	};
+}
\ No newline at end of file
@@ -9,17 +9,9 @@ namespace mz {
 
 		/* Programmable part begin */
 		
-		auto vertShaderCode = EngineReadFile(s_engineMaterialShaderVertexFileName);
+		// The vertex shader depends on the vertex format and is created per pipeline below
 		auto fragShaderCode = EngineReadFile(s_engineMaterialShaderFragmentFileName);
 
-		// Vertex shader
-		auto vertexShadingModule = CreateShaderModule(vertShaderCode, s_contextPtr->device.logicalDevice);
-		VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-		vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-		vertShaderStageInfo.module = vertexShadingModule;
-		vertShaderStageInfo.pName = "main";
-
 		// Fragment shader
 		auto fragmentShaderModule = CreateShaderModule(fragShaderCode, s_contextPtr->device.logicalDevice);
 		VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
@@ -28,24 +20,10 @@ namespace mz {
 		fragShaderStageInfo.module = fragmentShaderModule;
 		fragShaderStageInfo.pName = "main";
 
-		// Shader stages
-		VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
-		
 		/* Programmable part end*/
 
 		/* Fixed function stages begin */
 
-		auto bindingDescription = VulkanPipeline::Vertex3dGetBindingDescription();
-		auto attributeDescriptions = VulkanPipeline::Vertex3dGetAttributeDescriptions();
-		
-		// Vertex input info
-		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		vertexInputInfo.vertexBindingDescriptionCount = 1;
-		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-		vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-		vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
 		// Input assembly
 		VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
 		inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -99,7 +77,7 @@ namespace mz {
 		multisampling.alphaToCoverageEnable = VK_FALSE;
 		multisampling.alphaToOneEnable = VK_FALSE;
 
-		// Depth & stencil
+		// Depth & stencil, the depth tested color pipelines override write and compare below
 		VkPipelineDepthStencilStateCreateInfo depthStencil{};
 		depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 		depthStencil.depthTestEnable = VK_TRUE;
@@ -124,6 +102,8 @@ namespace mz {
 		colorBlending.blendConstants[2] = 0.0f;
 		colorBlending.blendConstants[3] = 0.0f;
 
+		// Depth write and compare are baked into separate pipelines instead, making them dynamic needs Vulkan 1.3 or
+		// VK_EXT_extended_dynamic_state
 		std::vector<VkDynamicState> dynamicStates = {
 			VK_DYNAMIC_STATE_VIEWPORT,
 			VK_DYNAMIC_STATE_SCISSOR
@@ -137,46 +117,111 @@ namespace mz {
 
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutInfo.setLayoutCount = 1;
-		pipelineLayoutInfo.pSetLayouts = &s_contextPtr->graphicsRenderingPipeline.descriptorSetLayout;
-
-		// Push contants
-		VkPushConstantRange pushConstants;
-		pushConstants.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-		pushConstants.offset = sizeof(glm::mat4) * 0;
-		pushConstants.size = sizeof(glm::mat4) * 2;
+		// Set 0: global and material data, set 1: object buffer
+		std::array<VkDescriptorSetLayout, 2> setLayouts = {
+			s_contextPtr->graphicsRenderingPipeline.descriptorSetLayout,
+			s_contextPtr->objectBuffer.descriptorSetLayout
+		};
+		pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+		pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+
+		// Dequantization of packed positions, pushed by every geometry stored in the packed format
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(VertexDequantization);
 		pipelineLayoutInfo.pushConstantRangeCount = 1;
-		pipelineLayoutInfo.pPushConstantRanges = &pushConstants;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
 		if (vkCreatePipelineLayout(s_contextPtr->device.logicalDevice, &pipelineLayoutInfo, s_contextPtr->allocator, &s_contextPtr->graphicsRenderingPipeline.layout) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create pipeline layout!");
 		}
 
-		VkGraphicsPipelineCreateInfo pipelineInfo{};
-		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		pipelineInfo.stageCount = 2;
-		pipelineInfo.pStages = shaderStages;
-		pipelineInfo.pVertexInputState = &vertexInputInfo;
-		pipelineInfo.pInputAssemblyState = &inputAssembly;
-		pipelineInfo.pViewportState = &viewportState;
-		pipelineInfo.pRasterizationState = &rasterizer;
-		pipelineInfo.pMultisampleState = &multisampling;
-		pipelineInfo.pColorBlendState = &colorBlending;
-		pipelineInfo.pDynamicState = &dynamicState;
-		pipelineInfo.layout = s_contextPtr->graphicsRenderingPipeline.layout;
-		pipelineInfo.renderPass = renderPass;
-		pipelineInfo.subpass = 0;
-		pipelineInfo.pDepthStencilState = &depthStencil;
-		pipelineInfo.pTessellationState = nullptr;
-		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-
-		if (vkCreateGraphicsPipelines(s_contextPtr->device.logicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, s_contextPtr->allocator, &s_contextPtr->graphicsRenderingPipeline.handle) != VK_SUCCESS) {
-			MZ_CORE_ERROR("Failed to create graphics pipeline!");
-			return false;
+		// Depth only pipelines write no color and have no fragment stage
+		VkPipelineColorBlendAttachmentState depthOnlyBlendAttachment = colorBlendAttachment;
+		depthOnlyBlendAttachment.colorWriteMask = 0;
+		VkPipelineColorBlendStateCreateInfo depthOnlyColorBlending = colorBlending;
+		depthOnlyColorBlending.pAttachments = &depthOnlyBlendAttachment;
+
+		// After a depth prepass the depth buffer is final, only the surfaces that won it are shaded
+		VkPipelineDepthStencilStateCreateInfo depthTestedDepthStencil = depthStencil;
+		depthTestedDepthStencil.depthWriteEnable = VK_FALSE;
+		depthTestedDepthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+
+		// Every vertex format gets a color, a depth tested color and a depth only pipeline, they differ in the vertex
+		// shader, the vertex input and the depth state. Color pipelines read both vertex streams, depth only pipelines
+		// the position stream alone.
+		enum class PipelineKind { Color, DepthTested, DepthOnly };
+
+		bool created = true;
+		for (uint32_t format = 0; format < s_vertexFormatCount && created; ++format) {
+			bool packed = static_cast<VertexFormat>(format) == VertexFormat::Packed;
+
+			auto bindingDescriptions = packed ? VulkanPipeline::PackedVertex3dGetBindingDescriptions() : VulkanPipeline::Vertex3dGetBindingDescriptions();
+			auto attributeDescriptions = packed ? VulkanPipeline::PackedVertex3dGetAttributeDescriptions() : VulkanPipeline::Vertex3dGetAttributeDescriptions();
+
+			for (PipelineKind kind : { PipelineKind::Color, PipelineKind::DepthTested, PipelineKind::DepthOnly }) {
+				bool depthOnly = kind == PipelineKind::DepthOnly;
+				const std::string& vertexShaderFileName = depthOnly
+					? (packed ? s_depthPrepassShaderPackedVertexFileName : s_depthPrepassShaderVertexFileName)
+					: (packed ? s_engineMaterialShaderPackedVertexFileName : s_engineMaterialShaderVertexFileName);
+				auto vertShaderCode = EngineReadFile(vertexShaderFileName);
+
+				// Vertex shader
+				auto vertexShadingModule = CreateShaderModule(vertShaderCode, s_contextPtr->device.logicalDevice);
+				VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
+				vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+				vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+				vertShaderStageInfo.module = vertexShadingModule;
+				vertShaderStageInfo.pName = "main";
+
+				// Shader stages
+				VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
+
+				// Vertex input info, the position is binding 0 and location 0
+				VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+				vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+				vertexInputInfo.vertexBindingDescriptionCount = depthOnly ? 1 : static_cast<uint32_t>(bindingDescriptions.size());
+				vertexInputInfo.vertexAttributeDescriptionCount = depthOnly ? 1 : static_cast<uint32_t>(attributeDescriptions.size());
+				vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
+				vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+				VkGraphicsPipelineCreateInfo pipelineInfo{};
+				pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+				pipelineInfo.stageCount = depthOnly ? 1 : 2;
+				pipelineInfo.pStages = shaderStages;
+				pipelineInfo.pVertexInputState = &vertexInputInfo;
+				pipelineInfo.pInputAssemblyState = &inputAssembly;
+				pipelineInfo.pViewportState = &viewportState;
+				pipelineInfo.pRasterizationState = &rasterizer;
+				pipelineInfo.pMultisampleState = &multisampling;
+				pipelineInfo.pColorBlendState = depthOnly ? &depthOnlyColorBlending : &colorBlending;
+				pipelineInfo.pDynamicState = &dynamicState;
+				pipelineInfo.layout = s_contextPtr->graphicsRenderingPipeline.layout;
+				pipelineInfo.renderPass = renderPass;
+				pipelineInfo.subpass = 0;
+				pipelineInfo.pDepthStencilState = kind == PipelineKind::DepthTested ? &depthTestedDepthStencil : &depthStencil;
+				pipelineInfo.pTessellationState = nullptr;
+				pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+				VulkanPipelineInfo& pipeline = s_contextPtr->graphicsRenderingPipeline;
+				VkPipeline& handle = depthOnly ? pipeline.depthHandles[format]
+					: (kind == PipelineKind::DepthTested ? pipeline.depthTestedHandles[format] : pipeline.handles[format]);
+				if (vkCreateGraphicsPipelines(s_contextPtr->device.logicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, s_contextPtr->allocator, &handle) != VK_SUCCESS) {
+					MZ_CORE_ERROR("Failed to create {0} pipeline for vertex format {1}!",
+						depthOnly ? "depth only" : (kind == PipelineKind::DepthTested ? "depth tested graphics" : "graphics"), format);
+					created = false;
+				}
+
+				vkDestroyShaderModule(s_contextPtr->device.logicalDevice, vertexShadingModule, s_contextPtr->allocator);
+			}
 		}
 
 		vkDestroyShaderModule(s_contextPtr->device.logicalDevice, fragmentShaderModule, s_contextPtr->allocator);
-		vkDestroyShaderModule(s_contextPtr->device.logicalDevice, vertexShadingModule, s_contextPtr->allocator);
+
+		if (!created) {
+			return false;
+		}
 
 		MZ_CORE_INFO("Vulkan graphics rendering pipeline created!");
 
@@ -187,12 +232,31 @@ namespace mz {
 	{
 		MZ_CORE_TRACE("Destroying Vulkan graphics pipeline...");
 		vkDestroyPipelineLayout(s_contextPtr->device.logicalDevice, s_contextPtr->graphicsRenderingPipeline.layout, s_contextPtr->allocator);
-		vkDestroyPipeline(s_contextPtr->device.logicalDevice, s_contextPtr->graphicsRenderingPipeline.handle, s_contextPtr->allocator);
+		for (VkPipeline pipeline : s_contextPtr->graphicsRenderingPipeline.handles) {
+			vkDestroyPipeline(s_contextPtr->device.logicalDevice, pipeline, s_contextPtr->allocator);
+		}
+		for (VkPipeline pipeline : s_contextPtr->graphicsRenderingPipeline.depthTestedHandles) {
+			vkDestroyPipeline(s_contextPtr->device.logicalDevice, pipeline, s_contextPtr->allocator);
+		}
+		for (VkPipeline pipeline : s_contextPtr->graphicsRenderingPipeline.depthHandles) {
+			vkDestroyPipeline(s_contextPtr->device.logicalDevice, pipeline, s_contextPtr->allocator);
+		}
 	}
 	
-	void VulkanPipeline::Bind(VkCommandBuffer commandBuffer)
+	void VulkanPipeline::Bind(VkCommandBuffer commandBuffer, bool depthTested)
 	{
-		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, s_contextPtr->graphicsRenderingPipeline.handle);
+		// Starts on the float pipeline, geometries in other formats switch on demand
+		VulkanPipelineInfo& pipeline = s_contextPtr->graphicsRenderingPipeline;
+		pipeline.depthTested = depthTested;
+		pipeline.boundHandle = (depthTested ? pipeline.depthTestedHandles : pipeline.handles)[static_cast<uint32_t>(VertexFormat::Float)];
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.boundHandle);
+	}
+
+	void VulkanPipeline::BindDepthPrepass(VkCommandBuffer commandBuffer)
+	{
+		VulkanPipelineInfo& pipeline = s_contextPtr->graphicsRenderingPipeline;
+		pipeline.boundHandle = pipeline.depthHandles[static_cast<uint32_t>(VertexFormat::Float)];
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.boundHandle);
 	}
 	
 	VkVertexInputBindingDescription VulkanPipeline::Vertex2dGetBindingDescription()
@@ -222,40 +286,86 @@ namespace mz {
 	}
 	
 	
-	VkVertexInputBindingDescription VulkanPipeline::Vertex3dGetBindingDescription()
+	std::array<VkVertexInputBindingDescription, 2> VulkanPipeline::Vertex3dGetBindingDescriptions()
 	{
-		VkVertexInputBindingDescription bindingDescription{};
-		bindingDescription.binding = 0;
-		bindingDescription.stride = sizeof(Vertex3d);
-		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-		return bindingDescription;
+		return GetStreamBindingDescriptions(VertexFormat::Float);
 	}
 
 	std::array<VkVertexInputAttributeDescription, 4> VulkanPipeline::Vertex3dGetAttributeDescriptions()
 	{
+		// Attribute offsets are relative to the stream, the position stream only holds the position
+		uint32_t positionStride = GetPositionStride(VertexFormat::Float);
 		std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions{};
 
 		attributeDescriptions[0].binding = 0;
 		attributeDescriptions[0].location = 0;
 		attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-		attributeDescriptions[0].offset = offsetof(Vertex3d, pos);
+		attributeDescriptions[0].offset = 0;
 
-		attributeDescriptions[1].binding = 0;
+		attributeDescriptions[1].binding = 1;
 		attributeDescriptions[1].location = 1;
 		attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-		attributeDescriptions[1].offset = offsetof(Vertex3d, color);
+		attributeDescriptions[1].offset = offsetof(Vertex3d, color) - positionStride;
 
-		attributeDescriptions[2].binding = 0;
+		attributeDescriptions[2].binding = 1;
 		attributeDescriptions[2].location = 2;
 		attributeDescriptions[2].format = VK_FORMAT_R32G32B32_SFLOAT;
-		attributeDescriptions[2].offset = offsetof(Vertex3d, normal);
+		attributeDescriptions[2].offset = offsetof(Vertex3d, normal) - positionStride;
 
-		attributeDescriptions[3].binding = 0;
+		attributeDescriptions[3].binding = 1;
 		attributeDescriptions[3].location = 3;
 		attributeDescriptions[3].format = VK_FORMAT_R32G32_SFLOAT;
-		attributeDescriptions[3].offset = offsetof(Vertex3d, texCoord);
+		attributeDescriptions[3].offset = offsetof(Vertex3d, texCoord) - positionStride;
 
 		return attributeDescriptions;
 	}
+
+	std::array<VkVertexInputBindingDescription, 2> VulkanPipeline::PackedVertex3dGetBindingDescriptions()
+	{
+		return GetStreamBindingDescriptions(VertexFormat::Packed);
+	}
+
+	std::array<VkVertexInputAttributeDescription, 4> VulkanPipeline::PackedVertex3dGetAttributeDescriptions()
+	{
+		// Same locations as Vertex3d, the normalized formats are expanded to floats by the input assembler
+		uint32_t positionStride = GetPositionStride(VertexFormat::Packed);
+		std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions{};
+
+		attributeDescriptions[0].binding = 0;
+		attributeDescriptions[0].location = 0;
+		attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+		attributeDescriptions[0].offset = 0;
+
+		attributeDescriptions[1].binding = 1;
+		attributeDescriptions[1].location = 1;
+		attributeDescriptions[1].format = VK_FORMAT_R8G8B8A8_UNORM;
+		attributeDescriptions[1].offset = offsetof(PackedVertex3d, color) - positionStride;
+
+		attributeDescriptions[2].binding = 1;
+		attributeDescriptions[2].location = 2;
+		attributeDescriptions[2].format = VK_FORMAT_R16G16_SNORM;
+		attributeDescriptions[2].offset = offsetof(PackedVertex3d, normal) - positionStride;
+
+		attributeDescriptions[3].binding = 1;
+		attributeDescriptions[3].location = 3;
+		attributeDescriptions[3].format = VK_FORMAT_R16G16_SFLOAT;
+		attributeDescriptions[3].offset = offsetof(PackedVertex3d, texCoord) - positionStride;
+
+		return attributeDescriptions;
+	}
+
+	std::array<VkVertexInputBindingDescription, 2> VulkanPipeline::GetStreamBindingDescriptions(VertexFormat format)
+	{
+		std::array<VkVertexInputBindingDescription, 2> bindingDescriptions{};
+
+		bindingDescriptions[0].binding = 0;
+		bindingDescriptions[0].stride = GetPositionStride(format);
+		bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+		bindingDescriptions[1].binding = 1;
+		bindingDescriptions[1].stride = GetVertexStride(format) - GetPositionStride(format);
+		bindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+		return bindingDescriptions;
+	}
 }
\ No newline at end of file
@@ -9,13 +9,19 @@ namespace mz {
 	public:
 		bool Create(VkRenderPass renderPass);
 		void Destroy();
-		void Bind(VkCommandBuffer commandBuffer);
+		// Binds the float color pipeline, depthTested when a depth prepass has already filled the depth buffer
+		void Bind(VkCommandBuffer commandBuffer, bool depthTested);
+		void BindDepthPrepass(VkCommandBuffer commandBuffer);
 		
 		static VkVertexInputBindingDescription Vertex2dGetBindingDescription();
 		static std::array<VkVertexInputAttributeDescription, 2> Vertex2dGetAttributeDescriptions();
 
-		static 	VkVertexInputBindingDescription VulkanPipeline::Vertex3dGetBindingDescription();
+		// Binding 0 is the position stream, binding 1 the remaining attributes
+		static std::array<VkVertexInputBindingDescription, 2> Vertex3dGetBindingDescriptions();
 		static std::array<VkVertexInputAttributeDescription, 4> Vertex3dGetAttributeDescriptions();
+
+		static std::array<VkVertexInputBindingDescription, 2> PackedVertex3dGetBindingDescriptions();
+		static std::array<VkVertexInputAttributeDescription, 4> PackedVertex3dGetAttributeDescriptions();
 	
 		inline static void SetContextPointer(std::shared_ptr<VulkanContext> contextPtr) { s_contextPtr = contextPtr; }
 	private:
@@ -23,5 +29,10 @@ namespace mz {
 
 		inline static const std::string s_engineMaterialShaderFragmentFileName = "assets/shaders/engine-material-shader.frag.spv";
 		inline static const std::string s_engineMaterialShaderVertexFileName = "assets/shaders/engine-material-shader.vert.spv";
+		inline static const std::string s_engineMaterialShaderPackedVertexFileName = "assets/shaders/engine-material-shader-packed.vert.spv";
+		inline static const std::string s_depthPrepassShaderVertexFileName = "assets/shaders/engine-depth-prepass.vert.spv";
+		inline static const std::string s_depthPrepassShaderPackedVertexFileName = "assets/shaders/engine-depth-prepass-packed.vert.spv";
+
+		static std::array<VkVertexInputBindingDescription, 2> GetStreamBindingDescriptions(VertexFormat format);
 	};
 }
\ No newline at end of file
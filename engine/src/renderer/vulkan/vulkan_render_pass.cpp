@@ -19,7 +19,8 @@ namespace mz {
         depthAttachment.format = s_contextPtr->device.depthFormat;
         depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
         depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        // Kept for the depth pyramid and for resuming the pass
+        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
         depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -65,11 +66,31 @@ namespace mz {
 			return false;
 		}
 
+        // Same attachments and subpass, so it stays compatible with the framebuffers and pipelines, but it loads
+        // what the first pass stored
+        attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+        attachments[0].initialLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+        attachments[1].initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+            | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+		if (vkCreateRenderPass(s_contextPtr->device.logicalDevice, &renderPassInfo, s_contextPtr->allocator, &s_contextPtr->mainRenderPass.resumeHandle) != VK_SUCCESS) {
+			MZ_CORE_ERROR("Failed to create resume render pass");
+			return false;
+		}
+
 		MZ_CORE_INFO("Render pass created!");
+		return true;
 	}
 	void VulkanRenderPass::Destroy()
 	{
 		MZ_CORE_TRACE("Destroying render pass...");
+		vkDestroyRenderPass(s_contextPtr->device.logicalDevice, s_contextPtr->mainRenderPass.resumeHandle, s_contextPtr->allocator);
 		vkDestroyRenderPass(s_contextPtr->device.logicalDevice, s_contextPtr->mainRenderPass.handle, s_contextPtr->allocator);
 	}
     
@@ -91,6 +112,19 @@ namespace mz {
 
         vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
     }
+
+    void VulkanRenderPass::Resume(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+    {
+        VkRenderPassBeginInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = s_contextPtr->mainRenderPass.resumeHandle;
+        renderPassInfo.framebuffer = s_contextPtr->swapChain.framebuffers[imageIndex];
+
+        renderPassInfo.renderArea.offset = { 0, 0 };
+        renderPassInfo.renderArea.extent = s_contextPtr->swapChain.extent;
+
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    }
     
     void VulkanRenderPass::End(VkCommandBuffer commandBuffer, uint32_t imageIndex)
     {
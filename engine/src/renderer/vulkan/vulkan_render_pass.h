@@ -10,6 +10,8 @@ namespace mz {
 		bool Create();
 		void Destroy();
 		void Begin(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+		// Begins the pass again after End() without clearing, the frame continues on what was drawn
+		void Resume(VkCommandBuffer commandBuffer, uint32_t imageIndex);
 		void End(VkCommandBuffer commandBuffer, uint32_t imageIndex);
 
 		inline static void SetContextPointer(std::shared_ptr<VulkanContext> contextPtr) { s_contextPtr = contextPtr; }
@@ -17,6 +17,10 @@ namespace mz {
 		VulkanPipeline::SetContextPointer(contextPtr);
 		VulkanRenderPass::SetContextPointer(contextPtr);
 		VulkanGeometry::SetContextPointer(contextPtr);
+		VulkanObjectBuffer::SetContextPointer(contextPtr);
+		VulkanMeshletCuller::SetContextPointer(contextPtr);
+		VulkanDepthPyramid::SetContextPointer(contextPtr);
+		VulkanOcclusionQueries::SetContextPointer(contextPtr);
 	}
 
 	bool VulkanRendererBackend::Initialize()
@@ -144,12 +148,48 @@ namespace mz {
 			return false;
 		}
 
+		// Object buffer, its descriptor set layout is part of the pipeline layout
+		m_objectBuffer = std::make_unique<VulkanObjectBuffer>();
+		if (!m_objectBuffer->Create(s_initialObjectCapacity)) {
+			MZ_CORE_CRITICAL("Failed to create object buffer!");
+			return false;
+		}
+
+		// Meshlet culling reads the object buffer and the depth pyramid, optional
+		if (contextPtr->device.meshletCulling) {
+			m_depthPyramid = std::make_unique<VulkanDepthPyramid>();
+			if (!m_depthPyramid->Create()) {
+				MZ_CORE_CRITICAL("Failed to create depth pyramid!");
+				return false;
+			}
+
+			if (!contextPtr->device.depthSampling) {
+				MZ_CORE_WARN("Depth format cannot be sampled, meshes are drawn without occlusion culling");
+			}
+
+			m_meshletCuller = std::make_unique<VulkanMeshletCuller>();
+			if (!m_meshletCuller->Create()) {
+				MZ_CORE_CRITICAL("Failed to create meshlet culler!");
+				return false;
+			}
+		}
+		else {
+			MZ_CORE_WARN("Device lacks indirect count draws or buffer device addresses, meshes are drawn without meshlet culling");
+		}
+
 		// Pipeline creation
 		if (!m_pipeline->Create(contextPtr->mainRenderPass.handle)) {
 			MZ_CORE_CRITICAL("Failed to create Vulkan graphics pipeline!");
 			return false;
 		}
 
+		// Occlusion queries draw in the main render pass and read the object buffer
+		m_occlusionQueries = std::make_unique<VulkanOcclusionQueries>();
+		if (!m_occlusionQueries->Create()) {
+			MZ_CORE_CRITICAL("Failed to create occlusion queries!");
+			return false;
+		}
+
 		// Framebuffers
 		if (!m_swapChain->CreateFramebuffers()) {
 			return false;
@@ -209,6 +249,23 @@ namespace mz {
 
 		vkDestroySampler(contextPtr->device.logicalDevice, contextPtr->textureSampler, contextPtr->allocator);
 
+		// Images and buffers the texture and geometry systems deleted during their shutdown, the geometries' descriptor
+		// sets go back to the pool destroyed below
+		VulkanTexture::DestroyRetiredImages(true);
+		VulkanGeometry::DestroyRetiredResources(true);
+
+		// Meshlet culler, its pipeline layout references the object buffer's set layout
+		if (m_meshletCuller) {
+			m_meshletCuller->Destroy();
+			m_depthPyramid->Destroy();
+		}
+
+		// Occlusion queries, their pipeline layout references the object buffer's set layout as well
+		m_occlusionQueries->Destroy();
+
+		// Object buffer
+		m_objectBuffer->Destroy();
+
 		// Command pool
 		m_device->DestroyGraphicsCommandPool();
 		
@@ -263,10 +320,18 @@ namespace mz {
 
 		vkWaitForFences(contextPtr->device.logicalDevice, 1, &inFlightFence, VK_TRUE, UINT64_MAX);
 
+		// The fence belongs to the frame submitted MAX_FRAMES_IN_FLIGHT frames ago, the queue finishes in order
+		if (contextPtr->submittedFrameCount >= MAX_FRAMES_IN_FLIGHT) {
+			contextPtr->completedFrameCount = contextPtr->submittedFrameCount - MAX_FRAMES_IN_FLIGHT + 1;
+		}
+
+		VulkanTexture::DestroyRetiredImages(false);
+		VulkanGeometry::DestroyRetiredResources(false);
+
 		VkResult result = m_swapChain->AcquireNextImageIndex();
 
 		if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-			m_swapChain->Recreate();
+			RecreateSwapChain();
 			return false;
 		}
 		else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
@@ -276,8 +341,6 @@ namespace mz {
 
 		vkResetFences(contextPtr->device.logicalDevice, 1, &inFlightFence);
 
-		uint32_t imageIndex = contextPtr->swapChain.nextImageIndex;
-
 		vkResetCommandBuffer(commandBuffer, 0);
 
 		VkCommandBufferBeginInfo beginInfo{};
@@ -285,6 +348,66 @@ namespace mz {
 
 		VK_CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo));
 
+		m_frameStats = {};
+
+		if (m_meshletCuller) {
+			m_meshletCuller->BeginFrame(m_frameStats);
+		}
+
+		m_occlusionQueries->BeginFrame(commandBuffer, m_frameStats);
+
+		return true;
+	}
+
+	bool VulkanRendererBackend::UploadObjects(const RendererObjectData& objects)
+	{
+		VkCommandBuffer commandBuffer = contextPtr->commandBuffers[contextPtr->currentFrame];
+		return m_objectBuffer->Upload(commandBuffer, objects, m_frameStats);
+	}
+
+	bool VulkanRendererBackend::BeginCulling(const RendererCullingState& state)
+	{
+		if (!m_meshletCuller) {
+			return false;
+		}
+
+		return m_meshletCuller->Begin(contextPtr->commandBuffers[contextPtr->currentFrame], state);
+	}
+
+	void VulkanRendererBackend::EndCulling()
+	{
+		m_meshletCuller->End(contextPtr->commandBuffers[contextPtr->currentFrame]);
+	}
+
+	void VulkanRendererBackend::BeginMainRenderPass(bool depthPrepass)
+	{
+		BeginRenderPass(false, depthPrepass);
+	}
+
+	bool VulkanRendererBackend::BeginLateCulling()
+	{
+		if (!m_meshletCuller || !contextPtr->meshletCulling.occlusion) {
+			return false;
+		}
+
+		// The pyramid is built in a compute pass, outside of the render pass
+		VkCommandBuffer commandBuffer = contextPtr->commandBuffers[contextPtr->currentFrame];
+		m_mainRenderPass->End(commandBuffer, contextPtr->swapChain.nextImageIndex);
+		m_depthPyramid->Build(commandBuffer);
+
+		return m_meshletCuller->BeginLate(commandBuffer);
+	}
+
+	void VulkanRendererBackend::ResumeMainRenderPass(bool depthPrepass)
+	{
+		BeginRenderPass(true, depthPrepass);
+	}
+
+	void VulkanRendererBackend::BeginRenderPass(bool resume, bool depthPrepass)
+	{
+		VkCommandBuffer commandBuffer = contextPtr->commandBuffers[contextPtr->currentFrame];
+		uint32_t imageIndex = contextPtr->swapChain.nextImageIndex;
+
 		VkViewport viewport{};
 		viewport.x = 0.0f;
 		viewport.y = 0.0f;
@@ -299,11 +422,38 @@ namespace mz {
 		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-		m_mainRenderPass->Begin(commandBuffer, imageIndex);
+		if (resume) {
+			m_mainRenderPass->Resume(commandBuffer, imageIndex);
+		}
+		else {
+			m_mainRenderPass->Begin(commandBuffer, imageIndex);
+		}
+
+		if (depthPrepass) {
+			m_pipeline->BindDepthPrepass(commandBuffer);
+		}
+		else {
+			m_pipeline->Bind(commandBuffer, false);
+		}
 
-		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, contextPtr->graphicsRenderingPipeline.handle);
+		// Set 1 stays bound while geometries rebind set 0
+		m_objectBuffer->Bind(commandBuffer);
+	}
 
-		return true;
+	void VulkanRendererBackend::EndDepthPrepass()
+	{
+		// Same render pass and subpass, only the pipelines and the depth state change
+		m_pipeline->Bind(contextPtr->commandBuffers[contextPtr->currentFrame], true);
+	}
+
+	void VulkanRendererBackend::DrawOcclusionQueries(const RendererOcclusionQuery* queries, uint32_t count, const glm::mat4& viewProjection)
+	{
+		m_occlusionQueries->Draw(contextPtr->commandBuffers[contextPtr->currentFrame], queries, count, viewProjection);
+	}
+
+	bool VulkanRendererBackend::IsObjectOccluded(uint32_t objectIndex, uint32_t key) const
+	{
+		return m_occlusionQueries->IsOccluded(objectIndex, key);
 	}
 
 	bool VulkanRendererBackend::EndFrame()
@@ -316,6 +466,16 @@ namespace mz {
 		
 		m_mainRenderPass->End(commandBuffer, imageIndex);
 
+		if (m_meshletCuller) {
+			// The next frame's early phase tests against the complete depth of this one
+			if (contextPtr->meshletCulling.occlusion) {
+				m_depthPyramid->Build(commandBuffer);
+				m_meshletCuller->OnDepthPyramidBuilt();
+			}
+
+			m_meshletCuller->RecordReadback(commandBuffer);
+		}
+
 		VK_CHECK(vkEndCommandBuffer(commandBuffer));
 
 		VkSubmitInfo submitInfo{};
@@ -335,6 +495,7 @@ namespace mz {
 		submitInfo.pSignalSemaphores = signalSemaphores;
 
 		VK_CHECK(vkQueueSubmit(contextPtr->device.graphicsQueue, 1, &submitInfo, inFlightFence));
+		++contextPtr->submittedFrameCount;
 
 		VkSubpassDependency dependency{};
 		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
@@ -358,7 +519,7 @@ namespace mz {
 
 		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || contextPtr->framebufferResized) {
 			contextPtr->framebufferResized = false;
-			m_swapChain->Recreate();
+			RecreateSwapChain();
 		}
 		else if (result != VK_SUCCESS) {
 			MZ_CORE_ERROR("Failed to present swap chain image!");
@@ -369,6 +530,16 @@ namespace mz {
 		return true;
 	}
 
+	bool VulkanRendererBackend::RecreateSwapChain()
+	{
+		if (!m_swapChain->Recreate()) {
+			return false;
+		}
+
+		// The swap chain waited for the GPU, the pyramid can follow the new extent right away
+		return !m_depthPyramid || m_depthPyramid->Resize();
+	}
+
 	void VulkanRendererBackend::OnResize()
 	{
 		if (Application::Get().GetWindow().GetFramebufferWidth() == 0 || Application::Get().GetWindow().GetFramebufferHeight() == 0) {
@@ -448,17 +619,21 @@ namespace mz {
 
 	bool VulkanRendererBackend::CreateDescriptorPool()
 	{
+		// Every geometry allocates one set per frame in flight and frees them when it is destroyed
+		uint32_t setCount = s_maxGeometryCount * MAX_FRAMES_IN_FLIGHT;
+
 		std::array<VkDescriptorPoolSize, 2> poolSizes{};
 		poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+		poolSizes[0].descriptorCount = setCount;
 		poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+		poolSizes[1].descriptorCount = setCount;
 
 		VkDescriptorPoolCreateInfo poolInfo{};
 		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
 		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
 		poolInfo.pPoolSizes = poolSizes.data();
-		poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+		poolInfo.maxSets = setCount;
 
 		if (vkCreateDescriptorPool(contextPtr->device.logicalDevice, &poolInfo, contextPtr->allocator, &contextPtr->graphicsRenderingPipeline.descriptorPool) != VK_SUCCESS) {
 			return false;
@@ -488,7 +663,8 @@ namespace mz {
 		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 		samplerInfo.mipLodBias = 0.0f;
 		samplerInfo.minLod = 0.0f;
-		samplerInfo.maxLod = 0.0f;
+		// Textures carry full mip chains, the clamp is left to the image view
+		samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
 
 		if (vkCreateSampler(contextPtr->device.logicalDevice, &samplerInfo, contextPtr->allocator, &contextPtr->textureSampler) != VK_SUCCESS) {
 			MZ_CORE_CRITICAL("Failed to create texture sampler!");
@@ -8,6 +8,10 @@
 #include "vulkan_pipeline.h"
 #include "vulkan_render_pass.h"
 #include "vulkan_texture.h"
+#include "vulkan_object_buffer.h"
+#include "vulkan_meshlet_culler.h"
+#include "vulkan_depth_pyramid.h"
+#include "vulkan_occlusion_queries.h"
 
 namespace mz {
 	class VulkanRendererBackend : public RendererBackend {
@@ -16,9 +20,19 @@ namespace mz {
 		virtual bool Initialize() override;
 		virtual void Shutdown() override;
 		virtual bool BeginFrame() override;
+		virtual bool UploadObjects(const RendererObjectData& objects) override;
+		virtual bool BeginCulling(const RendererCullingState& state) override;
+		virtual void EndCulling() override;
+		virtual void BeginMainRenderPass(bool depthPrepass) override;
+		virtual bool BeginLateCulling() override;
+		virtual void ResumeMainRenderPass(bool depthPrepass) override;
+		virtual void EndDepthPrepass() override;
+		virtual void DrawOcclusionQueries(const RendererOcclusionQuery* queries, uint32_t count, const glm::mat4& viewProjection) override;
+		virtual bool IsObjectOccluded(uint32_t objectIndex, uint32_t key) const override;
 		virtual bool EndFrame() override;
 		virtual void OnResize() override;
 		virtual void UpdateGlobalState(RendererGlobalState globalState) override;
+		inline virtual const RendererFrameStats& GetFrameStats() const override { return m_frameStats; }
 	private:
 		bool m_isMinimized = false;
 		std::shared_ptr<VulkanContext> contextPtr;
@@ -27,6 +41,14 @@ namespace mz {
 		std::shared_ptr<VulkanSwapChain> m_swapChain;
 		std::unique_ptr<VulkanPipeline> m_pipeline;
 		std::unique_ptr<VulkanRenderPass> m_mainRenderPass;
+		std::unique_ptr<VulkanObjectBuffer> m_objectBuffer;
+		// Null when the device lacks the features, see VulkanDeviceInfo::meshletCulling
+		std::unique_ptr<VulkanMeshletCuller> m_meshletCuller;
+		// Created along with the meshlet culler, which samples it
+		std::unique_ptr<VulkanDepthPyramid> m_depthPyramid;
+		std::unique_ptr<VulkanOcclusionQueries> m_occlusionQueries;
+
+		RendererFrameStats m_frameStats;
 
 		static VKAPI_ATTR VkBool32 VKAPI_CALL VulkanDebugCallback(
 			VkDebugUtilsMessageSeverityFlagBitsEXT message_severity,
@@ -34,6 +56,15 @@ namespace mz {
 			const VkDebugUtilsMessengerCallbackDataEXT* callback_data,
 			void* user_data);
 
+		// Grows on demand, see VulkanObjectBuffer::Upload
+		static constexpr uint32_t s_initialObjectCapacity = 1024;
+		// Geometries alive at once, each owns a descriptor set per frame in flight. Creating more fails and the
+		// geometry system draws the placeholder in their place.
+		static constexpr uint32_t s_maxGeometryCount = 4096;
+
+		// Begins or resumes the main render pass and binds the pipeline the first draws use
+		void BeginRenderPass(bool resume, bool depthPrepass);
+		bool RecreateSwapChain();
 		bool CreateCommandBuffers();
 		bool CreateUniformBuffer();
 		bool CreateDescriptorSetLayout();
@@ -76,7 +76,7 @@ namespace mz {
 		s_contextPtr->swapChain.imageViews.resize(s_contextPtr->swapChain.images.size());
 
 		for (size_t i = 0; i < s_contextPtr->swapChain.images.size(); i++) {
-			s_contextPtr->swapChain.imageViews[i] = VulkanFunctions::CreateImageView(s_contextPtr->swapChain.images[i], s_contextPtr->swapChain.surfaceFormat.format, VK_IMAGE_ASPECT_COLOR_BIT);
+			s_contextPtr->swapChain.imageViews[i] = VulkanFunctions::CreateImageView(s_contextPtr->swapChain.images[i], s_contextPtr->swapChain.surfaceFormat.format, VK_IMAGE_ASPECT_COLOR_BIT, 1);
 		}
 	}
 
@@ -184,6 +184,13 @@ namespace mz {
 		vkDeviceWaitIdle(s_contextPtr->device.logicalDevice);
 		Cleanup();
 		Create();
+
+		// The depth attachment has to match the new extent
+		DestroyDepthResources();
+		if (!CreateDepthResources()) {
+			return false;
+		}
+
 		return CreateFramebuffers();
 	}
 
@@ -195,9 +202,10 @@ namespace mz {
 
 		if (!VulkanFunctions::CreateImage(
 			s_contextPtr->swapChain.extent.width, s_contextPtr->swapChain.extent.height,
+			1,
 			s_contextPtr->device.depthFormat,
 			VK_IMAGE_TILING_OPTIMAL,
-			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | (s_contextPtr->device.depthSampling ? VK_IMAGE_USAGE_SAMPLED_BIT : 0),
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 			s_contextPtr->swapChain.depthImage,
 			s_contextPtr->swapChain.depthImageMemory)) {
@@ -205,7 +213,7 @@ namespace mz {
 			return false;
 		}
 
-		s_contextPtr->swapChain.depthImageView = VulkanFunctions::CreateImageView(s_contextPtr->swapChain.depthImage, s_contextPtr->device.depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
+		s_contextPtr->swapChain.depthImageView = VulkanFunctions::CreateImageView(s_contextPtr->swapChain.depthImage, s_contextPtr->device.depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1);
 		if (s_contextPtr->swapChain.depthImageView == VK_NULL_HANDLE) {
 			MZ_CORE_CRITICAL("Failed to create depth image view!");
 			return false;
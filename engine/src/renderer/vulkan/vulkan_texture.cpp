@@ -1,55 +1,355 @@
 #include "vulkan_texture.h"
 
 namespace mz {
-	VulkanTexture::VulkanTexture(stbi_uc* pixels, int32_t width, int32_t height, int32_t channels) 
+	// Level data is placed at offsets that satisfy the copy alignment of every supported format
+	static constexpr VkDeviceSize s_levelAlignment = 16;
+
+	VulkanTexture::VulkanTexture(TextureFormat format, const TextureLevel* levels, uint32_t levelCount, uint32_t firstResidentLevel)
+	{
+		m_format = ToVulkanFormat(format);
+		m_levelCount = levelCount;
+		m_firstResidentLevel = std::min(firstResidentLevel, levelCount - 1);
+
+		// Textures that arrive without a mip chain get a full one generated on the GPU
+		bool generateMips = levelCount == 1 && SupportsLinearBlit(m_format);
+
+		StagingBuffer staging;
+		VkCommandBuffer commandBuffer = VulkanFunctions::BeginSingleUseCommands();
+		if (!RecordUpload(commandBuffer, levels, levelCount, m_firstResidentLevel, generateMips, m_image, staging)) {
+			// Nothing was recorded, the command buffer is dropped without submitting it
+			vkFreeCommandBuffers(s_contextPtr->device.logicalDevice, s_contextPtr->device.graphicsCommandPool, 1, &commandBuffer);
+			return;
+		}
+		VulkanFunctions::EndSingleTimeCommands(commandBuffer);
+
+		DestroyStaging(staging);
+	}
+	
+	VulkanTexture::~VulkanTexture()
+	{
+		if (m_pending) {
+			vkWaitForFences(s_contextPtr->device.logicalDevice, 1, &m_pending->fence, VK_TRUE, UINT64_MAX);
+			vkDestroyFence(s_contextPtr->device.logicalDevice, m_pending->fence, s_contextPtr->allocator);
+			vkFreeCommandBuffers(s_contextPtr->device.logicalDevice, s_contextPtr->device.graphicsCommandPool, 1, &m_pending->commandBuffer);
+			DestroyStaging(m_pending->staging);
+			DestroyImage(m_pending->image);
+		}
+
+		// Descriptor sets of frames in flight may still sample the current and the replaced images
+		s_retiredImages.insert(s_retiredImages.end(), m_retired.begin(), m_retired.end());
+		if (m_image.image != VK_NULL_HANDLE) {
+			s_retiredImages.push_back({ m_image, s_contextPtr->submittedFrameCount });
+		}
+	}
+
+	void VulkanTexture::DestroyRetiredImages(bool force)
+	{
+		for (size_t i = 0; i < s_retiredImages.size();) {
+			if (force || s_retiredImages[i].lastUseFrame <= s_contextPtr->completedFrameCount) {
+				DestroyImage(s_retiredImages[i].image);
+				s_retiredImages[i] = s_retiredImages.back();
+				s_retiredImages.pop_back();
+			}
+			else {
+				++i;
+			}
+		}
+	}
+
+	bool VulkanTexture::RequestResidency(const TextureLevel* levels, uint32_t levelCount, uint32_t firstResidentLevel)
+	{
+		firstResidentLevel = std::min(firstResidentLevel, levelCount - 1);
+		if (m_pending || levelCount != m_levelCount || firstResidentLevel == m_firstResidentLevel) {
+			return false;
+		}
+
+		// The new range is uploaded into a second image while the current one keeps being sampled.
+		// Resident levels are uploaded again from the source rather than copied on the GPU, which
+		// keeps the image in a single layout history and costs at most a third more transfer.
+		VkCommandBuffer commandBuffer = VulkanFunctions::BeginSingleUseCommands();
+
+		PendingUpload pending;
+		if (!RecordUpload(commandBuffer, levels, levelCount, firstResidentLevel, false, pending.image, pending.staging)) {
+			// The current image stays in use, nothing was recorded so nothing is submitted
+			vkFreeCommandBuffers(s_contextPtr->device.logicalDevice, s_contextPtr->device.graphicsCommandPool, 1, &commandBuffer);
+			return false;
+		}
+		pending.commandBuffer = commandBuffer;
+		pending.firstResidentLevel = firstResidentLevel;
+
+		VK_CHECK(vkEndCommandBuffer(commandBuffer));
+
+		VkFenceCreateInfo fenceInfo{};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		VK_CHECK(vkCreateFence(s_contextPtr->device.logicalDevice, &fenceInfo, s_contextPtr->allocator, &pending.fence));
+
+		// No wait here, UpdateResidency() polls the fence on later frames
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+		VK_CHECK(vkQueueSubmit(s_contextPtr->device.graphicsQueue, 1, &submitInfo, pending.fence));
+
+		m_pending = pending;
+		return true;
+	}
+
+	void VulkanTexture::UpdateResidency()
+	{
+		if (m_pending && vkGetFenceStatus(s_contextPtr->device.logicalDevice, m_pending->fence) == VK_SUCCESS) {
+			vkDestroyFence(s_contextPtr->device.logicalDevice, m_pending->fence, s_contextPtr->allocator);
+			vkFreeCommandBuffers(s_contextPtr->device.logicalDevice, s_contextPtr->device.graphicsCommandPool, 1, &m_pending->commandBuffer);
+			DestroyStaging(m_pending->staging);
+
+			// Every frame submitted so far may still reference the old view
+			m_retired.push_back({ m_image, s_contextPtr->submittedFrameCount });
+			m_image = m_pending->image;
+			m_firstResidentLevel = m_pending->firstResidentLevel;
+			++m_version;
+			m_pending.reset();
+		}
+
+		for (size_t i = 0; i < m_retired.size();) {
+			if (m_retired[i].lastUseFrame <= s_contextPtr->completedFrameCount) {
+				DestroyImage(m_retired[i].image);
+				m_retired[i] = m_retired.back();
+				m_retired.pop_back();
+			}
+			else {
+				++i;
+			}
+		}
+	}
+
+	bool VulkanTexture::RecordUpload(VkCommandBuffer commandBuffer, const TextureLevel* levels, uint32_t levelCount,
+		uint32_t firstLevel, bool generateMips, ImageResources& outImage, StagingBuffer& outStaging)
 	{
-		VkDeviceSize imageSize = width * height * channels;
+		const TextureLevel& baseLevel = levels[firstLevel];
+		uint32_t uploadCount = levelCount - firstLevel;
+
+		ImageResources image;
+		image.mipLevels = generateMips ? GetFullMipCount(baseLevel.width, baseLevel.height) : uploadCount;
 
-		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMemory;
+		VkDeviceSize imageSize = 0;
+		for (uint32_t i = firstLevel; i < levelCount; ++i) {
+			imageSize = (imageSize + s_levelAlignment - 1) & ~(s_levelAlignment - 1);
+			imageSize += levels[i].size;
+		}
 
 		// Create a staging buffer in host visible memory so it can be usable as a transfer source for the image data
-		VulkanFunctions::CreateBuffer(
+		if (!VulkanFunctions::CreateBuffer(
 			imageSize, 
 			VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
 			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-			stagingBuffer, 
-			stagingBufferMemory);
+			outStaging.buffer, 
+			outStaging.memory)) {
+			MZ_CORE_ERROR("Failed to create texture staging buffer!");
+			return false;
+		}
+
+		// Copy every level into the staging buffer and describe where it lands in the image,
+		// the first uploaded level becomes mip 0 of the image
+		std::vector<VkBufferImageCopy> regions(uploadCount);
 
-		// Copy values from image loading library to buffer
 		void* data;
-		vkMapMemory(s_contextPtr->device.logicalDevice, stagingBufferMemory, 0, imageSize, 0, &data);
-		memcpy(data, pixels, static_cast<size_t>(imageSize));
-		vkUnmapMemory(s_contextPtr->device.logicalDevice, stagingBufferMemory);
-
-		// Create the image for the texture
-		VulkanFunctions::CreateImage(
-			width, 
-			height, 
-			VK_FORMAT_R8G8B8A8_SRGB, 
+		vkMapMemory(s_contextPtr->device.logicalDevice, outStaging.memory, 0, imageSize, 0, &data);
+		VkDeviceSize offset = 0;
+		for (uint32_t i = 0; i < uploadCount; ++i) {
+			const TextureLevel& level = levels[firstLevel + i];
+
+			offset = (offset + s_levelAlignment - 1) & ~(s_levelAlignment - 1);
+			memcpy(static_cast<uint8_t*>(data) + offset, level.data, level.size);
+
+			VkBufferImageCopy& region = regions[i];
+			region.bufferOffset = offset;
+			region.bufferRowLength = 0;
+			region.bufferImageHeight = 0;
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = i;
+			region.imageSubresource.baseArrayLayer = 0;
+			region.imageSubresource.layerCount = 1;
+			region.imageOffset = { 0, 0, 0 };
+			region.imageExtent = { level.width, level.height, 1 };
+
+			offset += level.size;
+		}
+		vkUnmapMemory(s_contextPtr->device.logicalDevice, outStaging.memory);
+
+		// Create the image for the texture, generated levels are blitted from the level above
+		VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		if (generateMips) {
+			usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		}
+
+		if (!VulkanFunctions::CreateImage(
+			baseLevel.width, 
+			baseLevel.height, 
+			image.mipLevels,
+			m_format, 
 			VK_IMAGE_TILING_OPTIMAL, 
-			VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 
+			usage, 
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 
-			m_image, 
-			m_imageMemory);
+			image.image, 
+			image.memory)) {
+			MZ_CORE_ERROR("Failed to create texture image!");
+			DestroyStaging(outStaging);
+			return false;
+		}
 
-		// Transition layout
-		VulkanFunctions::TransitionImageLayout(m_image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-		VulkanFunctions::CopyBufferToImage(stagingBuffer, m_image, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
-		VulkanFunctions::TransitionImageLayout(m_image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements(s_contextPtr->device.logicalDevice, image.image, &memoryRequirements);
+		image.sizeBytes = memoryRequirements.size;
+
+		// Copy, mip generation and the final transitions go into one submission
+		RecordBarrier(commandBuffer, image.image, 0, image.mipLevels,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			0, VK_ACCESS_TRANSFER_WRITE_BIT,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+		vkCmdCopyBufferToImage(commandBuffer, outStaging.buffer, image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, uploadCount, regions.data());
+
+		if (generateMips) {
+			RecordMipChain(commandBuffer, image.image, image.mipLevels, baseLevel.width, baseLevel.height);
+		}
+		else {
+			RecordBarrier(commandBuffer, image.image, 0, image.mipLevels,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+		}
 
 		// Create image view for the texture
-		m_imageView = VulkanFunctions::CreateImageView(m_image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
+		image.view = VulkanFunctions::CreateImageView(image.image, m_format, VK_IMAGE_ASPECT_COLOR_BIT, image.mipLevels);
 
-		// Destroy temporary buffer
-		vkDestroyBuffer(s_contextPtr->device.logicalDevice, stagingBuffer, s_contextPtr->allocator);
-		vkFreeMemory(s_contextPtr->device.logicalDevice, stagingBufferMemory, s_contextPtr->allocator);
+		outImage = image;
+		return true;
 	}
-	
-	VulkanTexture::~VulkanTexture()
+
+	void VulkanTexture::DestroyImage(ImageResources& image)
+	{
+		vkDestroyImageView(s_contextPtr->device.logicalDevice, image.view, s_contextPtr->allocator);
+		vkDestroyImage(s_contextPtr->device.logicalDevice, image.image, s_contextPtr->allocator);
+		vkFreeMemory(s_contextPtr->device.logicalDevice, image.memory, s_contextPtr->allocator);
+		image = ImageResources();
+	}
+
+	void VulkanTexture::DestroyStaging(StagingBuffer& staging)
+	{
+		vkDestroyBuffer(s_contextPtr->device.logicalDevice, staging.buffer, s_contextPtr->allocator);
+		vkFreeMemory(s_contextPtr->device.logicalDevice, staging.memory, s_contextPtr->allocator);
+		staging = StagingBuffer();
+	}
+
+	VkFormat VulkanTexture::ToVulkanFormat(TextureFormat format)
+	{
+		switch (format) {
+		case TextureFormat::RGBA8_SRGB:
+			return VK_FORMAT_R8G8B8A8_SRGB;
+		case TextureFormat::BC1_RGB_SRGB:
+			return VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+		case TextureFormat::BC3_SRGB:
+			return VK_FORMAT_BC3_SRGB_BLOCK;
+		case TextureFormat::BC7_SRGB:
+			return VK_FORMAT_BC7_SRGB_BLOCK;
+		default:
+			MZ_CORE_ERROR("Unsupported texture format {0}", static_cast<uint32_t>(format));
+			return VK_FORMAT_R8G8B8A8_SRGB;
+		}
+	}
+
+	uint32_t VulkanTexture::GetFullMipCount(uint32_t width, uint32_t height)
+	{
+		uint32_t levels = 1;
+		for (uint32_t size = std::max(width, height); size > 1; size >>= 1) {
+			++levels;
+		}
+		return levels;
+	}
+
+	bool VulkanTexture::SupportsLinearBlit(VkFormat format)
+	{
+		VkFormatProperties properties;
+		vkGetPhysicalDeviceFormatProperties(s_contextPtr->device.physicalDevice, format, &properties);
+
+		VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+		return (properties.optimalTilingFeatures & required) == required;
+	}
+
+	void VulkanTexture::RecordBarrier(VkCommandBuffer commandBuffer, VkImage image, uint32_t baseMipLevel, uint32_t levelCount,
+		VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+		VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage)
+	{
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = newLayout;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstAccessMask = dstAccess;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseMipLevel = baseMipLevel;
+		barrier.subresourceRange.levelCount = levelCount;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+
+		vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	}
+
+	void VulkanTexture::RecordMipChain(VkCommandBuffer commandBuffer, VkImage image, uint32_t mipLevels, uint32_t width, uint32_t height)
+	{
+		// Each level is filtered down from the one above it. Once a level has been read for the
+		// last time it moves straight to its sampled layout, so no level is transitioned twice.
+		int32_t levelWidth = static_cast<int32_t>(width);
+		int32_t levelHeight = static_cast<int32_t>(height);
+
+		for (uint32_t i = 1; i < mipLevels; ++i) {
+			RecordBarrier(commandBuffer, image, i - 1, 1,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+			int32_t nextWidth = std::max(levelWidth / 2, 1);
+			int32_t nextHeight = std::max(levelHeight / 2, 1);
+
+			VkImageBlit blit{};
+			blit.srcOffsets[0] = { 0, 0, 0 };
+			blit.srcOffsets[1] = { levelWidth, levelHeight, 1 };
+			blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			blit.srcSubresource.mipLevel = i - 1;
+			blit.srcSubresource.baseArrayLayer = 0;
+			blit.srcSubresource.layerCount = 1;
+			blit.dstOffsets[0] = { 0, 0, 0 };
+			blit.dstOffsets[1] = { nextWidth, nextHeight, 1 };
+			blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			blit.dstSubresource.mipLevel = i;
+			blit.dstSubresource.baseArrayLayer = 0;
+			blit.dstSubresource.layerCount = 1;
+
+			vkCmdBlitImage(commandBuffer,
+				image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				1, &blit, VK_FILTER_LINEAR);
+
+			RecordBarrier(commandBuffer, image, i - 1, 1,
+				VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+			levelWidth = nextWidth;
+			levelHeight = nextHeight;
+		}
+
+		// The last level was only ever written
+		RecordBarrier(commandBuffer, image, mipLevels - 1, 1,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+	}
+
+	bool VulkanTexture::IsFormatSupported(TextureFormat format)
 	{
-		vkDestroyImageView(s_contextPtr->device.logicalDevice, m_imageView, s_contextPtr->allocator);
-		vkDestroyImage(s_contextPtr->device.logicalDevice, m_image, s_contextPtr->allocator);
-		vkFreeMemory(s_contextPtr->device.logicalDevice, m_imageMemory, s_contextPtr->allocator);
+		return !IsBlockCompressed(format) || s_contextPtr->device.textureCompressionBC;
 	}
 }
\ No newline at end of file
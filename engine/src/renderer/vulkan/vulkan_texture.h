@@ -8,14 +8,83 @@ namespace mz {
 	class VulkanTexture : public Texture {
 	public:
 		inline static void SetContextPointer(std::shared_ptr<VulkanContext> contextPtr) { s_contextPtr = contextPtr; }
-		VulkanTexture(stbi_uc* pixels, int32_t width, int32_t height, int32_t channels);
+		VulkanTexture(TextureFormat format, const TextureLevel* levels, uint32_t levelCount, uint32_t firstResidentLevel);
 		~VulkanTexture();
-		inline VkImageView GetImageView() { return m_imageView; }
+		inline VkImageView GetImageView() const { return m_image.view; }
+		inline uint32_t GetMipLevels() const { return m_image.mipLevels; }
+		// Bumped whenever the image view is replaced, descriptor sets holding the old view must be rewritten
+		inline uint32_t GetVersion() const { return m_version; }
+		virtual uint64_t GetSizeBytes() const override { return m_image.sizeBytes; }
+		// False when the image or its staging buffer could not be created, Texture::CreateTexture then drops the texture
+		inline bool IsCreated() const { return m_image.image != VK_NULL_HANDLE; }
+
+		virtual uint32_t GetLevelCount() const override { return m_levelCount; }
+		virtual uint32_t GetFirstResidentLevel() const override { return m_firstResidentLevel; }
+		virtual bool IsResidencyPending() const override { return m_pending.has_value(); }
+		virtual bool RequestResidency(const TextureLevel* levels, uint32_t levelCount, uint32_t firstResidentLevel) override;
+		virtual void UpdateResidency() override;
+
+		static VkFormat ToVulkanFormat(TextureFormat format);
+		static bool IsFormatSupported(TextureFormat format);
+		// Frees the images of deleted textures that no submitted frame samples anymore, all of them when force is
+		// set. Called once per frame after the fence wait and at shutdown.
+		static void DestroyRetiredImages(bool force);
 	private:
 		inline static std::shared_ptr<VulkanContext> s_contextPtr = nullptr;
 
-		VkImage m_image;
-		VkDeviceMemory m_imageMemory;
-		VkImageView m_imageView;
+		struct ImageResources {
+			VkImage image = VK_NULL_HANDLE;
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			VkImageView view = VK_NULL_HANDLE;
+			uint32_t mipLevels = 0;
+			uint64_t sizeBytes = 0;
+		};
+
+		struct StagingBuffer {
+			VkBuffer buffer = VK_NULL_HANDLE;
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+		};
+
+		// Residency change that is executing on the GPU, swapped in once its fence signals
+		struct PendingUpload {
+			ImageResources image;
+			StagingBuffer staging;
+			VkCommandBuffer commandBuffer;
+			VkFence fence;
+			uint32_t firstResidentLevel;
+		};
+
+		// Replaced image that frames already submitted may still sample
+		struct RetiredImage {
+			ImageResources image;
+			uint64_t lastUseFrame;
+		};
+
+		VkFormat m_format;
+		ImageResources m_image;
+		uint32_t m_levelCount;
+		uint32_t m_firstResidentLevel;
+		uint32_t m_version = 0;
+		std::optional<PendingUpload> m_pending;
+		std::vector<RetiredImage> m_retired;
+
+		// Images of deleted textures, they outlive the texture until the frames that may sample them have finished
+		inline static std::vector<RetiredImage> s_retiredImages;
+
+		// Creates an image holding levels [firstLevel, levelCount) and records their upload. The staging
+		// buffer is returned to the caller, who frees it once the command buffer has executed. On failure
+		// nothing is recorded and nothing has to be freed.
+		bool RecordUpload(VkCommandBuffer commandBuffer, const TextureLevel* levels, uint32_t levelCount, uint32_t firstLevel,
+			bool generateMips, ImageResources& outImage, StagingBuffer& outStaging);
+
+		static void RecordMipChain(VkCommandBuffer commandBuffer, VkImage image, uint32_t mipLevels, uint32_t width, uint32_t height);
+		static void DestroyImage(ImageResources& image);
+		static void DestroyStaging(StagingBuffer& staging);
+
+		static uint32_t GetFullMipCount(uint32_t width, uint32_t height);
+		static bool SupportsLinearBlit(VkFormat format);
+		static void RecordBarrier(VkCommandBuffer commandBuffer, VkImage image, uint32_t baseMipLevel, uint32_t levelCount,
+			VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+			VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "asset_manifest.h"
+#include "engine/src/core/log.h"
+
+namespace mz {
+	static constexpr uint32_t s_manifestVersion = 1;
+
+	bool AssetManifest::Load(const std::string& filePath)
+	{
+		std::ifstream file(filePath);
+		if (!file.is_open()) {
+			return false;
+		}
+
+		std::string magic;
+		uint32_t version = 0;
+		file >> magic >> version;
+		if (magic != "mzmanifest" || version != s_manifestVersion) {
+			MZ_CORE_WARN("Asset manifest {0} has an unsupported version, ignoring it", filePath);
+			return false;
+		}
+
+		m_entries.clear();
+
+		// One entry per line: <hash>\t<source name>\t<cooked path>
+		std::string line;
+		std::getline(file, line);
+		while (std::getline(file, line)) {
+			size_t first = line.find('\t');
+			size_t second = line.find('\t', first + 1);
+			if (first == std::string::npos || second == std::string::npos) {
+				continue;
+			}
+
+			AssetManifestEntry entry;
+			entry.contentHash = std::stoull(line.substr(0, first), nullptr, 16);
+			entry.cookedPath = line.substr(second + 1);
+			m_entries[line.substr(first + 1, second - first - 1)] = entry;
+		}
+
+		return true;
+	}
+
+	bool AssetManifest::Save(const std::string& filePath) const
+	{
+		std::ofstream file(filePath, std::ios::trunc);
+		if (!file.is_open()) {
+			MZ_CORE_ERROR("Failed to open asset manifest {0} for writing", filePath);
+			return false;
+		}
+
+		file << "mzmanifest " << s_manifestVersion << '\n';
+		for (const auto& [sourceName, entry] : m_entries) {
+			file << std::hex << entry.contentHash << std::dec << '\t' << sourceName << '\t' << entry.cookedPath << '\n';
+		}
+
+		return static_cast<bool>(file);
+	}
+
+	const AssetManifestEntry* AssetManifest::Find(const std::string& sourceName) const
+	{
+		auto it = m_entries.find(sourceName);
+		return it != m_entries.end() ? &it->second : nullptr;
+	}
+
+	void AssetManifest::Set(const std::string& sourceName, const AssetManifestEntry& entry)
+	{
+		m_entries[sourceName] = entry;
+	}
+
+	bool AssetManifest::FindCookedPath(const std::string& sourceName, std::string& outPath) const
+	{
+		const AssetManifestEntry* entry = Find(sourceName);
+		if (!entry) {
+			return false;
+		}
+
+		outPath = s_cookedRoot + entry->cookedPath;
+		return true;
+	}
+}
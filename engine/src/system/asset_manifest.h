@@ -0,0 +1,34 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+
+namespace mz {
+	struct AssetManifestEntry {
+		// Hash of the source file contents salted with the cooked format version
+		uint64_t contentHash = 0;
+		// Relative to the cooked asset root
+		std::string cookedPath;
+	};
+
+	// Maps source asset names ("models/tower2.fbx", "textures/vapor.png") to their cooked files.
+	// Written by mzcook, loaded once by the runtime at startup.
+	class AssetManifest {
+	public:
+		inline static const std::string s_cookedRoot = "assets/cooked/";
+		inline static const std::string s_fileName = "manifest.mzmanifest";
+
+		bool Load(const std::string& filePath);
+		bool Save(const std::string& filePath) const;
+
+		const AssetManifestEntry* Find(const std::string& sourceName) const;
+		void Set(const std::string& sourceName, const AssetManifestEntry& entry);
+
+		// Resolves a source name to the path of its cooked file under s_cookedRoot
+		bool FindCookedPath(const std::string& sourceName, std::string& outPath) const;
+
+		inline size_t Size() const { return m_entries.size(); }
+	private:
+		// Ordered so saved manifests are deterministic and diff cleanly
+		std::map<std::string, AssetManifestEntry> m_entries;
+	};
+}
@@ -1,196 +1,484 @@
 #include "geometry_system.h"
 #include "engine/src/core/log.h"
+#include "engine/src/core/utils.h"
 #include "engine/src/renderer/render_types.h"
+#include "mesh_importer.h"
 
 namespace mz {
 	GeometrySystem::GeometrySystem()
 	{
+		// Failed and loading geometries resolve to the placeholder, so everything relies on it
+		m_placeholder = CreatePlaceholder();
+		MZ_ASSERT_MSG(m_placeholder, "Failed to create the placeholder geometry!");
 	}
-	const Geometry* GeometrySystem::Acquire(std::string name)
+
+	GeometryHandle GeometrySystem::Acquire(std::string name)
+	{
+		GeometryHandle handle = FindOrAddEntry(name);
+		GeometryEntry& entry = *m_geometries.Get(handle);
+
+		if (entry.state == GeometryState::Ready) {
+			return handle;
+		}
+
+		// Supersedes an asynchronous load that may still be in flight, its result is dropped once the entry is ready
+		entry.state = GeometryState::Pending;
+
+		auto result = std::make_unique<GeometryLoadResult>();
+		if (!LoadGeometryData(name, *result)) {
+			result.reset();
+		}
+		FinishLoad(handle, entry, std::move(result));
+
+		return handle;
+	}
+
+	GeometryHandle GeometrySystem::AcquireAsync(std::string name)
 	{
-		auto it = m_geometries.find(name);
+		GeometryHandle handle = FindOrAddEntry(name);
+		GeometryEntry& entry = *m_geometries.Get(handle);
+
+		if (entry.state == GeometryState::Ready || entry.state == GeometryState::Pending) {
+			return handle;
+		}
 
-		if (it == m_geometries.end()) {
-			if (!LoadGeometryAssimp(name)) {
-				return nullptr;
+		entry.state = GeometryState::Pending;
+
+		// Workers only produce CPU data, the GPU upload happens on the main thread in Update()
+		Application::Get().GetJobSystem().Submit([this, handle, name]() {
+			auto result = std::make_unique<GeometryLoadResult>();
+			if (!LoadGeometryData(name, *result)) {
+				result.reset();
 			}
-			it = m_geometries.find(name);
+
+			std::lock_guard<std::mutex> lock(m_completedMutex);
+			m_completedLoads.push_back({ handle, std::move(result) });
+		});
+
+		return handle;
+	}
+
+	void GeometrySystem::Release(GeometryHandle handle)
+	{
+		GeometryEntry* entry = m_geometries.Get(handle);
+		if (!entry) {
+			MZ_CORE_WARN("Tried to release a geometry handle that is no longer valid.");
+			return;
 		}
 
-		if (it != m_geometries.end()) {
-			return it->second;
+		if (m_geometries.Release(handle) > 0) {
+			return;
+		}
+
+		// Freeing the slot bumps its generation, so a load still in flight for it is dropped in Update()
+		delete entry->geometry;
+		Application::Get().GetTextureSystem().Release(entry->texture);
+		m_handles.erase(entry->name);
+
+		auto hashIt = m_handlesByHash.find(entry->contentHash);
+		if (hashIt != m_handlesByHash.end() && hashIt->second == handle) {
+			m_handlesByHash.erase(hashIt);
 		}
 
-		return nullptr;
+		GeometryHandle alias = entry->alias;
+		m_geometries.Remove(handle);
+		if (alias.IsValid()) {
+			Release(alias);
+		}
 	}
 
-	void GeometrySystem::Destroy(std::string name)
+	const Geometry* GeometrySystem::Get(GeometryHandle handle) const
 	{
-		auto it = m_geometries.find(name);
+		const GeometryEntry* entry = Resolve(handle);
+		return entry ? entry->geometry : m_placeholder;
+	}
 
-		if (it != m_geometries.end())
-		{
-			Geometry* geometry = it->second;
+	bool GeometrySystem::IsReady(GeometryHandle handle) const
+	{
+		const GeometryEntry* entry = m_geometries.Get(handle);
+		return entry && entry->state == GeometryState::Ready;
+	}
+
+	glm::vec4 GeometrySystem::GetBoundingSphere(GeometryHandle handle) const
+	{
+		const GeometryEntry* entry = Resolve(handle);
+		return entry ? entry->boundingSphere : m_placeholderBounds;
+	}
+
+	void GeometrySystem::ReportCoverage(GeometryHandle handle, float screenPixels)
+	{
+		const GeometryEntry* entry = Resolve(handle);
+		TextureHandle texture = entry ? entry->texture : m_placeholderTexture;
+		Application::Get().GetTextureSystem().ReportCoverage(texture, screenPixels);
+	}
+
+	void GeometrySystem::Update()
+	{
+		size_t uploadedBytes = 0;
+
+		while (true) {
+			CompletedLoad load;
+
+			{
+				std::lock_guard<std::mutex> lock(m_completedMutex);
+				if (m_completedLoads.empty()) {
+					break;
+				}
+
+				const GeometryLoadResult* next = m_completedLoads.front().result.get();
+				size_t size = next ? size_t(next->data.vertexCount) * GetVertexStride(next->data.vertexFormat) + size_t(next->data.indexCount) * next->data.indexStride : 0;
 
-			delete geometry;
+				// The rest waits for the next frame so a burst of finished loads does not stall one frame
+				if (uploadedBytes > 0 && uploadedBytes + size > s_uploadBudgetBytes) {
+					break;
+				}
+
+				uploadedBytes += size;
+				load = std::move(m_completedLoads.front());
+				m_completedLoads.pop_front();
+			}
+
+			// Released or loaded synchronously while the job was running
+			GeometryEntry* entry = m_geometries.Get(load.handle);
+			if (!entry || entry->state != GeometryState::Pending) {
+				continue;
+			}
 
-			m_geometries.erase(it);
+			FinishLoad(load.handle, *entry, std::move(load.result));
 		}
 
-		MZ_CORE_WARN("Tried to delete geometry {0}, which does not exist in the geometry system.", name);
+		// Textures are loaded asynchronously too, geometries switch to theirs once it is uploaded
+		TextureSystem& textureSystem = Application::Get().GetTextureSystem();
+		for (size_t i = 0; i < m_unboundTextures.size();) {
+			GeometryEntry* entry = m_geometries.Get(m_unboundTextures[i]);
+			if (entry && textureSystem.IsPending(entry->texture)) {
+				++i;
+				continue;
+			}
+
+			if (entry && entry->state == GeometryState::Ready) {
+				entry->geometry->SetTexture(textureSystem.Get(entry->texture));
+			}
+			m_unboundTextures[i] = m_unboundTextures.back();
+			m_unboundTextures.pop_back();
+		}
+	}
+
+	GeometrySystemStats GeometrySystem::GetStats() const
+	{
+		GeometrySystemStats stats;
+		stats.geometryCount = m_geometries.Size();
+		stats.contentHits = m_contentHits;
+
+		m_geometries.ForEach([&](GeometryHandle handle, const GeometryEntry& entry) {
+			uint32_t references = m_geometries.GetRefCount(handle);
+			stats.referenceCount += references;
+
+			// Aliases hold one reference on the entry they resolve to, which already counts as a saved copy
+			const GeometryEntry* owner = Resolve(handle);
+			if (!owner || !owner->geometry) {
+				return;
+			}
+
+			uint64_t sizeBytes = owner->geometry->GetSizeBytes();
+			if (owner == &entry) {
+				stats.residentBytes += sizeBytes;
+			}
+			else {
+				++stats.sharedGeometryCount;
+			}
+			stats.savedBytes += (references - 1) * sizeBytes;
+		});
+
+		return stats;
 	}
 
 	void GeometrySystem::Shutdown()
 	{
-		for (auto& pair : m_geometries)
 		{
-			delete pair.second;
+			std::lock_guard<std::mutex> lock(m_completedMutex);
+			m_completedLoads.clear();
 		}
 
-		m_geometries.clear();
+		GeometrySystemStats stats = GetStats();
+		MZ_CORE_INFO("Geometry cache: {0} geometries, {1} KiB resident, {2} KiB saved by sharing ({3} content hits, {4} names drawing shared buffers)",
+			stats.geometryCount, stats.residentBytes / 1024, stats.savedBytes / 1024, stats.contentHits, stats.sharedGeometryCount);
+
+		// Texture references are left to the texture system, which shuts down next and reports what was shared
+		m_geometries.ForEach([](GeometryHandle, GeometryEntry& entry) {
+			delete entry.geometry;
+		});
+
+		m_geometries.Clear();
+		m_handles.clear();
+		m_handlesByHash.clear();
+		m_unboundTextures.clear();
+
+		delete m_placeholder;
+		m_placeholder = nullptr;
 	}
 
-	bool GeometrySystem::LoadObjGeometry(std::string name)
+	GeometryHandle GeometrySystem::FindOrAddEntry(const std::string& name)
 	{
-		std::string filePath = "assets/models/" + name;
+		auto it = m_handles.find(name);
+		if (it != m_handles.end()) {
+			m_geometries.AddRef(it->second);
+			return it->second;
+		}
 
-		std::vector<Vertex3d> vertices;
-		std::vector<uint32_t> indices;
+		GeometryEntry entry;
+		entry.name = name;
+		GeometryHandle handle = m_geometries.Insert(std::move(entry));
+		m_handles.emplace(name, handle);
 
-		tinyobj::attrib_t attrib;
-		std::vector<tinyobj::shape_t> shapes;
-		std::vector<tinyobj::material_t> materials;
-		std::string warn, err;
+		return handle;
+	}
 
-		if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filePath.c_str())) {
-			MZ_CORE_ERROR("TinyObjLoader failed to load geometry {0}, warning: {1}, error: {2}", name, warn, err);
-			return false;
+	void GeometrySystem::FinishLoad(GeometryHandle handle, GeometryEntry& entry, std::unique_ptr<GeometryLoadResult> result)
+	{
+		if (!result) {
+			MZ_CORE_ERROR("Failed to load geometry {0}, using the placeholder", entry.name);
+			entry.state = GeometryState::Failed;
+			return;
 		}
 
-		// Vertex de-duplication
-		std::unordered_map<Vertex3d, uint32_t> uniqueVertices{};
-		for (const auto& shape : shapes) {
-			for (const auto& index : shape.mesh.indices) {
-				Vertex3d vertex{};
+		// Same contents under a different name are drawn from the buffers that are already uploaded
+		entry.contentHash = result->contentHash;
+		entry.contentCheck = result->contentCheck;
+		auto hashIt = m_handlesByHash.find(result->contentHash);
+		if (hashIt != m_handlesByHash.end()) {
+			const GeometryEntry* owner = m_geometries.Get(hashIt->second);
+			// Cooked owners are compared byte for byte, imported ones by the second digest
+			bool same = owner->contentCheck == result->contentCheck
+				&& (!owner->source || IsSameGeometryData(owner->source->data, result->data));
+			if (same) {
+				m_geometries.AddRef(hashIt->second);
+				entry.alias = hashIt->second;
+				entry.state = GeometryState::Ready;
+				++m_contentHits;
+
+				MZ_CORE_TRACE("Geometry {0} has the same contents as {1}, sharing it.", entry.name, owner->name);
+				return;
+			}
 
-				if (index.vertex_index >= 0) {
-					vertex.pos = {
-						attrib.vertices[3 * index.vertex_index + 0],
-						attrib.vertices[3 * index.vertex_index + 1],
-						attrib.vertices[3 * index.vertex_index + 2],
-					};
-
-					vertex.color = {
-						attrib.colors[3 * index.vertex_index + 0],
-						attrib.colors[3 * index.vertex_index + 1],
-						attrib.colors[3 * index.vertex_index + 2],
-					};
-				}
+			MZ_CORE_WARN("Geometry {0} has the content hash of {1} but different contents, uploading it separately.", entry.name, owner->name);
+		}
 
-				// Uncomment when normals implemeneted
-				if (index.normal_index >= 0) {
-					vertex.normal = {
-						attrib.normals[3 * index.normal_index + 0],
-						attrib.normals[3 * index.normal_index + 1],
-						attrib.normals[3 * index.normal_index + 2],
-					};
-				}
+		TextureSystem& textureSystem = Application::Get().GetTextureSystem();
+		entry.texture = textureSystem.AcquireAsync("vapor.png");
+		entry.geometry = Geometry::Create(result->data, textureSystem.Get(entry.texture));
 
-				if (index.texcoord_index >= 0) {
-					vertex.texCoord = {
-						attrib.texcoords[2 * index.texcoord_index + 0],
-						attrib.texcoords[2 * index.texcoord_index + 1],
-					};
-				}
+		if (!entry.geometry) {
+			textureSystem.Release(entry.texture);
+			entry.texture = TextureHandle();
+			entry.state = GeometryState::Failed;
+			return;
+		}
 
-				if (uniqueVertices.count(vertex) == 0) {
-					uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-					vertices.push_back(vertex);
-				}
-				indices.push_back(uniqueVertices[vertex]);
-			}
+		if (textureSystem.IsPending(entry.texture)) {
+			m_unboundTextures.push_back(handle);
 		}
 
-		Geometry* newGeometry = Geometry::Create(vertices, indices, "vapor.png");
-		m_geometries.emplace(name, newGeometry);
+		glm::vec3 center = 0.5f * (result->data.boundsMin + result->data.boundsMax);
+		entry.boundingSphere = glm::vec4(center, glm::length(result->data.boundsMax - center));
+		entry.state = GeometryState::Ready;
+
+		// After a collision the first owner keeps the hash. Only a mapping is cheap enough to hold on to,
+		// an imported mesh would keep its whole CPU copy alive next to the GPU buffers.
+		if (m_handlesByHash.emplace(entry.contentHash, handle).second && result->file.IsOpen()) {
+			entry.source = std::move(result);
+		}
 	}
 
-	bool GeometrySystem::LoadGeometryAssimp(std::string name) {
-		std::string filePath = "assets/models/" + name;
+	const GeometrySystem::GeometryEntry* GeometrySystem::Resolve(GeometryHandle handle) const
+	{
+		const GeometryEntry* entry = m_geometries.Get(handle);
+		if (!entry || entry->state != GeometryState::Ready) {
+			return nullptr;
+		}
 
-		std::vector<Vertex3d> vertices;
-		std::vector<uint32_t> indices;
+		// Only entries that own their geometry are aliased, so one step is enough
+		return entry->alias.IsValid() ? m_geometries.Get(entry->alias) : entry;
+	}
 
-		Assimp::Importer importer;
-		const aiScene* scene = importer.ReadFile(filePath, aiProcess_Triangulate | aiProcess_FlipUVs);
+	GeometrySubmesh GeometrySystem::ToGeometrySubmesh(const MeshFileSubmesh& submesh)
+	{
+		GeometrySubmesh result;
+		result.firstIndex = submesh.firstIndex;
+		result.indexCount = submesh.indexCount;
+		result.firstVertex = submesh.firstVertex;
+		result.materialSlot = submesh.materialSlot;
+		result.boundsMin = submesh.boundsMin;
+		result.boundsMax = submesh.boundsMax;
+		return result;
+	}
 
-		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-			MZ_CORE_ERROR("Assimp failed to load geometry {0}, error: {1}", name, importer.GetErrorString());
+	bool GeometrySystem::LoadGeometryData(const std::string& name, GeometryLoadResult& result)
+	{
+		// Cooked meshes are mapped and uploaded as is, the Assimp import only runs when no cooked file exists
+		if (!LoadCookedGeometry(name, result) && !LoadGeometryAssimp(name, result)) {
 			return false;
 		}
 
-		ProcessNode(scene->mRootNode, scene, vertices, indices);
-
-		// Create your Geometry object (you might need to modify the Geometry::Create function)
-		Geometry* newGeometry = Geometry::Create(vertices, indices, "vapor.png");
-		m_geometries.emplace(name, newGeometry);
-
+		// Hashed here so the workers pay for it, not the main thread
+		result.contentHash = HashGeometryData(result.data, 0);
+		result.contentCheck = HashGeometryData(result.data, s_contentCheckSeed);
 		return true;
 	}
 
-	void GeometrySystem::ProcessNode(aiNode* node, const aiScene* scene, std::vector<Vertex3d>& vertices, std::vector<uint32_t>& indices)
+	uint64_t GeometrySystem::HashGeometryData(const GeometryData& data, uint64_t seed)
 	{
-		for (unsigned int i = 0; i < node->mNumMeshes; ++i) {
-			aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-			ProcessMesh(mesh, scene, vertices, indices);
-		}
+		// The layout goes into the seed, so the same bytes in another vertex or index format do not match
+		uint64_t hash = seed ^ (uint64_t(data.vertexFormat) << 32) ^ data.indexStride;
+		hash = HashBytes(data.vertices, size_t(data.vertexCount) * GetVertexStride(data.vertexFormat), hash);
+		hash = HashBytes(data.indices, size_t(data.indexCount) * data.indexStride, hash);
+		hash = HashBytes(data.submeshes.data(), data.submeshes.size() * sizeof(GeometrySubmesh), hash);
+		hash = HashBytes(data.lods.data(), data.lods.size() * sizeof(GeometryLod), hash);
+		hash = HashBytes(data.meshlets, size_t(data.meshletCount) * sizeof(Meshlet), hash);
+		// Packed positions are relative to the bounds
+		hash = HashBytes(&data.boundsMin, sizeof(data.boundsMin), hash);
+		return HashBytes(&data.boundsMax, sizeof(data.boundsMax), hash);
+	}
 
-		for (unsigned int i = 0; i < node->mNumChildren; ++i) {
-			ProcessNode(node->mChildren[i], scene, vertices, indices);
+	bool GeometrySystem::IsSameGeometryData(const GeometryData& a, const GeometryData& b)
+	{
+		if (a.vertexFormat != b.vertexFormat || a.vertexCount != b.vertexCount || a.indexCount != b.indexCount || a.indexStride != b.indexStride
+			|| a.submeshes.size() != b.submeshes.size() || a.lods.size() != b.lods.size() || a.meshletCount != b.meshletCount
+			|| a.boundsMin != b.boundsMin || a.boundsMax != b.boundsMax) {
+			return false;
 		}
+
+		// Compared as the same bytes the hash was computed from
+		return memcmp(a.vertices, b.vertices, size_t(a.vertexCount) * GetVertexStride(a.vertexFormat)) == 0
+			&& memcmp(a.indices, b.indices, size_t(a.indexCount) * a.indexStride) == 0
+			&& memcmp(a.submeshes.data(), b.submeshes.data(), a.submeshes.size() * sizeof(GeometrySubmesh)) == 0
+			&& memcmp(a.lods.data(), b.lods.data(), a.lods.size() * sizeof(GeometryLod)) == 0
+			&& (a.meshletCount == 0 || memcmp(a.meshlets, b.meshlets, size_t(a.meshletCount) * sizeof(Meshlet)) == 0);
 	}
 
-	void GeometrySystem::ProcessMesh(aiMesh* mesh, const aiScene* scene, std::vector<Vertex3d>& vertices, std::vector<uint32_t>& indices)
+	bool GeometrySystem::LoadCookedGeometry(const std::string& name, GeometryLoadResult& result)
 	{
-		for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
-			Vertex3d vertex{};
-			vertex.pos = {
-				mesh->mVertices[i].x,
-				mesh->mVertices[i].y,
-				mesh->mVertices[i].z
-			};
+		auto startTime = std::chrono::high_resolution_clock::now();
 
-			if (mesh->HasVertexColors(0)) {
-				vertex.color = {
-					mesh->mColors[0][i].r,
-					mesh->mColors[0][i].g,
-					mesh->mColors[0][i].b
-				};
-			}
+		std::string cookedPath;
+		if (!Application::Get().GetAssetManifest().FindCookedPath("models/" + name, cookedPath)) {
+			return false;
+		}
 
-			if (mesh->HasNormals()) {
-				vertex.normal = {
-					mesh->mNormals[i].x,
-					mesh->mNormals[i].y,
-					mesh->mNormals[i].z
-				};
-			}
+		if (!result.file.Open(cookedPath)) {
+			MZ_CORE_WARN("Cooked geometry {0} is listed in the manifest but could not be opened", cookedPath);
+			return false;
+		}
 
-			if (mesh->HasTextureCoords(0)) {
-				vertex.texCoord = {
-					mesh->mTextureCoords[0][i].x,
-					mesh->mTextureCoords[0][i].y
-				};
-			}
+		MeshFileView mesh;
+		if (!mesh.Parse(result.file.GetData(), result.file.GetSize())) {
+			MZ_CORE_WARN("Ignoring cooked geometry {0}", cookedPath);
+			result.file.Close();
+			return false;
+		}
 
-			vertices.push_back(vertex);
+		const MeshFileHeader& header = mesh.GetHeader();
+		result.data.vertexFormat = mesh.GetVertexFormat();
+		result.data.vertices = mesh.GetVertices();
+		result.data.vertexCount = header.vertexCount;
+		result.data.indices = mesh.GetIndices();
+		result.data.indexCount = header.indexCount;
+		result.data.indexStride = header.indexStride;
+		result.data.submeshes.reserve(header.submeshCount);
+		for (uint32_t i = 0; i < header.submeshCount; ++i) {
+			const MeshFileSubmesh& submesh = mesh.GetSubmeshes()[i];
+			result.data.submeshes.push_back(ToGeometrySubmesh(submesh));
 		}
+		result.data.lods.reserve(header.lodCount);
+		for (uint32_t i = 0; i < header.lodCount; ++i) {
+			const MeshFileLod& lod = mesh.GetLods()[i];
+			result.data.lods.push_back(GeometryLod{ lod.firstSubmesh, lod.submeshCount, lod.error, lod.firstMeshlet, lod.meshletCount });
+		}
+		result.data.meshlets = mesh.GetMeshlets();
+		result.data.meshletCount = header.meshletCount;
+		result.data.boundsMin = header.boundsMin;
+		result.data.boundsMax = header.boundsMax;
+
+		auto endTime = std::chrono::high_resolution_clock::now();
+		MZ_CORE_INFO("Loaded cooked geometry {0} ({1} {2} vertices, {3} {4} bit indices, {5} LODs, {6} meshlets) in {7} ms", name, header.vertexCount,
+			result.data.vertexFormat == VertexFormat::Packed ? "packed" : "float", header.indexCount, header.indexStride * 8, header.lodCount, header.meshletCount,
+			std::chrono::duration<float, std::chrono::milliseconds::period>(endTime - startTime).count());
+
+		return true;
+	}
+
+	bool GeometrySystem::LoadGeometryAssimp(const std::string& name, GeometryLoadResult& result) {
+		auto startTime = std::chrono::high_resolution_clock::now();
 
-		for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
-			aiFace face = mesh->mFaces[i];
-			for (unsigned int j = 0; j < face.mNumIndices; ++j) {
-				indices.push_back(face.mIndices[j]);
+		MZ_CORE_WARN("Geometry {0} is not cooked, importing it at runtime. Run the mzcook target to cook assets.", name);
+
+		MeshData& mesh = result.mesh;
+		if (!MeshImporter::ImportAssimp("assets/models/" + name, mesh)) {
+			return false;
+		}
+
+		result.data.vertices = mesh.vertices.data();
+		result.data.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+		result.data.indices = mesh.indices.data();
+		result.data.indexCount = static_cast<uint32_t>(mesh.indices.size());
+		for (const MeshFileSubmesh& submesh : mesh.submeshes) {
+			result.data.submeshes.push_back(ToGeometrySubmesh(submesh));
+		}
+		result.data.boundsMin = mesh.boundsMin;
+		result.data.boundsMax = mesh.boundsMax;
+
+		auto endTime = std::chrono::high_resolution_clock::now();
+		MZ_CORE_INFO("Imported geometry {0} with Assimp ({1} vertices, {2} indices) in {3} ms", name, mesh.vertices.size(), mesh.indices.size(),
+			std::chrono::duration<float, std::chrono::milliseconds::period>(endTime - startTime).count());
+
+		return true;
+	}
+
+	Geometry* GeometrySystem::CreatePlaceholder()
+	{
+		// Unit cube with flat normals, shown wherever a geometry has not finished loading
+		static constexpr float s_faceNormals[6][3] = {
+			{ 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f },
+			{ 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f },
+			{ 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }
+		};
+
+		std::vector<Vertex3d> vertices;
+		std::vector<uint32_t> indices;
+		vertices.reserve(24);
+		indices.reserve(36);
+
+		for (const auto& faceNormal : s_faceNormals) {
+			glm::vec3 normal(faceNormal[0], faceNormal[1], faceNormal[2]);
+			// Two axes spanning the face, ordered so the winding is counter-clockwise seen from outside
+			glm::vec3 tangent = glm::abs(normal.y) > 0.5f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+			glm::vec3 bitangent = glm::cross(normal, tangent);
+
+			uint32_t base = static_cast<uint32_t>(vertices.size());
+			const glm::vec2 corners[4] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+			for (const glm::vec2& corner : corners) {
+				Vertex3d vertex{};
+				vertex.pos = 0.5f * (normal + corner.x * tangent + corner.y * bitangent);
+				vertex.color = glm::vec3(1.0f);
+				vertex.normal = normal;
+				vertex.texCoord = corner * 0.5f + 0.5f;
+				vertices.push_back(vertex);
 			}
+
+			indices.insert(indices.end(), { base, base + 1, base + 2, base + 2, base + 3, base });
 		}
+
+		m_placeholderBounds = glm::vec4(0.0f, 0.0f, 0.0f, 0.5f * glm::sqrt(3.0f));
+
+		TextureSystem& textureSystem = Application::Get().GetTextureSystem();
+		m_placeholderTexture = textureSystem.Acquire("vapor.png");
+		GeometryData data;
+		data.vertices = vertices.data();
+		data.vertexCount = static_cast<uint32_t>(vertices.size());
+		data.indices = indices.data();
+		data.indexCount = static_cast<uint32_t>(indices.size());
+		data.boundsMin = glm::vec3(-0.5f);
+		data.boundsMax = glm::vec3(0.5f);
+		return Geometry::Create(data, textureSystem.Get(m_placeholderTexture));
 	}
-}
\ No newline at end of file
+}
@@ -2,20 +2,125 @@
 
 #include "engine/src/mzpch.h"
 #include "engine/src/renderer/geometry.h"
+#include "mapped_file.h"
+#include "mesh_file.h"
 
 namespace mz {
+	struct GeometrySystemStats {
+		uint32_t geometryCount = 0;
+		// Live references across all geometries
+		uint32_t referenceCount = 0;
+		// Loads whose vertices and indices matched a geometry that was already uploaded under another name
+		uint32_t contentHits = 0;
+		// GPU buffers held by the system, and what one copy per reference would have needed on top of it
+		uint64_t residentBytes = 0;
+		uint64_t savedBytes = 0;
+		// Names resolved to the buffers of another name instead of uploading their own
+		uint32_t sharedGeometryCount = 0;
+	};
+
+	// CPU side of a loaded mesh, ready to be uploaded. Cooked meshes point into the mapped file,
+	// imported ones into the owned mesh data.
+	struct GeometryLoadResult {
+		MappedFile file;
+		MeshData mesh;
+
+		GeometryData data;
+		// Hash of the vertex, index and submesh data, identical meshes under different names share one upload
+		uint64_t contentHash = 0;
+		// Second digest of the same data under another seed. Together with contentHash it identifies
+		// imported meshes, whose CPU copy is too large to keep around for a byte compare.
+		uint64_t contentCheck = 0;
+	};
+
 	class GeometrySystem {
 	public:
 		GeometrySystem();
-		const Geometry* Acquire(std::string name);
-		void Destroy(std::string name);
+
+		// Both add a reference, pair every call with Release()
+		// Loads and uploads the geometry on the calling thread
+		GeometryHandle Acquire(std::string name);
+		// Returns immediately, the file is read and parsed on the job system and uploaded by Update()
+		GeometryHandle AcquireAsync(std::string name);
+		// Unloads the geometry once the last reference is gone, outstanding handles then resolve to the placeholder
+		void Release(GeometryHandle handle);
+
+		// Never returns null, geometries that are still loading or failed to load resolve to the placeholder
+		const Geometry* Get(GeometryHandle handle) const;
+		bool IsReady(GeometryHandle handle) const;
+		// Object space bounds, center in xyz and radius in w. Matches what Get() returns, so geometries
+		// that are not ready report the placeholder's bounds.
+		glm::vec4 GetBoundingSphere(GeometryHandle handle) const;
+		// Passes the on-screen size of one instance on to the streamer of the geometry's texture
+		void ReportCoverage(GeometryHandle handle, float screenPixels);
+
+		// Uploads finished loads, call once per frame on the main thread
+		void Update();
+
+		inline uint32_t GetGeometryCount() const { return m_geometries.Size(); }
+		GeometrySystemStats GetStats() const;
+
 		void Shutdown();
 	private:
-		std::unordered_map<std::string, Geometry*> m_geometries;
-		bool LoadObjGeometry(std::string name);
-		bool LoadGeometryAssimp(std::string name);
+		enum class GeometryState {
+			Unloaded, Pending, Ready, Failed
+		};
+
+		struct GeometryEntry {
+			std::string name;
+			Geometry* geometry = nullptr;
+			TextureHandle texture;
+			glm::vec4 boundingSphere = glm::vec4(0.0f);
+			GeometryState state = GeometryState::Unloaded;
+			uint64_t contentHash = 0;
+			uint64_t contentCheck = 0;
+			// Set when the loaded data matched the contents of another entry. The entry holds a reference
+			// to it and resolves to its geometry, texture and bounds instead of owning them.
+			GeometryHandle alias;
+			// Kept by cooked entries in m_handlesByHash, a hash match is only shared once the data compares equal.
+			// The mesh stays mapped and its pages are only read again on a match. Imported meshes are not kept,
+			// matches against them rely on the 128-bit digest instead.
+			std::unique_ptr<GeometryLoadResult> source;
+		};
+
+		struct CompletedLoad {
+			GeometryHandle handle;
+			std::unique_ptr<GeometryLoadResult> result;
+		};
+
+		// Geometries drawn with the default texture until their own has loaded
+		std::vector<GeometryHandle> m_unboundTextures;
+
+		// Upload budget per frame, at least one completed load is always uploaded
+		static constexpr size_t s_uploadBudgetBytes = 32 * 1024 * 1024;
+
+		SlotMap<GeometryEntry, Geometry> m_geometries;
+		std::unordered_map<std::string, GeometryHandle> m_handles;
+		// Ready entries that own their geometry, by content hash
+		std::unordered_map<uint64_t, GeometryHandle> m_handlesByHash;
+		uint32_t m_contentHits = 0;
+		Geometry* m_placeholder = nullptr;
+		TextureHandle m_placeholderTexture;
+		glm::vec4 m_placeholderBounds = glm::vec4(0.0f);
+
+		// Filled by the workers, drained by Update()
+		std::deque<CompletedLoad> m_completedLoads;
+		std::mutex m_completedMutex;
+
+		// Finds the entry and adds a reference, or inserts a new one
+		GeometryHandle FindOrAddEntry(const std::string& name);
+		void FinishLoad(GeometryHandle handle, GeometryEntry& entry, std::unique_ptr<GeometryLoadResult> result);
+		// Follows the alias of a ready entry to the one that owns the geometry, null unless ready
+		const GeometryEntry* Resolve(GeometryHandle handle) const;
 
-		void ProcessNode(aiNode* node, const aiScene* scene, std::vector<Vertex3d>& vertices, std::vector<uint32_t>& indices);
-		void ProcessMesh(aiMesh* mesh, const aiScene* scene, std::vector<Vertex3d>& vertices, std::vector<uint32_t>& indices);
+		// Safe to call from any thread, they only touch the file system and the manifest
+		static bool LoadGeometryData(const std::string& name, GeometryLoadResult& result);
+		static bool LoadCookedGeometry(const std::string& name, GeometryLoadResult& result);
+		static bool LoadGeometryAssimp(const std::string& name, GeometryLoadResult& result);
+		static GeometrySubmesh ToGeometrySubmesh(const MeshFileSubmesh& submesh);
+		static uint64_t HashGeometryData(const GeometryData& data, uint64_t seed);
+		static constexpr uint64_t s_contentCheckSeed = 0x9e3779b97f4a7c15ull;
+		static bool IsSameGeometryData(const GeometryData& a, const GeometryData& b);
+		Geometry* CreatePlaceholder();
 	};
-}
\ No newline at end of file
+}
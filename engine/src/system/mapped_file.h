@@ -0,0 +1,34 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+
+namespace mz {
+	// Read-only memory mapping of a whole file. Pages are faulted in by the OS on first access,
+	// so opening is cheap and the contents can be handed to upload without an intermediate copy.
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		bool Open(const std::string& filePath);
+		void Close();
+
+		inline bool IsOpen() const { return m_data != nullptr; }
+		inline const uint8_t* GetData() const { return m_data; }
+		inline size_t GetSize() const { return m_size; }
+
+	private:
+		const uint8_t* m_data = nullptr;
+		size_t m_size = 0;
+
+#ifdef _WIN32
+		void* m_fileHandle = nullptr;
+		void* m_mappingHandle = nullptr;
+#endif
+	};
+}
@@ -0,0 +1,198 @@
+#include "mesh_file.h"
+#include "engine/src/core/log.h"
+
+namespace mz {
+	static constexpr uint64_t s_meshFileBlobAlignment = 16;
+
+	static uint64_t AlignMeshFileOffset(uint64_t offset)
+	{
+		return (offset + s_meshFileBlobAlignment - 1) & ~(s_meshFileBlobAlignment - 1);
+	}
+
+	static bool IsMeshFileRangeValid(uint64_t offset, uint64_t byteSize, size_t fileSize)
+	{
+		return offset % s_meshFileBlobAlignment == 0 && offset <= fileSize && byteSize <= fileSize - offset;
+	}
+
+	// Whether every index of the range selects one of vertexCount vertices past the draw's vertex offset
+	template<typename Index>
+	static bool AreMeshFileIndicesValid(const Index* indices, uint32_t firstIndex, uint32_t indexCount, uint32_t vertexCount)
+	{
+		return std::all_of(indices + firstIndex, indices + firstIndex + indexCount,
+			[vertexCount](Index index) { return index < vertexCount; });
+	}
+
+	static bool AreMeshFileIndicesValid(const MeshFileHeader& header, const uint8_t* indices, uint32_t firstIndex, uint32_t indexCount, uint32_t vertexCount)
+	{
+		if (header.indexStride == sizeof(uint16_t)) {
+			return AreMeshFileIndicesValid(reinterpret_cast<const uint16_t*>(indices), firstIndex, indexCount, vertexCount);
+		}
+		return AreMeshFileIndicesValid(reinterpret_cast<const uint32_t*>(indices), firstIndex, indexCount, vertexCount);
+	}
+
+	bool WriteMeshFile(const std::string& filePath, const MeshData& mesh)
+	{
+		bool shortIndices = std::all_of(mesh.submeshes.begin(), mesh.submeshes.end(),
+			[](const MeshFileSubmesh& submesh) { return submesh.vertexCount <= s_maxShortIndexVertices; });
+
+		std::vector<uint16_t> shortIndexData;
+		if (shortIndices) {
+			shortIndexData.assign(mesh.indices.begin(), mesh.indices.end());
+		}
+
+		MeshFileHeader header{};
+		header.magic = s_meshFileMagic;
+		header.version = s_meshFileVersion;
+		header.vertexStride = GetVertexStride(mesh.vertexFormat);
+		header.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+		header.indexCount = static_cast<uint32_t>(mesh.indices.size());
+		header.submeshCount = static_cast<uint32_t>(mesh.submeshes.size());
+		header.boundsMin = mesh.boundsMin;
+		header.boundsMax = mesh.boundsMax;
+		header.vertexFormat = static_cast<uint32_t>(mesh.vertexFormat);
+		header.indexStride = shortIndices ? sizeof(uint16_t) : sizeof(uint32_t);
+
+		std::vector<MeshFileLod> lods = mesh.lods;
+		if (lods.empty()) {
+			lods.push_back(MeshFileLod{ 0, header.submeshCount, header.indexCount, 0.0f, 0, 0 });
+		}
+		header.lodCount = static_cast<uint32_t>(lods.size());
+		header.meshletCount = static_cast<uint32_t>(mesh.meshlets.size());
+
+		const void* vertices = mesh.vertexFormat == VertexFormat::Packed ? static_cast<const void*>(mesh.packedVertices.data()) : mesh.vertices.data();
+		if (mesh.vertexFormat == VertexFormat::Packed && mesh.packedVertices.size() != mesh.vertices.size()) {
+			MZ_CORE_ERROR("Packed vertices of {0} are out of date", filePath);
+			return false;
+		}
+
+		header.submeshOffset = AlignMeshFileOffset(sizeof(MeshFileHeader));
+		header.lodOffset = AlignMeshFileOffset(header.submeshOffset + header.submeshCount * sizeof(MeshFileSubmesh));
+		header.meshletOffset = AlignMeshFileOffset(header.lodOffset + header.lodCount * sizeof(MeshFileLod));
+		header.vertexOffset = AlignMeshFileOffset(header.meshletOffset + uint64_t(header.meshletCount) * sizeof(Meshlet));
+		header.indexOffset = AlignMeshFileOffset(header.vertexOffset + uint64_t(header.vertexCount) * header.vertexStride);
+
+		// Write next to the target and rename, so a crash never leaves a truncated file behind
+		std::string tempPath = filePath + ".tmp";
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			MZ_CORE_ERROR("Failed to open {0} for writing", tempPath);
+			return false;
+		}
+
+		auto writeBlob = [&file](uint64_t offset, const void* data, uint64_t size) {
+			// Zero padding up to the blob's aligned offset
+			static const char padding[s_meshFileBlobAlignment] = {};
+			uint64_t position = static_cast<uint64_t>(file.tellp());
+			file.write(padding, static_cast<std::streamsize>(offset - position));
+			file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+		};
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		writeBlob(header.submeshOffset, mesh.submeshes.data(), header.submeshCount * sizeof(MeshFileSubmesh));
+		writeBlob(header.lodOffset, lods.data(), header.lodCount * sizeof(MeshFileLod));
+		writeBlob(header.meshletOffset, mesh.meshlets.data(), uint64_t(header.meshletCount) * sizeof(Meshlet));
+		writeBlob(header.vertexOffset, vertices, uint64_t(header.vertexCount) * header.vertexStride);
+		const void* indices = shortIndices ? static_cast<const void*>(shortIndexData.data()) : mesh.indices.data();
+		writeBlob(header.indexOffset, indices, uint64_t(header.indexCount) * header.indexStride);
+		file.close();
+
+		if (!file) {
+			MZ_CORE_ERROR("Failed to write mesh file {0}", filePath);
+			std::remove(tempPath.c_str());
+			return false;
+		}
+
+		std::remove(filePath.c_str());
+		if (std::rename(tempPath.c_str(), filePath.c_str()) != 0) {
+			MZ_CORE_ERROR("Failed to move {0} to {1}", tempPath, filePath);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool MeshFileView::Parse(const uint8_t* data, size_t size)
+	{
+		if (size < sizeof(MeshFileHeader)) {
+			MZ_CORE_ERROR("Mesh file is too small to hold a header");
+			return false;
+		}
+
+		const MeshFileHeader* header = reinterpret_cast<const MeshFileHeader*>(data);
+
+		if (header->magic != s_meshFileMagic) {
+			MZ_CORE_ERROR("Not a mesh file");
+			return false;
+		}
+
+		if (header->version != s_meshFileVersion || header->vertexFormat >= s_vertexFormatCount
+			|| header->vertexStride != GetVertexStride(static_cast<VertexFormat>(header->vertexFormat))
+			|| (header->indexStride != sizeof(uint16_t) && header->indexStride != sizeof(uint32_t))) {
+			MZ_CORE_WARN("Mesh file version {0} (stride {1}) does not match the engine, it needs to be recooked", header->version, header->vertexStride);
+			return false;
+		}
+
+		if (header->lodCount == 0 || header->lodCount > s_maxMeshLodCount
+			|| !IsMeshFileRangeValid(header->submeshOffset, uint64_t(header->submeshCount) * sizeof(MeshFileSubmesh), size)
+			|| !IsMeshFileRangeValid(header->lodOffset, uint64_t(header->lodCount) * sizeof(MeshFileLod), size)
+			|| !IsMeshFileRangeValid(header->meshletOffset, uint64_t(header->meshletCount) * sizeof(Meshlet), size)
+			|| !IsMeshFileRangeValid(header->vertexOffset, uint64_t(header->vertexCount) * header->vertexStride, size)
+			|| !IsMeshFileRangeValid(header->indexOffset, uint64_t(header->indexCount) * header->indexStride, size)) {
+			MZ_CORE_ERROR("Mesh file is truncated or corrupt");
+			return false;
+		}
+
+		// Submeshes are drawn with their firstVertex as vertex offset, every index has to stay inside their vertex range
+		const MeshFileSubmesh* submeshes = reinterpret_cast<const MeshFileSubmesh*>(data + header->submeshOffset);
+		const uint8_t* indices = data + header->indexOffset;
+		for (uint32_t i = 0; i < header->submeshCount; ++i) {
+			const MeshFileSubmesh& submesh = submeshes[i];
+			if (uint64_t(submesh.firstIndex) + submesh.indexCount > header->indexCount
+				|| uint64_t(submesh.firstVertex) + submesh.vertexCount > header->vertexCount) {
+				MZ_CORE_ERROR("Mesh file submesh {0} references indices or vertices past the end of the mesh", i);
+				return false;
+			}
+
+			if (!AreMeshFileIndicesValid(*header, indices, submesh.firstIndex, submesh.indexCount, submesh.vertexCount)) {
+				MZ_CORE_ERROR("Mesh file submesh {0} has indices past the end of its vertex range", i);
+				return false;
+			}
+		}
+
+		const MeshFileLod* lods = reinterpret_cast<const MeshFileLod*>(data + header->lodOffset);
+		for (uint32_t i = 0; i < header->lodCount; ++i) {
+			if (lods[i].submeshCount == 0 || uint64_t(lods[i].firstSubmesh) + lods[i].submeshCount > header->submeshCount) {
+				MZ_CORE_ERROR("Mesh file LOD {0} references submeshes past the end of the table", i);
+				return false;
+			}
+
+			if (uint64_t(lods[i].firstMeshlet) + lods[i].meshletCount > header->meshletCount) {
+				MZ_CORE_ERROR("Mesh file LOD {0} references meshlets past the end of the table", i);
+				return false;
+			}
+		}
+
+		// Meshlets are drawn straight from the GPU, a bad range would read past the index buffer
+		const Meshlet* meshlets = reinterpret_cast<const Meshlet*>(data + header->meshletOffset);
+		for (uint32_t i = 0; i < header->meshletCount; ++i) {
+			if (uint64_t(meshlets[i].firstIndex) + meshlets[i].indexCount > header->indexCount || meshlets[i].firstVertex >= header->vertexCount) {
+				MZ_CORE_ERROR("Mesh file meshlet {0} references indices or vertices past the end of the mesh", i);
+				return false;
+			}
+
+			if (!AreMeshFileIndicesValid(*header, indices, meshlets[i].firstIndex, meshlets[i].indexCount, header->vertexCount - meshlets[i].firstVertex)) {
+				MZ_CORE_ERROR("Mesh file meshlet {0} has indices past the end of the mesh", i);
+				return false;
+			}
+		}
+
+		m_header = header;
+		m_submeshes = submeshes;
+		m_lods = lods;
+		m_meshlets = meshlets;
+		m_vertices = data + header->vertexOffset;
+		m_indices = indices;
+
+		return true;
+	}
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "engine/src/renderer/render_types.h"
+
+namespace mz {
+	// Cooked binary mesh (.mzmesh). Layout, all little endian:
+	//   MeshFileHeader
+	//   MeshFileSubmesh[submeshCount]
+	//   MeshFileLod[lodCount]   (16 byte aligned)
+	//   Meshlet[meshletCount]   (16 byte aligned)
+	//   Vertex3d or PackedVertex3d[vertexCount], see vertexFormat   (16 byte aligned)
+	//   uint16_t or uint32_t[indexCount], see indexStride   (16 byte aligned)
+	// Blobs are stored exactly as the renderer consumes them so a mapped file can be uploaded as is.
+	// Indices are local to their submesh, each submesh is drawn with its firstVertex as vertex offset.
+	// That keeps them in 16 bits whenever no submesh has more than s_maxShortIndexVertices vertices.
+	// LODs are consecutive runs of the submesh table, finest first. A coarser submesh draws its own index
+	// range over the vertex range of the matching submesh of LOD 0.
+	// Meshes above a size threshold also carry meshlets, every LOD owns a consecutive run of the meshlet table
+	// that covers the index ranges of its submeshes.
+	static constexpr uint32_t s_meshFileMagic = 0x534D5A4D; // "MZMS"
+	static constexpr uint32_t s_meshFileVersion = 6;
+	static constexpr uint32_t s_maxShortIndexVertices = 65536;
+	static constexpr uint32_t s_maxMeshLodCount = 5;
+
+	struct MeshFileSubmesh {
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		uint32_t firstVertex;
+		uint32_t vertexCount;
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		// Dense index into the source's materials in order of first use, submeshes are sorted by it
+		uint32_t materialSlot;
+	};
+
+	struct MeshFileLod {
+		uint32_t firstSubmesh;
+		uint32_t submeshCount;
+		// Summed over the LOD's submeshes
+		uint32_t indexCount;
+		// Object space distance the simplified surface may deviate from LOD 0, zero for LOD 0
+		float error;
+		// Both zero when the mesh has no meshlets
+		uint32_t firstMeshlet;
+		uint32_t meshletCount;
+	};
+
+	struct MeshFileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t vertexStride;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t submeshCount;
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		// VertexFormat, packed positions are relative to the bounds above
+		uint32_t vertexFormat;
+		// 2 or 4 bytes
+		uint32_t indexStride;
+		uint64_t submeshOffset;
+		uint64_t vertexOffset;
+		uint64_t indexOffset;
+		uint64_t lodOffset;
+		// At least one, LOD 0 covers the submeshes of the source mesh
+		uint32_t lodCount;
+		uint32_t meshletCount;
+		uint64_t meshletOffset;
+	};
+
+	static_assert(sizeof(MeshFileSubmesh) == 44, "MeshFileSubmesh layout is part of the file format");
+	static_assert(sizeof(MeshFileLod) == 24, "MeshFileLod layout is part of the file format");
+	static_assert(sizeof(MeshFileHeader) == 104, "MeshFileHeader layout is part of the file format");
+	static_assert(sizeof(Meshlet) == 48, "Meshlet layout is part of the file format, bump s_meshFileVersion when changing it");
+	static_assert(sizeof(Vertex3d) == 44, "Vertex3d layout is part of the file format, bump s_meshFileVersion when changing it");
+	static_assert(sizeof(PackedVertex3d) == 20, "PackedVertex3d layout is part of the file format, bump s_meshFileVersion when changing it");
+
+	// CPU side mesh as produced by importers, input to the cooker
+	struct MeshData {
+		std::vector<Vertex3d> vertices;
+		// Written instead of vertices when vertexFormat is Packed, filled by the cooker after all other passes
+		std::vector<PackedVertex3d> packedVertices;
+		VertexFormat vertexFormat = VertexFormat::Float;
+		// Local to the submesh, see above
+		std::vector<uint32_t> indices;
+		// Holds the submeshes of every LOD
+		std::vector<MeshFileSubmesh> submeshes;
+		// Empty is written as a single LOD over all submeshes
+		std::vector<MeshFileLod> lods;
+		// Referenced by the LODs, may be empty
+		std::vector<Meshlet> meshlets;
+		glm::vec3 boundsMin = glm::vec3(0.0f);
+		glm::vec3 boundsMax = glm::vec3(0.0f);
+	};
+
+	bool WriteMeshFile(const std::string& filePath, const MeshData& mesh);
+
+	// Validated, zero-copy view over the bytes of a cooked mesh
+	class MeshFileView {
+	public:
+		bool Parse(const uint8_t* data, size_t size);
+
+		inline const MeshFileHeader& GetHeader() const { return *m_header; }
+		inline const MeshFileSubmesh* GetSubmeshes() const { return m_submeshes; }
+		inline const MeshFileLod* GetLods() const { return m_lods; }
+		inline const Meshlet* GetMeshlets() const { return m_meshlets; }
+		inline VertexFormat GetVertexFormat() const { return static_cast<VertexFormat>(m_header->vertexFormat); }
+		// Vertex3d or PackedVertex3d depending on GetVertexFormat()
+		inline const void* GetVertices() const { return m_vertices; }
+		// uint16_t or uint32_t depending on the header's indexStride
+		inline const void* GetIndices() const { return m_indices; }
+
+	private:
+		const MeshFileHeader* m_header = nullptr;
+		const MeshFileSubmesh* m_submeshes = nullptr;
+		const MeshFileLod* m_lods = nullptr;
+		const Meshlet* m_meshlets = nullptr;
+		const void* m_vertices = nullptr;
+		const void* m_indices = nullptr;
+	};
+}
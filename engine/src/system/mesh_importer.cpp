@@ -0,0 +1,134 @@
+#include "mesh_importer.h"
+#include "engine/src/core/log.h"
+
+namespace mz {
+	bool MeshImporter::ImportAssimp(const std::string& filePath, MeshData& outMesh)
+	{
+		Assimp::Importer importer;
+		const aiScene* scene = importer.ReadFile(filePath, aiProcess_Triangulate | aiProcess_FlipUVs);
+
+		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+			MZ_CORE_ERROR("Assimp failed to load {0}, error: {1}", filePath, importer.GetErrorString());
+			return false;
+		}
+
+		MaterialSlots materialSlots;
+		materialSlots.slots.assign(scene->mNumMaterials, std::numeric_limits<uint32_t>::max());
+		ProcessNode(scene->mRootNode, scene, aiMatrix4x4(), materialSlots, outMesh);
+
+		// Submeshes sharing a material end up next to each other, ranges are unaffected
+		std::stable_sort(outMesh.submeshes.begin(), outMesh.submeshes.end(),
+			[](const MeshFileSubmesh& a, const MeshFileSubmesh& b) { return a.materialSlot < b.materialSlot; });
+
+		if (!outMesh.submeshes.empty()) {
+			outMesh.boundsMin = outMesh.submeshes[0].boundsMin;
+			outMesh.boundsMax = outMesh.submeshes[0].boundsMax;
+			for (const MeshFileSubmesh& submesh : outMesh.submeshes) {
+				outMesh.boundsMin = glm::min(outMesh.boundsMin, submesh.boundsMin);
+				outMesh.boundsMax = glm::max(outMesh.boundsMax, submesh.boundsMax);
+			}
+		}
+
+		return true;
+	}
+
+	void MeshImporter::ProcessNode(aiNode* node, const aiScene* scene, const aiMatrix4x4& parentTransform, MaterialSlots& materialSlots, MeshData& mesh)
+	{
+		aiMatrix4x4 transform = parentTransform * node->mTransformation;
+
+		// Meshes referenced by several nodes are baked once per reference
+		for (unsigned int i = 0; i < node->mNumMeshes; ++i) {
+			ProcessMesh(scene->mMeshes[node->mMeshes[i]], transform, materialSlots, mesh);
+		}
+
+		for (unsigned int i = 0; i < node->mNumChildren; ++i) {
+			ProcessNode(node->mChildren[i], scene, transform, materialSlots, mesh);
+		}
+	}
+
+	void MeshImporter::ProcessMesh(aiMesh* mesh, const aiMatrix4x4& transform, MaterialSlots& materialSlots, MeshData& meshData)
+	{
+		std::vector<Vertex3d>& vertices = meshData.vertices;
+		std::vector<uint32_t>& indices = meshData.indices;
+
+		uint32_t& materialSlot = materialSlots.slots[mesh->mMaterialIndex];
+		if (materialSlot == std::numeric_limits<uint32_t>::max()) {
+			materialSlot = materialSlots.count++;
+		}
+
+		MeshFileSubmesh submesh{};
+		submesh.firstVertex = static_cast<uint32_t>(vertices.size());
+		submesh.firstIndex = static_cast<uint32_t>(indices.size());
+		submesh.materialSlot = materialSlot;
+		// The importer's bounding box is in mesh space, these are grown from the baked positions
+		submesh.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+		submesh.boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+
+		aiMatrix3x3 normalMatrix = aiMatrix3x3(transform);
+		// Mirroring transforms turn the winding around, the triangles are flipped back below
+		bool mirrored = normalMatrix.Determinant() < 0.0f;
+		normalMatrix.Inverse().Transpose();
+
+		vertices.reserve(vertices.size() + mesh->mNumVertices);
+		indices.reserve(indices.size() + mesh->mNumFaces * 3);
+
+		// Most formats store one vertex per face corner, identical corners are welded into one vertex
+		VertexDeduplicator<Vertex3d> deduplicator(vertices, mesh->mNumVertices);
+		std::vector<uint32_t> remap(mesh->mNumVertices);
+
+		for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
+			Vertex3d vertex{};
+			aiVector3D position = transform * mesh->mVertices[i];
+			vertex.pos = {
+				position.x,
+				position.y,
+				position.z
+			};
+			submesh.boundsMin = glm::min(submesh.boundsMin, vertex.pos);
+			submesh.boundsMax = glm::max(submesh.boundsMax, vertex.pos);
+
+			if (mesh->HasVertexColors(0)) {
+				vertex.color = {
+					mesh->mColors[0][i].r,
+					mesh->mColors[0][i].g,
+					mesh->mColors[0][i].b
+				};
+			}
+
+			if (mesh->HasNormals()) {
+				aiVector3D normal = (normalMatrix * mesh->mNormals[i]).NormalizeSafe();
+				vertex.normal = {
+					normal.x,
+					normal.y,
+					normal.z
+				};
+			}
+
+			if (mesh->HasTextureCoords(0)) {
+				vertex.texCoord = {
+					mesh->mTextureCoords[0][i].x,
+					mesh->mTextureCoords[0][i].y
+				};
+			}
+
+			remap[i] = deduplicator.Add(vertex);
+		}
+
+		submesh.vertexCount = deduplicator.GetUniqueCount();
+
+		// Face indices are local to the aiMesh, the remap turns them into submesh local ones
+		for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
+			const aiFace& face = mesh->mFaces[i];
+			for (unsigned int j = 0; j < face.mNumIndices; ++j) {
+				indices.push_back(remap[face.mIndices[mirrored ? face.mNumIndices - 1 - j : j]]);
+			}
+		}
+
+		if (mesh->mNumVertices == 0) {
+			submesh.boundsMin = submesh.boundsMax = glm::vec3(0.0f);
+		}
+
+		submesh.indexCount = static_cast<uint32_t>(indices.size()) - submesh.firstIndex;
+		meshData.submeshes.push_back(submesh);
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "mesh_file.h"
+#include "vertex_deduplicator.h"
+
+namespace mz {
+	// Converts source meshes into the cooked in-memory layout.
+	// Shared by the runtime fallback path and the offline cooker.
+	class MeshImporter {
+	public:
+		static bool ImportAssimp(const std::string& filePath, MeshData& outMesh);
+	private:
+		// Source material index to slot, slots are handed out in order of first use
+		struct MaterialSlots {
+			std::vector<uint32_t> slots;
+			uint32_t count = 0;
+		};
+
+		static void ProcessNode(aiNode* node, const aiScene* scene, const aiMatrix4x4& parentTransform, MaterialSlots& materialSlots, MeshData& mesh);
+		// Bakes the node's world transform into the vertices, the geometry is drawn with the entity's transform alone
+		static void ProcessMesh(aiMesh* mesh, const aiMatrix4x4& transform, MaterialSlots& materialSlots, MeshData& meshData);
+	};
+}
@@ -28,10 +28,26 @@ namespace mz {
 		glm::vec3 Rotation = { 0.0f, 0.0f, 0.0f };
 		glm::vec3 Scale = { 1.0f, 1.0f, 1.0f };
 
+		// Cached matrices, refreshed by TransformHierarchy::Update only when something changed
+		glm::mat4 LocalTransform = glm::mat4(1.0f);
+		glm::mat4 WorldTransform = glm::mat4(1.0f);
+
+		// Set when Translation, Rotation or Scale changed since the last update.
+		// Call MarkDirty() after writing the fields directly instead of using the setters.
+		bool Dirty = true;
+
 		Transform3dComponent() = default;
 		Transform3dComponent(const Transform3dComponent&) = default;
 		Transform3dComponent(const glm::vec3& translation) : Translation(translation) {}
 
+		inline void SetTranslation(const glm::vec3& translation) { Translation = translation; Dirty = true; }
+		inline void SetRotation(const glm::vec3& rotation) { Rotation = rotation; Dirty = true; }
+		inline void SetScale(const glm::vec3& scale) { Scale = scale; Dirty = true; }
+		inline void MarkDirty() { Dirty = true; }
+
+		inline const glm::mat4& GetWorldTransform() const { return WorldTransform; }
+
+		// Composes the local matrix from translation, rotation and scale
 		glm::mat4 GetTransform() const
 		{
 			glm::mat4 rotation = glm::toMat4(glm::quat(Rotation));
@@ -42,9 +58,37 @@ namespace mz {
 		}
 	};
 
+	// Parent/child links stored as an intrusive linked list, so reparenting never allocates
+	struct HierarchyComponent
+	{
+		entt::entity Parent = entt::null;
+		entt::entity FirstChild = entt::null;
+		entt::entity PrevSibling = entt::null;
+		entt::entity NextSibling = entt::null;
+
+		// Distance from the root, used to keep the storage sorted breadth-first
+		uint32_t Depth = 0;
+
+		// World matrix the node passes on to its children: its own world transform, or the inherited one when it
+		// has no Transform3dComponent. Refreshed by TransformHierarchy::Update.
+		glm::mat4 WorldTransform = glm::mat4(1.0f);
+		// Set by the transform update when WorldTransform changed this frame
+		bool WorldChanged = false;
+		// Set when the node was attached, detached or lost its transform, its subtree is recomputed on the next update
+		bool ParentChanged = true;
+
+		HierarchyComponent() = default;
+		HierarchyComponent(const HierarchyComponent&) = default;
+	};
+
 	struct GeometryRendererComponent
 	{
-		const Geometry* geometry;
+		// Owns the reference it was acquired with, the scene releases it when the component is destroyed or the
+		// handle replaced
+		GeometryHandle geometry;
+		// Guards the draws with a hardware occlusion query of the geometry's bounds, they are skipped while the
+		// last finished query found the bounds hidden. Worth it for expensive meshes that are often covered.
+		bool occlusionQuery = false;
 
 		GeometryRendererComponent() = default;
 		GeometryRendererComponent(const GeometryRendererComponent&) = default;
@@ -28,6 +28,13 @@ namespace mz {
 			return m_scene->m_registry.get<T>(m_entityHandle);
 		}
 
+		// Modifies a component in place and notifies the scene, e.g. to swap the geometry of a renderer
+		template<typename T, typename Func>
+		T& PatchComponent(Func&& func) {
+			MZ_ASSERT(HasComponent<T>(), "Entity does not contain component!");
+			return m_scene->m_registry.patch<T>(m_entityHandle, std::forward<Func>(func));
+		}
+
 		template<typename T>
 		void RemoveComponent()
 		{
@@ -37,6 +44,14 @@ namespace mz {
 
 		UUID GetUUID() { return GetComponent<IDComponent>().id; }
 
+		void SetParent(Entity parent) { m_scene->SetParent(*this, parent); }
+		void RemoveParent() { m_scene->SetParent(*this, Entity()); }
+
+		Entity GetParent()
+		{
+			return { GetComponent<HierarchyComponent>().Parent, m_scene };
+		}
+
 		operator bool() const { return m_entityHandle != entt::null; }
 		operator entt::entity() const { return m_entityHandle; }
 		operator uint32_t() const { return (uint32_t)m_entityHandle; }
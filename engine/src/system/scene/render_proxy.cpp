@@ -0,0 +1,161 @@
+#include "render_proxy.h"
+
+namespace mz {
+	void RenderProxyList::Add(entt::entity entity, GeometryHandle geometry, const glm::mat4& model)
+	{
+		if (Contains(entity)) {
+			SetGeometry(entity, geometry);
+			SetTransform(entity, model);
+			return;
+		}
+
+		auto entityIndex = entt::to_entity(entity);
+		if (entityIndex >= m_sparse.size()) {
+			m_sparse.resize(entityIndex + 1, s_invalidIndex);
+		}
+
+		uint32_t index = static_cast<uint32_t>(m_entities.size());
+		m_sparse[entityIndex] = index;
+		m_entities.push_back(entity);
+		m_geometries.push_back(geometry);
+		m_lods.push_back(0);
+		m_occlusionQueries.push_back(0);
+		m_resolvedGeometries.push_back(nullptr);
+		m_transforms.push_back(model);
+		MarkDirty(index);
+	}
+
+	void RenderProxyList::Remove(entt::entity entity)
+	{
+		uint32_t index = IndexOf(entity);
+		if (index == s_invalidIndex) {
+			return;
+		}
+
+		// Swap with the last record to keep the arrays dense
+		uint32_t last = Size() - 1;
+		if (index != last) {
+			m_entities[index] = m_entities[last];
+			m_geometries[index] = m_geometries[last];
+			m_lods[index] = m_lods[last];
+			m_occlusionQueries[index] = m_occlusionQueries[last];
+			m_resolvedGeometries[index] = m_resolvedGeometries[last];
+			m_transforms[index] = m_transforms[last];
+			m_sparse[entt::to_entity(m_entities[index])] = index;
+			MarkDirty(index);
+		}
+
+		m_entities.pop_back();
+		m_geometries.pop_back();
+		m_lods.pop_back();
+		m_occlusionQueries.pop_back();
+		m_resolvedGeometries.pop_back();
+		m_transforms.pop_back();
+		m_sparse[entt::to_entity(entity)] = s_invalidIndex;
+	}
+
+	bool RenderProxyList::Contains(entt::entity entity) const
+	{
+		return IndexOf(entity) != s_invalidIndex;
+	}
+
+	void RenderProxyList::SetGeometry(entt::entity entity, GeometryHandle geometry)
+	{
+		uint32_t index = IndexOf(entity);
+		if (index != s_invalidIndex) {
+			m_geometries[index] = geometry;
+			m_lods[index] = 0;
+
+			// Results for the previous geometry's bounds say nothing about the new one
+			if (m_occlusionQueries[index] != 0) {
+				m_occlusionQueries[index] = NextOcclusionQueryKey();
+			}
+		}
+	}
+
+	void RenderProxyList::SetTransform(entt::entity entity, const glm::mat4& model)
+	{
+		uint32_t index = IndexOf(entity);
+		if (index != s_invalidIndex) {
+			m_transforms[index] = model;
+			MarkDirty(index);
+		}
+	}
+
+	void RenderProxyList::SetOcclusionQuery(entt::entity entity, bool enabled)
+	{
+		uint32_t index = IndexOf(entity);
+		if (index == s_invalidIndex) {
+			return;
+		}
+
+		if (!enabled) {
+			m_occlusionQueries[index] = 0;
+		}
+		else if (m_occlusionQueries[index] == 0) {
+			m_occlusionQueries[index] = NextOcclusionQueryKey();
+		}
+	}
+
+	void RenderProxyList::SetResolvedGeometries(const Geometry* const* geometries)
+	{
+		for (uint32_t i = 0; i < Size(); ++i) {
+			if (m_resolvedGeometries[i] == geometries[i]) {
+				continue;
+			}
+
+			// The handle is unchanged but its bounds are not, results made for the placeholder must not hide the mesh
+			if (m_occlusionQueries[i] != 0 && m_resolvedGeometries[i]) {
+				m_occlusionQueries[i] = NextOcclusionQueryKey();
+			}
+			m_resolvedGeometries[i] = geometries[i];
+		}
+	}
+
+	void RenderProxyList::ClearDirty()
+	{
+		for (uint32_t index : m_dirtyIndices) {
+			m_dirtyFlags[index] = 0;
+		}
+		m_dirtyIndices.clear();
+	}
+
+	uint32_t RenderProxyList::IndexOf(entt::entity entity) const
+	{
+		auto entityIndex = entt::to_entity(entity);
+		if (entityIndex >= m_sparse.size()) {
+			return s_invalidIndex;
+		}
+
+		uint32_t index = m_sparse[entityIndex];
+
+		// Entity indices are recycled, so the stored entity must match including its version
+		if (index == s_invalidIndex || m_entities[index] != entity) {
+			return s_invalidIndex;
+		}
+
+		return index;
+	}
+
+	void RenderProxyList::MarkDirty(uint32_t index)
+	{
+		if (index >= m_dirtyFlags.size()) {
+			m_dirtyFlags.resize(std::max<size_t>(index + 1, m_dirtyFlags.size() * 2), 0);
+		}
+
+		if (!m_dirtyFlags[index]) {
+			m_dirtyFlags[index] = 1;
+			m_dirtyIndices.push_back(index);
+		}
+	}
+
+	uint32_t RenderProxyList::NextOcclusionQueryKey()
+	{
+		// Zero marks unguarded proxies, skip it when the counter wraps
+		uint32_t key = m_nextOcclusionQueryKey++;
+		if (m_nextOcclusionQueryKey == 0) {
+			m_nextOcclusionQueryKey = 1;
+		}
+		return key;
+	}
+}
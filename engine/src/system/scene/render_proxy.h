@@ -0,0 +1,67 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "engine/src/renderer/geometry.h"
+
+namespace mz {
+	// Persistent, densely packed list of everything the renderer draws.
+	// Records are added, updated and removed by the scene as components change,
+	// so nothing has to be rebuilt per frame. Transforms are stored contiguously
+	// in the layout of a GPU object buffer so they can be mirrored directly.
+	class RenderProxyList {
+	public:
+		void Add(entt::entity entity, GeometryHandle geometry, const glm::mat4& model);
+		void Remove(entt::entity entity);
+		bool Contains(entt::entity entity) const;
+
+		void SetGeometry(entt::entity entity, GeometryHandle geometry);
+		void SetTransform(entt::entity entity, const glm::mat4& model);
+		// Guarding a proxy, or changing the geometry of a guarded one, gives it a new occlusion query key
+		void SetOcclusionQuery(entt::entity entity, bool enabled);
+		// Takes the geometry every proxy's handle resolves to this frame. Guarded proxies whose handle resolves to
+		// another geometry than last frame, such as a loaded mesh replacing the placeholder, get a new key too.
+		void SetResolvedGeometries(const Geometry* const* geometries);
+
+		inline uint32_t Size() const { return static_cast<uint32_t>(m_entities.size()); }
+		inline const glm::mat4* GetTransforms() const { return m_transforms.data(); }
+		inline const GeometryHandle* GetGeometries() const { return m_geometries.data(); }
+		// LOD each proxy was last drawn with, kept across frames so the selection can hold on to it
+		inline uint8_t* GetLods() { return m_lods.data(); }
+		inline const uint8_t* GetLods() const { return m_lods.data(); }
+		// Occlusion query key per proxy, zero for unguarded ones. Keys are never reused by another proxy, so query
+		// results made for one never apply to whoever takes its slot over.
+		inline const uint32_t* GetOcclusionQueries() const { return m_occlusionQueries.data(); }
+
+		// Proxy indices whose GPU record is stale, each listed once.
+		// May contain indices past Size() after removals, consumers skip those.
+		inline const uint32_t* GetDirtyIndices() const { return m_dirtyIndices.data(); }
+		inline uint32_t GetDirtyCount() const { return static_cast<uint32_t>(m_dirtyIndices.size()); }
+		// Call once the dirty records have been uploaded
+		void ClearDirty();
+
+	private:
+		static constexpr uint32_t s_invalidIndex = std::numeric_limits<uint32_t>::max();
+
+		// Dense arrays, all indexed by proxy index. The proxy index doubles as the object's slot in the GPU object buffer.
+		std::vector<glm::mat4> m_transforms;
+		std::vector<GeometryHandle> m_geometries;
+		std::vector<uint8_t> m_lods;
+		std::vector<uint32_t> m_occlusionQueries;
+		std::vector<const Geometry*> m_resolvedGeometries;
+		std::vector<entt::entity> m_entities;
+
+		// Entity index to proxy index
+		std::vector<uint32_t> m_sparse;
+
+		// Change list feeding the delta upload, the flags keep it free of duplicates.
+		// Flags are indexed by proxy index and never shrink.
+		std::vector<uint32_t> m_dirtyIndices;
+		std::vector<uint8_t> m_dirtyFlags;
+
+		uint32_t m_nextOcclusionQueryKey = 1;
+
+		uint32_t IndexOf(entt::entity entity) const;
+		void MarkDirty(uint32_t index);
+		uint32_t NextOcclusionQueryKey();
+	};
+}
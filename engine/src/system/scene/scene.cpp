@@ -1,52 +1,343 @@
 #include "scene.h"
 #include "entity.h"
+#include "components.h"
 #include "engine/src/renderer/render_api.h"
+#include "engine/src/renderer/frustum.h"
 
 namespace mz {
 	Scene::Scene()
 	{
+#ifdef MZ_DEBUG
+		static const bool s_transformKernelsValid = TransformBatch::ValidateKernels();
+		MZ_ASSERT_MSG(s_transformKernelsValid, "Transform kernels do not match the glm reference!");
+#endif
+
+		// Render proxies follow the components, so extraction never walks the whole scene
+		m_registry.on_construct<GeometryRendererComponent>().connect<&Scene::OnGeometryRendererConstruct>(*this);
+		m_registry.on_construct<Transform3dComponent>().connect<&Scene::OnRenderableConstruct>(*this);
+		m_registry.on_destroy<GeometryRendererComponent>().connect<&Scene::OnGeometryRendererDestroy>(*this);
+		m_registry.on_destroy<Transform3dComponent>().connect<&Scene::OnTransformDestroy>(*this);
+		m_registry.on_update<GeometryRendererComponent>().connect<&Scene::OnGeometryRendererUpdate>(*this);
+		m_registry.on_update<Transform3dComponent>().connect<&Scene::OnTransformUpdate>(*this);
 	}
 	Scene::~Scene()
 	{
+		// The registry destroys its components without signals, their references are given back here
+		GeometrySystem& geometrySystem = Application::Get().GetGeometrySystem();
+		for (const auto& [entity, geometry] : m_geometryReferences) {
+			if (geometry.IsValid()) {
+				geometrySystem.Release(geometry);
+			}
+		}
+		m_geometryReferences.clear();
+
+		m_registry.on_construct<GeometryRendererComponent>().disconnect(*this);
+		m_registry.on_construct<Transform3dComponent>().disconnect(*this);
+		m_registry.on_destroy<GeometryRendererComponent>().disconnect(*this);
+		m_registry.on_destroy<Transform3dComponent>().disconnect(*this);
+		m_registry.on_update<GeometryRendererComponent>().disconnect(*this);
+		m_registry.on_update<Transform3dComponent>().disconnect(*this);
 	}
-	
+
 	Entity Scene::CreateEntity(const std::string& name)
 	{
 		return CreateEntityWithUUID(UUID(), name);
 	}
-	
+
 	Entity Scene::CreateEntityWithUUID(UUID uuid, const std::string& name)
 	{
 		Entity entity = { m_registry.create(), this };
 		entity.AddComponent<IDComponent>(uuid);
+		entity.AddComponent<HierarchyComponent>();
 		auto& tag = entity.AddComponent<TagComponent>();
 		tag.Tag = name.empty() ? "Entity" : name;
 
 		m_entityMap[uuid] = entity;
+		m_hierarchyOrderDirty = true;
 
 		return entity;
 	}
-	
+
 	void Scene::DestroyEntity(Entity entity)
 	{
+		// Children are destroyed together with their parent. Components may move in storage
+		// when a child is destroyed, so the parent is looked up again on every iteration.
+		entt::entity child;
+		while ((child = m_registry.get<HierarchyComponent>(entity).FirstChild) != entt::null) {
+			DestroyEntity({ child, this });
+		}
+
+		DetachFromParent(entity);
+
 		m_entityMap.erase(entity.GetUUID());
 		m_registry.destroy(entity);
+
+		// Removal swaps the last element into the freed slot, which breaks the breadth-first order
+		m_hierarchyOrderDirty = true;
+	}
+
+	void Scene::SetParent(Entity child, Entity parent)
+	{
+		entt::entity childHandle = child;
+		entt::entity parentHandle = parent;
+
+		MZ_ASSERT_MSG(childHandle != parentHandle, "Entity cannot be its own parent!");
+		MZ_ASSERT_MSG(parentHandle == entt::null || !IsDescendantOf(parentHandle, childHandle), "Parenting would create a cycle in the hierarchy!");
+
+		DetachFromParent(childHandle);
+
+		uint32_t depth = 0;
+		if (parentHandle != entt::null) {
+			auto& parentHierarchy = m_registry.get<HierarchyComponent>(parentHandle);
+			auto& childHierarchy = m_registry.get<HierarchyComponent>(childHandle);
+
+			childHierarchy.Parent = parentHandle;
+			childHierarchy.NextSibling = parentHierarchy.FirstChild;
+			if (parentHierarchy.FirstChild != entt::null) {
+				m_registry.get<HierarchyComponent>(parentHierarchy.FirstChild).PrevSibling = childHandle;
+			}
+			parentHierarchy.FirstChild = childHandle;
+
+			depth = parentHierarchy.Depth + 1;
+		}
+
+		UpdateSubtreeDepth(childHandle, depth);
+
+		// World matrix now depends on a different parent, with or without a transform of its own
+		m_registry.get<HierarchyComponent>(childHandle).ParentChanged = true;
+
+		m_hierarchyOrderDirty = true;
+	}
+
+	void Scene::DetachFromParent(entt::entity entity)
+	{
+		auto& hierarchy = m_registry.get<HierarchyComponent>(entity);
+
+		if (hierarchy.Parent == entt::null) {
+			return;
+		}
+
+		if (hierarchy.PrevSibling != entt::null) {
+			m_registry.get<HierarchyComponent>(hierarchy.PrevSibling).NextSibling = hierarchy.NextSibling;
+		}
+		else {
+			m_registry.get<HierarchyComponent>(hierarchy.Parent).FirstChild = hierarchy.NextSibling;
+		}
+
+		if (hierarchy.NextSibling != entt::null) {
+			m_registry.get<HierarchyComponent>(hierarchy.NextSibling).PrevSibling = hierarchy.PrevSibling;
+		}
+
+		hierarchy.Parent = entt::null;
+		hierarchy.PrevSibling = entt::null;
+		hierarchy.NextSibling = entt::null;
+	}
+
+	void Scene::UpdateSubtreeDepth(entt::entity entity, uint32_t depth)
+	{
+		auto& hierarchy = m_registry.get<HierarchyComponent>(entity);
+		hierarchy.Depth = depth;
+
+		for (entt::entity child = hierarchy.FirstChild; child != entt::null; child = m_registry.get<HierarchyComponent>(child).NextSibling) {
+			UpdateSubtreeDepth(child, depth + 1);
+		}
+	}
+
+	bool Scene::IsDescendantOf(entt::entity entity, entt::entity ancestor)
+	{
+		for (entt::entity current = m_registry.get<HierarchyComponent>(entity).Parent; current != entt::null; current = m_registry.get<HierarchyComponent>(current).Parent) {
+			if (current == ancestor) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void Scene::UpdateTransforms()
+	{
+		if (m_hierarchyOrderDirty) {
+			TransformHierarchy::SortByDepth(m_registry);
+			m_hierarchyOrderDirty = false;
+		}
+
+		TransformHierarchy::Update(m_registry, m_transformBatch, Application::Get().GetFrameAllocator(), m_renderProxies);
+	}
+
+	void Scene::OnRenderableConstruct(entt::registry& registry, entt::entity entity)
+	{
+		if (!registry.all_of<Transform3dComponent, GeometryRendererComponent>(entity)) {
+			return;
+		}
+
+		const auto& transform = registry.get<Transform3dComponent>(entity);
+		const auto& geometry = registry.get<GeometryRendererComponent>(entity);
+		m_renderProxies.Add(entity, geometry.geometry, transform.WorldTransform);
+		m_renderProxies.SetOcclusionQuery(entity, geometry.occlusionQuery);
 	}
-	
+
+	void Scene::OnRenderableDestroy(entt::registry& registry, entt::entity entity)
+	{
+		m_renderProxies.Remove(entity);
+	}
+
+	void Scene::OnTransformDestroy(entt::registry& registry, entt::entity entity)
+	{
+		OnRenderableDestroy(registry, entity);
+
+		// Children inherit the parent's matrix through this node from now on
+		if (auto* hierarchy = registry.try_get<HierarchyComponent>(entity)) {
+			hierarchy->ParentChanged = true;
+		}
+	}
+
+	void Scene::OnGeometryRendererConstruct(entt::registry& registry, entt::entity entity)
+	{
+		// The component takes over the reference its handle was acquired with
+		m_geometryReferences[entity] = registry.get<GeometryRendererComponent>(entity).geometry;
+		OnRenderableConstruct(registry, entity);
+	}
+
+	void Scene::OnGeometryRendererDestroy(entt::registry& registry, entt::entity entity)
+	{
+		OnRenderableDestroy(registry, entity);
+
+		auto it = m_geometryReferences.find(entity);
+		if (it != m_geometryReferences.end()) {
+			if (it->second.IsValid()) {
+				Application::Get().GetGeometrySystem().Release(it->second);
+			}
+			m_geometryReferences.erase(it);
+		}
+	}
+
+	void Scene::OnGeometryRendererUpdate(entt::registry& registry, entt::entity entity)
+	{
+		const auto& geometry = registry.get<GeometryRendererComponent>(entity);
+
+		// A replaced handle gives up the previous one, patching other fields keeps the reference as it is
+		GeometryHandle& reference = m_geometryReferences[entity];
+		if (reference != geometry.geometry) {
+			if (reference.IsValid()) {
+				Application::Get().GetGeometrySystem().Release(reference);
+			}
+			reference = geometry.geometry;
+		}
+
+		m_renderProxies.SetGeometry(entity, geometry.geometry);
+		m_renderProxies.SetOcclusionQuery(entity, geometry.occlusionQuery);
+	}
+
+	void Scene::OnTransformUpdate(entt::registry& registry, entt::entity entity)
+	{
+		// Replaced or patched transforms are picked up by the next transform update
+		registry.get<Transform3dComponent>(entity).MarkDirty();
+	}
+
 	void Scene::OnGraphicsUpdate()
 	{
+		UpdateTransforms();
+
+		float pixelsPerUnit;
+		const ProxyProjection* projections = ProjectProxies(pixelsPerUnit);
+		ReportTextureCoverage(projections, pixelsPerUnit);
+
+		// Handles are resolved every frame, so geometries that finished loading replace their placeholder
+		uint32_t count = m_renderProxies.Size();
+		const GeometrySystem& geometrySystem = Application::Get().GetGeometrySystem();
+		const GeometryHandle* handles = m_renderProxies.GetGeometries();
+		const Geometry** geometries = Application::Get().GetFrameAllocator().AllocateArray<const Geometry*>(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			geometries[i] = geometrySystem.Get(handles[i]);
+		}
+		m_renderProxies.SetResolvedGeometries(geometries);
+		SelectLods(geometries, projections, pixelsPerUnit);
+
 		RenderApiDrawCallArgs drawArgs;
+		drawArgs.transforms = m_renderProxies.GetTransforms();
+		drawArgs.geometries = geometries;
+		drawArgs.lods = m_renderProxies.GetLods();
+		drawArgs.occlusionQueries = m_renderProxies.GetOcclusionQueries();
+		drawArgs.count = count;
+		drawArgs.dirtyIndices = m_renderProxies.GetDirtyIndices();
+		drawArgs.dirtyCount = m_renderProxies.GetDirtyCount();
+
+		// Skipped frames did not upload anything, keep the changes for the next one
+		if (Application::Get().GetRenderApi().DrawFrame(drawArgs)) {
+			m_renderProxies.ClearDirty();
+		}
+	}
+
+	const Scene::ProxyProjection* Scene::ProjectProxies(float& outPixelsPerUnit)
+	{
+		const PerspectiveCamera& camera = Application::Get().GetRenderApi().GetCamera();
+		float viewportHeight = static_cast<float>(Application::Get().GetWindow().GetFramebufferHeight());
+		outPixelsPerUnit = viewportHeight / (2.0f * glm::tan(glm::radians(camera.GetFOV()) * 0.5f));
+
+		const GeometrySystem& geometrySystem = Application::Get().GetGeometrySystem();
+		const GeometryHandle* handles = m_renderProxies.GetGeometries();
+		const glm::mat4* transforms = m_renderProxies.GetTransforms();
+
+		uint32_t count = m_renderProxies.Size();
+		ProxyProjection* projections = Application::Get().GetFrameAllocator().AllocateArray<ProxyProjection>(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			glm::vec4 sphere = geometrySystem.GetBoundingSphere(handles[i]);
+
+			const glm::mat4& model = transforms[i];
+			glm::vec3 axisX(model[0]), axisY(model[1]), axisZ(model[2]);
+
+			ProxyProjection& projection = projections[i];
+			projection.scale = glm::sqrt(std::max({ glm::dot(axisX, axisX), glm::dot(axisY, axisY), glm::dot(axisZ, axisZ) }));
+			projection.center = glm::vec3(model * glm::vec4(glm::vec3(sphere), 1.0f));
+			projection.radius = sphere.w * projection.scale;
+			projection.distance = std::max(glm::length(projection.center - camera.GetPosition()) - projection.radius, camera.GetNearClip());
+		}
+
+		return projections;
+	}
+
+	void Scene::ReportTextureCoverage(const ProxyProjection* projections, float pixelsPerUnit)
+	{
+		const PerspectiveCamera& camera = Application::Get().GetRenderApi().GetCamera();
+		Frustum frustum(camera.GetProjectionMatrix() * camera.GetViewMatrix());
+
+		GeometrySystem& geometrySystem = Application::Get().GetGeometrySystem();
+		const GeometryHandle* handles = m_renderProxies.GetGeometries();
+
+		for (uint32_t i = 0; i < m_renderProxies.Size(); ++i) {
+			const ProxyProjection& projection = projections[i];
+			if (!frustum.IntersectsSphere(projection.center, projection.radius)) {
+				continue;
+			}
+
+			// Projected diameter
+			geometrySystem.ReportCoverage(handles[i], 2.0f * projection.radius * pixelsPerUnit / projection.distance);
+		}
+	}
+
+	void Scene::SelectLods(const Geometry* const* geometries, const ProxyProjection* projections, float pixelsPerUnit)
+	{
+		uint8_t* lods = m_renderProxies.GetLods();
+
+		for (uint32_t i = 0; i < m_renderProxies.Size(); ++i) {
+			const std::vector<GeometryLod>& geometryLods = geometries[i]->GetLods();
+			if (geometryLods.size() < 2) {
+				lods[i] = 0;
+				continue;
+			}
 
-		auto group = m_registry.group<Transform3dComponent>(entt::get<GeometryRendererComponent>);
-		for (auto entity : group)
-		{
-			auto [transform, geometry] = group.get<Transform3dComponent, GeometryRendererComponent>(entity);
+			// Pixels one object space unit covers at the nearest point of the bounds
+			const ProxyProjection& projection = projections[i];
+			float pixelsPerObjectUnit = projection.scale * pixelsPerUnit / projection.distance;
 
-			GeometryWithPosition geometryInWorldSpace;
-			geometryInWorldSpace.geometry = geometry.geometry;
-			geometryInWorldSpace.model = transform.GetTransform();
-			drawArgs.geometries.push_back(geometryInWorldSpace);
+			uint32_t lod = std::min<uint32_t>(lods[i], static_cast<uint32_t>(geometryLods.size()) - 1);
+			while (lod > 0 && geometryLods[lod].error * pixelsPerObjectUnit > s_lodErrorPixels) {
+				--lod;
+			}
+			while (lod + 1 < geometryLods.size() && geometryLods[lod + 1].error * pixelsPerObjectUnit < s_lodErrorPixels * s_lodHysteresis) {
+				++lod;
+			}
+			lods[i] = static_cast<uint8_t>(lod);
 		}
-		Application::Get().GetRenderApi().DrawFrame(drawArgs);
 	}
 }
\ No newline at end of file
@@ -3,10 +3,14 @@
 #include "engine/src/mzpch.h"
 #include "engine/src/renderer/render_api.h"
 #include "engine/src/core/uuid.h"
+#include "transform_batch.h"
+#include "transform_hierarchy.h"
+#include "render_proxy.h"
 
 namespace mz {
 	// forward declaration
 	class Entity;
+	struct Transform3dComponent;
 
 	class Scene {
 	public:
@@ -17,8 +21,58 @@ namespace mz {
 		Entity CreateEntityWithUUID(UUID uuid, const std::string& name = std::string());
 		void DestroyEntity(Entity entity);
 		void OnGraphicsUpdate();
+
+		// Passing a null entity as the parent detaches the child and makes it a root
+		void SetParent(Entity child, Entity parent);
+
+		// Recomputes cached local and world matrices of dirty entities and their subtrees
+		void UpdateTransforms();
 	private:
 		entt::registry m_registry;
+		bool m_hierarchyOrderDirty = false;
+
+		// Dirty local transforms are composed together in one SIMD batch
+		TransformBatch m_transformBatch;
+
+		// Kept in sync with the registry through component signals
+		RenderProxyList m_renderProxies;
+
+		// Geometry reference each GeometryRendererComponent owns, released when the component is destroyed, its
+		// handle replaced or the scene goes away. The scene therefore has to be destroyed before the geometry system.
+		std::unordered_map<entt::entity, GeometryHandle> m_geometryReferences;
+
+		void OnRenderableConstruct(entt::registry& registry, entt::entity entity);
+		void OnRenderableDestroy(entt::registry& registry, entt::entity entity);
+		void OnGeometryRendererConstruct(entt::registry& registry, entt::entity entity);
+		void OnGeometryRendererDestroy(entt::registry& registry, entt::entity entity);
+		void OnGeometryRendererUpdate(entt::registry& registry, entt::entity entity);
+		void OnTransformUpdate(entt::registry& registry, entt::entity entity);
+		void OnTransformDestroy(entt::registry& registry, entt::entity entity);
+
+		void DetachFromParent(entt::entity entity);
+		void UpdateSubtreeDepth(entt::entity entity, uint32_t depth);
+		bool IsDescendantOf(entt::entity entity, entt::entity ancestor);
+
+		// World space bounds of a proxy as seen from the camera, shared by texture streaming and LOD selection
+		struct ProxyProjection {
+			glm::vec3 center;
+			float radius;
+			// Largest axis scale of the transform, keeps the sphere conservative under non-uniform scaling
+			float scale;
+			// From the camera to the nearest point of the sphere, at least the near clip distance
+			float distance;
+		};
+
+		// Projects every proxy's bounds into the frame allocator, outPixelsPerUnit is the number of pixels a unit
+		// length covers at unit distance from the camera
+		const ProxyProjection* ProjectProxies(float& outPixelsPerUnit);
+		// Reports the on-screen size of every proxy inside the view frustum to the texture streamer
+		void ReportTextureCoverage(const ProxyProjection* projections, float pixelsPerUnit);
+		// Picks the coarsest LOD of every proxy whose error stays below s_lodErrorPixels on screen. Proxies only move
+		// to a coarser LOD once its error is below s_lodHysteresis of that, so they do not pop back and forth at the boundary.
+		void SelectLods(const Geometry* const* geometries, const ProxyProjection* projections, float pixelsPerUnit);
+		static constexpr float s_lodErrorPixels = 1.0f;
+		static constexpr float s_lodHysteresis = 0.75f;
 		std::shared_ptr<RenderAPI> m_renderApi;
 		std::unordered_map<UUID, Entity> m_entityMap;
 
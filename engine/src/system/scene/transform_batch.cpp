@@ -0,0 +1,278 @@
+#include "transform_batch.h"
+#include "components.h"
+#include "engine/src/core/log.h"
+#include "engine/src/asserts.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#define MZ_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define MZ_TARGET_AVX2
+#else
+#define MZ_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+namespace mz {
+	void TransformBatch::Begin(LinearAllocator& allocator, uint32_t capacity)
+	{
+		m_count = 0;
+		m_capacity = capacity;
+
+		for (float** channel : { &m_tx, &m_ty, &m_tz, &m_qx, &m_qy, &m_qz, &m_qw, &m_sx, &m_sy, &m_sz }) {
+			*channel = allocator.AllocateArray<float>(capacity);
+		}
+
+		for (auto& column : m_out) {
+			column = allocator.AllocateArray<float>(capacity);
+		}
+	}
+
+	uint32_t TransformBatch::Push(const glm::vec3& translation, const glm::vec3& rotation, const glm::vec3& scale)
+	{
+		MZ_ASSERT_MSG(m_count < m_capacity, "Transform batch is full!");
+
+		// Trigonometry stays scalar, the kernels only do the quaternion to matrix expansion
+		glm::quat q(rotation);
+		uint32_t i = m_count++;
+
+		m_tx[i] = translation.x;
+		m_ty[i] = translation.y;
+		m_tz[i] = translation.z;
+		m_qx[i] = q.x;
+		m_qy[i] = q.y;
+		m_qz[i] = q.z;
+		m_qw[i] = q.w;
+		m_sx[i] = scale.x;
+		m_sy[i] = scale.y;
+		m_sz[i] = scale.z;
+
+		return i;
+	}
+
+	void TransformBatch::Compose()
+	{
+		static const SimdLevel s_supportedLevel = GetSupportedSimdLevel();
+		Compose(s_supportedLevel);
+	}
+
+	void TransformBatch::Compose(SimdLevel level)
+	{
+		uint32_t processed = 0;
+		switch (level) {
+		case SimdLevel::AVX2:
+			processed = ComposeAVX2();
+			break;
+		case SimdLevel::SSE2:
+			processed = ComposeSSE2();
+			break;
+		default:
+			break;
+		}
+
+		// Scalar kernel handles the tail that does not fill a full SIMD register
+		ComposeScalar(processed, m_count);
+	}
+
+	glm::mat4 TransformBatch::GetMatrix(uint32_t i) const
+	{
+		return glm::mat4(
+			m_out[0][i], m_out[1][i], m_out[2][i], 0.0f,
+			m_out[3][i], m_out[4][i], m_out[5][i], 0.0f,
+			m_out[6][i], m_out[7][i], m_out[8][i], 0.0f,
+			m_out[9][i], m_out[10][i], m_out[11][i], 1.0f);
+	}
+
+	void TransformBatch::ComposeScalar(uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; ++i) {
+			float qxx = m_qx[i] * m_qx[i], qyy = m_qy[i] * m_qy[i], qzz = m_qz[i] * m_qz[i];
+			float qxz = m_qx[i] * m_qz[i], qxy = m_qx[i] * m_qy[i], qyz = m_qy[i] * m_qz[i];
+			float qwx = m_qw[i] * m_qx[i], qwy = m_qw[i] * m_qy[i], qwz = m_qw[i] * m_qz[i];
+
+			m_out[0][i] = (1.0f - 2.0f * (qyy + qzz)) * m_sx[i];
+			m_out[1][i] = 2.0f * (qxy + qwz) * m_sx[i];
+			m_out[2][i] = 2.0f * (qxz - qwy) * m_sx[i];
+
+			m_out[3][i] = 2.0f * (qxy - qwz) * m_sy[i];
+			m_out[4][i] = (1.0f - 2.0f * (qxx + qzz)) * m_sy[i];
+			m_out[5][i] = 2.0f * (qyz + qwx) * m_sy[i];
+
+			m_out[6][i] = 2.0f * (qxz + qwy) * m_sz[i];
+			m_out[7][i] = 2.0f * (qyz - qwx) * m_sz[i];
+			m_out[8][i] = (1.0f - 2.0f * (qxx + qyy)) * m_sz[i];
+
+			m_out[9][i] = m_tx[i];
+			m_out[10][i] = m_ty[i];
+			m_out[11][i] = m_tz[i];
+		}
+	}
+
+#ifdef MZ_SIMD_X86
+	uint32_t TransformBatch::ComposeSSE2()
+	{
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 two = _mm_set1_ps(2.0f);
+
+		uint32_t i = 0;
+		for (; i + 4 <= m_count; i += 4) {
+			__m128 qx = _mm_loadu_ps(&m_qx[i]);
+			__m128 qy = _mm_loadu_ps(&m_qy[i]);
+			__m128 qz = _mm_loadu_ps(&m_qz[i]);
+			__m128 qw = _mm_loadu_ps(&m_qw[i]);
+			__m128 sx = _mm_loadu_ps(&m_sx[i]);
+			__m128 sy = _mm_loadu_ps(&m_sy[i]);
+			__m128 sz = _mm_loadu_ps(&m_sz[i]);
+
+			__m128 qxx = _mm_mul_ps(qx, qx), qyy = _mm_mul_ps(qy, qy), qzz = _mm_mul_ps(qz, qz);
+			__m128 qxz = _mm_mul_ps(qx, qz), qxy = _mm_mul_ps(qx, qy), qyz = _mm_mul_ps(qy, qz);
+			__m128 qwx = _mm_mul_ps(qw, qx), qwy = _mm_mul_ps(qw, qy), qwz = _mm_mul_ps(qw, qz);
+
+			_mm_storeu_ps(&m_out[0][i], _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qyy, qzz))), sx));
+			_mm_storeu_ps(&m_out[1][i], _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(qxy, qwz)), sx));
+			_mm_storeu_ps(&m_out[2][i], _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(qxz, qwy)), sx));
+
+			_mm_storeu_ps(&m_out[3][i], _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(qxy, qwz)), sy));
+			_mm_storeu_ps(&m_out[4][i], _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qxx, qzz))), sy));
+			_mm_storeu_ps(&m_out[5][i], _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(qyz, qwx)), sy));
+
+			_mm_storeu_ps(&m_out[6][i], _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(qxz, qwy)), sz));
+			_mm_storeu_ps(&m_out[7][i], _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(qyz, qwx)), sz));
+			_mm_storeu_ps(&m_out[8][i], _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qxx, qyy))), sz));
+
+			_mm_storeu_ps(&m_out[9][i], _mm_loadu_ps(&m_tx[i]));
+			_mm_storeu_ps(&m_out[10][i], _mm_loadu_ps(&m_ty[i]));
+			_mm_storeu_ps(&m_out[11][i], _mm_loadu_ps(&m_tz[i]));
+		}
+
+		return i;
+	}
+
+	MZ_TARGET_AVX2 uint32_t TransformBatch::ComposeAVX2()
+	{
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 two = _mm256_set1_ps(2.0f);
+
+		uint32_t i = 0;
+		for (; i + 8 <= m_count; i += 8) {
+			__m256 qx = _mm256_loadu_ps(&m_qx[i]);
+			__m256 qy = _mm256_loadu_ps(&m_qy[i]);
+			__m256 qz = _mm256_loadu_ps(&m_qz[i]);
+			__m256 qw = _mm256_loadu_ps(&m_qw[i]);
+			__m256 sx = _mm256_loadu_ps(&m_sx[i]);
+			__m256 sy = _mm256_loadu_ps(&m_sy[i]);
+			__m256 sz = _mm256_loadu_ps(&m_sz[i]);
+
+			__m256 qxx = _mm256_mul_ps(qx, qx), qyy = _mm256_mul_ps(qy, qy), qzz = _mm256_mul_ps(qz, qz);
+			__m256 qxz = _mm256_mul_ps(qx, qz), qxy = _mm256_mul_ps(qx, qy), qyz = _mm256_mul_ps(qy, qz);
+			__m256 qwx = _mm256_mul_ps(qw, qx), qwy = _mm256_mul_ps(qw, qy), qwz = _mm256_mul_ps(qw, qz);
+
+			// 1 - 2 * (a + b) folded into a single fused negative multiply-add
+			_mm256_storeu_ps(&m_out[0][i], _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(qyy, qzz), one), sx));
+			_mm256_storeu_ps(&m_out[1][i], _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(qxy, qwz)), sx));
+			_mm256_storeu_ps(&m_out[2][i], _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(qxz, qwy)), sx));
+
+			_mm256_storeu_ps(&m_out[3][i], _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(qxy, qwz)), sy));
+			_mm256_storeu_ps(&m_out[4][i], _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(qxx, qzz), one), sy));
+			_mm256_storeu_ps(&m_out[5][i], _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(qyz, qwx)), sy));
+
+			_mm256_storeu_ps(&m_out[6][i], _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(qxz, qwy)), sz));
+			_mm256_storeu_ps(&m_out[7][i], _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(qyz, qwx)), sz));
+			_mm256_storeu_ps(&m_out[8][i], _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(qxx, qyy), one), sz));
+
+			_mm256_storeu_ps(&m_out[9][i], _mm256_loadu_ps(&m_tx[i]));
+			_mm256_storeu_ps(&m_out[10][i], _mm256_loadu_ps(&m_ty[i]));
+			_mm256_storeu_ps(&m_out[11][i], _mm256_loadu_ps(&m_tz[i]));
+		}
+
+		return i;
+	}
+
+	SimdLevel TransformBatch::GetSupportedSimdLevel()
+	{
+		bool hasAvx2 = false;
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] >= 7) {
+			__cpuid(info, 1);
+			bool hasOsxsave = (info[2] & (1 << 27)) != 0;
+			bool hasAvx = (info[2] & (1 << 28)) != 0;
+			bool hasFma = (info[2] & (1 << 12)) != 0;
+
+			// The OS has to save the upper halves of the YMM registers on context switch
+			bool osSavesYmm = hasOsxsave && (_xgetbv(0) & 0x6) == 0x6;
+
+			__cpuidex(info, 7, 0);
+			hasAvx2 = hasAvx && hasFma && osSavesYmm && (info[1] & (1 << 5)) != 0;
+		}
+#else
+		__builtin_cpu_init();
+		hasAvx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+		// SSE2 is part of the x86-64 baseline
+		return hasAvx2 ? SimdLevel::AVX2 : SimdLevel::SSE2;
+	}
+#else
+	uint32_t TransformBatch::ComposeSSE2()
+	{
+		return 0;
+	}
+
+	uint32_t TransformBatch::ComposeAVX2()
+	{
+		return 0;
+	}
+
+	SimdLevel TransformBatch::GetSupportedSimdLevel()
+	{
+		return SimdLevel::Scalar;
+	}
+#endif
+
+	bool TransformBatch::ValidateKernels()
+	{
+		// Odd count so the scalar tail is exercised as well
+		const uint32_t count = 37;
+
+		LinearAllocator allocator(64 * 1024);
+		TransformBatch batch;
+		batch.Begin(allocator, count);
+		// The glm composition the per-entity path uses is the reference every kernel has to match
+		std::vector<Transform3dComponent> components(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			float t = static_cast<float>(i);
+			components[i].Translation = glm::vec3(t * 0.5f - 3.0f, 1.0f - t * 0.25f, t * 0.125f);
+			components[i].Rotation = glm::vec3(t * 0.37f, -t * 0.21f, t * 0.11f + 0.5f);
+			components[i].Scale = glm::vec3(0.5f + t * 0.1f, 1.0f, 2.0f - t * 0.03f);
+			batch.Push(components[i].Translation, components[i].Rotation, components[i].Scale);
+		}
+
+		bool valid = true;
+		SimdLevel supported = GetSupportedSimdLevel();
+		for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 }) {
+			if (level > supported) {
+				break;
+			}
+
+			batch.Compose(level);
+			for (uint32_t i = 0; i < count; ++i) {
+				glm::mat4 reference = components[i].GetTransform();
+				glm::mat4 result = batch.GetMatrix(i);
+				for (int column = 0; column < 4; ++column) {
+					for (int row = 0; row < 4; ++row) {
+						// Relative to the magnitude so large translations are not held to an absolute bound
+						float tolerance = 1e-5f * glm::max(1.0f, glm::abs(reference[column][row]));
+						if (glm::abs(result[column][row] - reference[column][row]) > tolerance) {
+							MZ_CORE_ERROR("Transform kernel {0} differs from the glm reference at entry {1}", static_cast<int>(level), i);
+							valid = false;
+						}
+					}
+				}
+			}
+		}
+
+		return valid;
+	}
+}
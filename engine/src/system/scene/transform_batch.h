@@ -0,0 +1,49 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "engine/src/core/linear_allocator.h"
+#include <array>
+
+namespace mz {
+	enum class SimdLevel {
+		Scalar, SSE2, AVX2
+	};
+
+	// Structure-of-arrays staging for composing many local matrices at once.
+	// Arrays are carved out of a per-frame linear allocator, so building a batch never touches the heap.
+	class TransformBatch {
+	public:
+		void Begin(LinearAllocator& allocator, uint32_t capacity);
+		uint32_t Push(const glm::vec3& translation, const glm::vec3& rotation, const glm::vec3& scale);
+		inline uint32_t Size() const { return m_count; }
+
+		// Composes all pushed entries using the widest kernel the CPU supports
+		void Compose();
+		void Compose(SimdLevel level);
+
+		// Reads back the composed affine matrix of entry i
+		glm::mat4 GetMatrix(uint32_t i) const;
+
+		static SimdLevel GetSupportedSimdLevel();
+
+		// Runs every supported kernel, scalar included, on the same input and compares the results with the glm
+		// composition of Transform3dComponent::GetTransform
+		static bool ValidateKernels();
+
+	private:
+		uint32_t m_count = 0;
+		uint32_t m_capacity = 0;
+
+		// Inputs: translation, unit quaternion built from the euler rotation, scale
+		float* m_tx = nullptr, * m_ty = nullptr, * m_tz = nullptr;
+		float* m_qx = nullptr, * m_qy = nullptr, * m_qz = nullptr, * m_qw = nullptr;
+		float* m_sx = nullptr, * m_sy = nullptr, * m_sz = nullptr;
+
+		// Outputs: three rotation-scale columns followed by the translation column
+		std::array<float*, 12> m_out = {};
+
+		void ComposeScalar(uint32_t begin, uint32_t end);
+		uint32_t ComposeSSE2();
+		uint32_t ComposeAVX2();
+	};
+}
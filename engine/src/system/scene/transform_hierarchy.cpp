@@ -0,0 +1,81 @@
+#include "transform_hierarchy.h"
+#include "components.h"
+
+namespace mz {
+	void TransformHierarchy::SortByDepth(entt::registry& registry)
+	{
+		// Sorting by depth keeps every parent ahead of its children in the storage,
+		// so a single linear pass sees parent world matrices before they are needed
+		registry.sort<HierarchyComponent>([](const HierarchyComponent& lhs, const HierarchyComponent& rhs) {
+			return lhs.Depth < rhs.Depth;
+		});
+	}
+
+	void TransformHierarchy::Update(entt::registry& registry, TransformBatch& batch, LinearAllocator& frameAllocator, RenderProxyList& renderProxies)
+	{
+		// Compose every dirty local matrix in one batch before walking the hierarchy.
+		// Batch storage is transient and comes from the frame allocator.
+		auto transforms = registry.view<Transform3dComponent>();
+
+		uint32_t dirtyCount = 0;
+		for (auto entity : transforms) {
+			dirtyCount += transforms.get<Transform3dComponent>(entity).Dirty ? 1 : 0;
+		}
+
+		if (dirtyCount > 0) {
+			Transform3dComponent** targets = frameAllocator.AllocateArray<Transform3dComponent*>(dirtyCount);
+			batch.Begin(frameAllocator, dirtyCount);
+
+			for (auto entity : transforms) {
+				auto& transform = transforms.get<Transform3dComponent>(entity);
+				if (transform.Dirty) {
+					targets[batch.Push(transform.Translation, transform.Rotation, transform.Scale)] = &transform;
+				}
+			}
+
+			batch.Compose();
+			for (uint32_t i = 0; i < dirtyCount; ++i) {
+				targets[i]->LocalTransform = batch.GetMatrix(i);
+			}
+		}
+
+		// Every node caches the matrix its children inherit, so entities without a transform pass on the world
+		// matrix of their nearest transformed ancestor and changes above them still reach their subtree
+		const glm::mat4 identity(1.0f);
+		auto view = registry.view<HierarchyComponent>();
+		for (auto entity : view) {
+			auto& hierarchy = view.get<HierarchyComponent>(entity);
+
+			const HierarchyComponent* parent = hierarchy.Parent != entt::null
+				? &registry.get<HierarchyComponent>(hierarchy.Parent)
+				: nullptr;
+			bool parentChanged = hierarchy.ParentChanged || (parent && parent->WorldChanged);
+			const glm::mat4& parentWorld = parent ? parent->WorldTransform : identity;
+
+			hierarchy.ParentChanged = false;
+			hierarchy.WorldChanged = false;
+
+			auto* transform = registry.try_get<Transform3dComponent>(entity);
+			if (!transform) {
+				if (parentChanged) {
+					hierarchy.WorldTransform = parentWorld;
+					hierarchy.WorldChanged = true;
+				}
+				continue;
+			}
+
+			if (!transform->Dirty && !parentChanged) {
+				continue;
+			}
+
+			// Local matrix was already composed by the batch above
+			transform->Dirty = false;
+
+			transform->WorldTransform = parentWorld * transform->LocalTransform;
+			hierarchy.WorldTransform = transform->WorldTransform;
+			hierarchy.WorldChanged = true;
+
+			renderProxies.SetTransform(entity, transform->WorldTransform);
+		}
+	}
+}
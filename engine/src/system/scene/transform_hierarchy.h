@@ -0,0 +1,20 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "engine/src/core/linear_allocator.h"
+#include "transform_batch.h"
+#include "render_proxy.h"
+
+namespace mz {
+	// Per-frame transform propagation over a registry's Transform3dComponent and HierarchyComponent storage.
+	// Kept free of the application so the steady-state update can be driven and measured without a window or device.
+	class TransformHierarchy {
+	public:
+		// Keeps every parent ahead of its children in the HierarchyComponent storage
+		static void SortByDepth(entt::registry& registry);
+
+		// Recomputes cached local and world matrices of dirty entities and their subtrees and mirrors changed world
+		// matrices into the render proxies. Expects the storage sorted by depth, transient data comes from frameAllocator.
+		static void Update(entt::registry& registry, TransformBatch& batch, LinearAllocator& frameAllocator, RenderProxyList& renderProxies);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "texture_file.h"
+#include "engine/src/core/log.h"
+
+namespace mz {
+	static constexpr uint64_t s_textureFileDataAlignment = 16;
+
+	static uint64_t AlignTextureFileOffset(uint64_t offset)
+	{
+		return (offset + s_textureFileDataAlignment - 1) & ~(s_textureFileDataAlignment - 1);
+	}
+
+	bool WriteTextureFile(const std::string& filePath, const TextureData& texture)
+	{
+		TextureFileHeader header{};
+		header.magic = s_textureFileMagic;
+		header.version = s_textureFileVersion;
+		header.format = texture.format;
+		header.width = texture.width;
+		header.height = texture.height;
+		header.levelCount = static_cast<uint32_t>(texture.levels.size());
+		header.levelTableOffset = sizeof(TextureFileHeader);
+
+		// Level offsets in the file are absolute
+		uint64_t dataOffset = AlignTextureFileOffset(header.levelTableOffset + header.levelCount * sizeof(TextureFileLevel));
+		std::vector<TextureFileLevel> levels = texture.levels;
+		uint64_t offset = dataOffset;
+		for (TextureFileLevel& level : levels) {
+			level.offset = offset;
+			offset = AlignTextureFileOffset(offset + level.size);
+		}
+
+		// Write next to the target and rename, so a crash never leaves a truncated file behind
+		std::string tempPath = filePath + ".tmp";
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			MZ_CORE_ERROR("Failed to open {0} for writing", tempPath);
+			return false;
+		}
+
+		static const char padding[s_textureFileDataAlignment] = {};
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(levels.data()), static_cast<std::streamsize>(levels.size() * sizeof(TextureFileLevel)));
+
+		for (size_t i = 0; i < levels.size(); ++i) {
+			uint64_t position = static_cast<uint64_t>(file.tellp());
+			file.write(padding, static_cast<std::streamsize>(levels[i].offset - position));
+			file.write(reinterpret_cast<const char*>(texture.pixels.data() + texture.levels[i].offset), static_cast<std::streamsize>(levels[i].size));
+		}
+		file.close();
+
+		if (!file) {
+			MZ_CORE_ERROR("Failed to write texture file {0}", filePath);
+			std::remove(tempPath.c_str());
+			return false;
+		}
+
+		std::remove(filePath.c_str());
+		if (std::rename(tempPath.c_str(), filePath.c_str()) != 0) {
+			MZ_CORE_ERROR("Failed to move {0} to {1}", tempPath, filePath);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool TextureFileView::Parse(const uint8_t* data, size_t size)
+	{
+		if (size < sizeof(TextureFileHeader)) {
+			MZ_CORE_ERROR("Texture file is too small to hold a header");
+			return false;
+		}
+
+		const TextureFileHeader* header = reinterpret_cast<const TextureFileHeader*>(data);
+
+		if (header->magic != s_textureFileMagic) {
+			MZ_CORE_ERROR("Not a texture file");
+			return false;
+		}
+
+		if (header->version != s_textureFileVersion) {
+			MZ_CORE_WARN("Texture file version {0} does not match the engine, it needs to be recooked", header->version);
+			return false;
+		}
+
+		uint64_t levelTableSize = uint64_t(header->levelCount) * sizeof(TextureFileLevel);
+		if (header->levelCount == 0 || header->levelTableOffset > size || levelTableSize > size - header->levelTableOffset) {
+			MZ_CORE_ERROR("Texture file level table is truncated or corrupt");
+			return false;
+		}
+
+		if (GetTextureLevelSize(header->format, 1, 1) == 0) {
+			MZ_CORE_ERROR("Texture file has unknown format {0}", static_cast<uint32_t>(header->format));
+			return false;
+		}
+
+		const TextureFileLevel* levels = reinterpret_cast<const TextureFileLevel*>(data + header->levelTableOffset);
+		for (uint32_t i = 0; i < header->levelCount; ++i) {
+			if (levels[i].offset % s_textureFileDataAlignment != 0 || levels[i].offset > size || levels[i].size > size - levels[i].offset) {
+				MZ_CORE_ERROR("Texture file level {0} is truncated or corrupt", i);
+				return false;
+			}
+
+			// The upload copies whole levels, a size mismatch would read past or short of the level
+			if (levels[i].size != GetTextureLevelSize(header->format, levels[i].width, levels[i].height)) {
+				MZ_CORE_ERROR("Texture file level {0} size does not match its format", i);
+				return false;
+			}
+		}
+
+		m_data = data;
+		m_header = header;
+		m_levels = levels;
+
+		return true;
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "engine/src/renderer/render_types.h"
+
+namespace mz {
+	// Cooked texture container (.mztex) with a prebuilt mip chain. Layout, all little endian:
+	//   TextureFileHeader
+	//   TextureFileLevel[levelCount]   (largest level first)
+	//   level data                     (each level 16 byte aligned)
+	// Level data is stored in the GPU upload layout so a mapped file can be copied to staging as is,
+	// block compressed formats store their 4x4 blocks row by row.
+	static constexpr uint32_t s_textureFileMagic = 0x54585A4D; // "MZXT"
+	static constexpr uint32_t s_textureFileVersion = 1;
+
+	struct TextureFileLevel {
+		uint32_t width;
+		uint32_t height;
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	struct TextureFileHeader {
+		uint32_t magic;
+		uint32_t version;
+		TextureFormat format;
+		uint32_t width;
+		uint32_t height;
+		uint32_t levelCount;
+		uint64_t levelTableOffset;
+	};
+
+	static_assert(sizeof(TextureFileLevel) == 24, "TextureFileLevel layout is part of the file format");
+	static_assert(sizeof(TextureFileHeader) == 32, "TextureFileHeader layout is part of the file format");
+
+	// CPU side texture as produced by the cooker, level offsets are relative to pixels
+	struct TextureData {
+		TextureFormat format = TextureFormat::RGBA8_SRGB;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::vector<TextureFileLevel> levels;
+		std::vector<uint8_t> pixels;
+	};
+
+	bool WriteTextureFile(const std::string& filePath, const TextureData& texture);
+
+	// Validated, zero-copy view over the bytes of a cooked texture
+	class TextureFileView {
+	public:
+		bool Parse(const uint8_t* data, size_t size);
+
+		inline const TextureFileHeader& GetHeader() const { return *m_header; }
+		inline const TextureFileLevel* GetLevels() const { return m_levels; }
+		inline const uint8_t* GetLevelData(uint32_t level) const { return m_data + m_levels[level].offset; }
+
+	private:
+		const uint8_t* m_data = nullptr;
+		const TextureFileHeader* m_header = nullptr;
+		const TextureFileLevel* m_levels = nullptr;
+	};
+}
@@ -0,0 +1,528 @@
+#include "texture_system.h"
+#include "engine/src/core/log.h"
+#include "engine/src/core/utils.h"
+#include "texture_file.h"
+
+namespace mz {
+	TextureSystem::TextureSystem()
+	{
+		const uint8_t white[4] = { 255, 255, 255, 255 };
+
+		TextureLevel level;
+		level.width = 1;
+		level.height = 1;
+		level.data = white;
+		level.size = sizeof(white);
+		m_defaultTexture = Texture::CreateTexture(TextureFormat::RGBA8_SRGB, &level, 1);
+	}
+
+	TextureLoadResult::~TextureLoadResult()
+	{
+		if (pixels) {
+			stbi_image_free(pixels);
+		}
+	}
+
+	TextureHandle TextureSystem::Acquire(const std::string& name)
+	{
+		auto nameIt = m_handlesByName.find(name);
+		if (nameIt != m_handlesByName.end()) {
+			m_textures.AddRef(nameIt->second);
+			++m_nameHits;
+			return nameIt->second;
+		}
+
+		TextureLoadResult result;
+		if (!OpenSource(name, result)) {
+			MZ_CORE_WARN("Failed to load texture {0}!", name);
+			return TextureHandle();
+		}
+
+		// Same contents under a different name share the image that is already resident, without decoding it again
+		auto hashIt = m_handlesByHash.find(result.contentHash);
+		if (hashIt != m_handlesByHash.end()) {
+			TextureHandle handle = hashIt->second;
+			m_textures.AddRef(handle);
+			m_textures.Get(handle)->names.push_back(name);
+			m_handlesByName.emplace(name, handle);
+			++m_contentHits;
+
+			MZ_CORE_TRACE("Texture {0} has the same contents as {1}, sharing it.", name, m_textures.Get(handle)->names.front());
+			return handle;
+		}
+
+		TextureEntry entry;
+		entry.contentHash = result.contentHash;
+		if (!DecodeSource(name, result) || !CreateTexture(name, result, entry)) {
+			MZ_CORE_WARN("Failed to load texture {0}!", name);
+			return TextureHandle();
+		}
+
+		entry.names.push_back(name);
+		TextureHandle handle = m_textures.Insert(std::move(entry));
+		m_handlesByName.emplace(name, handle);
+		m_handlesByHash.emplace(result.contentHash, handle);
+
+		return handle;
+	}
+
+	TextureHandle TextureSystem::AcquireAsync(const std::string& name)
+	{
+		auto nameIt = m_handlesByName.find(name);
+		if (nameIt != m_handlesByName.end()) {
+			m_textures.AddRef(nameIt->second);
+			++m_nameHits;
+			return nameIt->second;
+		}
+
+		// The entry exists from the start so repeated acquires share the load, it resolves to the default texture meanwhile
+		TextureEntry entry;
+		entry.names.push_back(name);
+		entry.pending = true;
+		TextureHandle handle = m_textures.Insert(std::move(entry));
+		m_handlesByName.emplace(name, handle);
+
+		// Decoding is the expensive part and runs on the workers, the GPU upload happens on the main thread in Update()
+		Application::Get().GetJobSystem().Submit([this, handle, name]() {
+			auto result = std::make_unique<TextureLoadResult>();
+			if (!OpenSource(name, *result) || !DecodeSource(name, *result)) {
+				result.reset();
+			}
+
+			std::lock_guard<std::mutex> lock(m_completedMutex);
+			m_completedLoads.push_back({ handle, std::move(result) });
+		});
+
+		return handle;
+	}
+
+	void TextureSystem::Release(TextureHandle handle)
+	{
+		TextureEntry* entry = m_textures.Get(handle);
+		if (!entry) {
+			// Failed acquires hand out the invalid handle, releasing it is not an error
+			if (handle.IsValid()) {
+				MZ_CORE_WARN("Tried to release a texture handle that is no longer valid.");
+			}
+			return;
+		}
+
+		if (m_textures.Release(handle) > 0) {
+			return;
+		}
+
+		// Freeing the slot bumps its generation, so a load still in flight for it is dropped in Update(). The
+		// backend keeps the GPU image until the frames that may still sample it have finished.
+		delete entry->texture;
+		for (const std::string& name : entry->names) {
+			m_handlesByName.erase(name);
+		}
+
+		auto hashIt = m_handlesByHash.find(entry->contentHash);
+		if (hashIt != m_handlesByHash.end() && hashIt->second == handle) {
+			m_handlesByHash.erase(hashIt);
+		}
+
+		TextureHandle alias = entry->alias;
+		m_textures.Remove(handle);
+		Release(alias);
+	}
+
+	const Texture* TextureSystem::Get(TextureHandle handle) const
+	{
+		const TextureEntry* entry = Resolve(handle);
+		return entry && entry->texture ? entry->texture : m_defaultTexture;
+	}
+
+	bool TextureSystem::IsPending(TextureHandle handle) const
+	{
+		const TextureEntry* entry = m_textures.Get(handle);
+		return entry && entry->pending;
+	}
+
+	void TextureSystem::ReportCoverage(TextureHandle handle, float screenPixels)
+	{
+		TextureEntry* entry = Resolve(handle);
+		if (!entry || entry->levels.empty()) {
+			return;
+		}
+
+		entry->coverage = std::max(entry->coverage, screenPixels);
+		entry->lastVisibleFrame = Application::Get().GetFrameIndex();
+	}
+
+	void TextureSystem::Update()
+	{
+		size_t uploadedLoadBytes = 0;
+
+		while (true) {
+			CompletedLoad load;
+
+			{
+				std::lock_guard<std::mutex> lock(m_completedMutex);
+				if (m_completedLoads.empty()) {
+					break;
+				}
+
+				size_t size = 0;
+				if (const TextureLoadResult* next = m_completedLoads.front().result.get()) {
+					for (const TextureLevel& level : next->levels) {
+						size += level.size;
+					}
+				}
+
+				// The rest waits for the next frame so a burst of finished loads does not stall one frame
+				if (uploadedLoadBytes > 0 && uploadedLoadBytes + size > s_uploadBudgetBytes) {
+					break;
+				}
+
+				uploadedLoadBytes += size;
+				load = std::move(m_completedLoads.front());
+				m_completedLoads.pop_front();
+			}
+
+			// Released while the job was running
+			TextureEntry* entry = m_textures.Get(load.handle);
+			if (!entry || !entry->pending) {
+				continue;
+			}
+
+			FinishLoad(load.handle, *entry, load.result.get());
+		}
+
+		uint64_t frameIndex = Application::Get().GetFrameIndex();
+
+		// Finish uploads and turn the coverage of the last frame into the level each texture needs
+		uint64_t streamingBytes = 0;
+		m_streamRequests.clear();
+		m_textures.ForEach([&](TextureHandle handle, TextureEntry& entry) {
+			if (entry.levels.empty()) {
+				return;
+			}
+
+			entry.texture->UpdateResidency();
+
+			if (entry.coverage > 0.0f) {
+				entry.desiredLevel = GetRequiredLevel(entry, entry.coverage);
+			}
+			else if (frameIndex - entry.lastVisibleFrame > s_coldFrameCount) {
+				entry.desiredLevel = entry.baseLevel;
+			}
+			entry.coverage = 0.0f;
+
+			streamingBytes += GetLevelRangeBytes(entry, entry.residentLevel);
+			if (entry.desiredLevel < entry.residentLevel && !entry.texture->IsResidencyPending()) {
+				m_streamRequests.push_back(handle);
+			}
+		});
+
+		// Textures missing the most levels are served first
+		std::sort(m_streamRequests.begin(), m_streamRequests.end(), [this](TextureHandle a, TextureHandle b) {
+			const TextureEntry& entryA = *m_textures.Get(a);
+			const TextureEntry& entryB = *m_textures.Get(b);
+			return entryA.residentLevel - entryA.desiredLevel > entryB.residentLevel - entryB.desiredLevel;
+		});
+
+		uint64_t uploadedBytes = 0;
+		for (TextureHandle handle : m_streamRequests) {
+			TextureEntry& entry = *m_textures.Get(handle);
+
+			// The whole new range is uploaded, not only the levels that are missing
+			uint64_t targetBytes = GetLevelRangeBytes(entry, entry.desiredLevel);
+			uint64_t growthBytes = targetBytes - GetLevelRangeBytes(entry, entry.residentLevel);
+			if (uploadedBytes > 0 && uploadedBytes + targetBytes > s_streamingUploadBytesPerFrame) {
+				break;
+			}
+
+			if (streamingBytes + growthBytes > s_streamingBudgetBytes) {
+				streamingBytes -= EvictColdLevels(streamingBytes + growthBytes - s_streamingBudgetBytes, frameIndex);
+				if (streamingBytes + growthBytes > s_streamingBudgetBytes) {
+					continue;
+				}
+			}
+
+			if (RequestResidency(entry, entry.desiredLevel)) {
+				streamingBytes += growthBytes;
+				uploadedBytes += targetBytes;
+			}
+		}
+
+		m_streamingBytes = streamingBytes;
+	}
+
+	uint64_t TextureSystem::EvictColdLevels(uint64_t bytesNeeded, uint64_t frameIndex)
+	{
+		// Textures seen in the last frame keep what they need, everything else can fall back to its base level
+		auto getEvictionLevel = [frameIndex](const TextureEntry& entry) {
+			return entry.lastVisibleFrame + 1 >= frameIndex ? entry.desiredLevel : entry.baseLevel;
+		};
+
+		m_evictionCandidates.clear();
+		m_textures.ForEach([&](TextureHandle handle, const TextureEntry& entry) {
+			if (!entry.levels.empty() && entry.residentLevel < getEvictionLevel(entry) && !entry.texture->IsResidencyPending()) {
+				m_evictionCandidates.push_back(handle);
+			}
+		});
+
+		std::sort(m_evictionCandidates.begin(), m_evictionCandidates.end(), [this](TextureHandle a, TextureHandle b) {
+			return m_textures.Get(a)->lastVisibleFrame < m_textures.Get(b)->lastVisibleFrame;
+		});
+
+		uint64_t freedBytes = 0;
+		for (TextureHandle handle : m_evictionCandidates) {
+			if (freedBytes >= bytesNeeded) {
+				break;
+			}
+
+			// The larger image is freed once the smaller one has replaced it and no frame samples it anymore
+			TextureEntry& entry = *m_textures.Get(handle);
+			uint64_t residentBytes = GetLevelRangeBytes(entry, entry.residentLevel);
+			uint32_t level = getEvictionLevel(entry);
+			if (RequestResidency(entry, level)) {
+				freedBytes += residentBytes - GetLevelRangeBytes(entry, level);
+			}
+		}
+
+		return freedBytes;
+	}
+
+	bool TextureSystem::RequestResidency(TextureEntry& entry, uint32_t level)
+	{
+		if (!entry.texture->RequestResidency(entry.levels.data(), static_cast<uint32_t>(entry.levels.size()), level)) {
+			return false;
+		}
+
+		entry.residentLevel = level;
+		++m_streamingUploads;
+		return true;
+	}
+
+	uint32_t TextureSystem::GetRequiredLevel(const TextureEntry& entry, float screenPixels)
+	{
+		// Smallest level that still has a texel per pixel, assuming the texture is mapped across the object once
+		uint32_t level = 0;
+		while (level < entry.baseLevel) {
+			const TextureLevel& next = entry.levels[level + 1];
+			if (static_cast<float>(std::max(next.width, next.height)) < screenPixels) {
+				break;
+			}
+			++level;
+		}
+		return level;
+	}
+
+	uint64_t TextureSystem::GetLevelRangeBytes(const TextureEntry& entry, uint32_t firstLevel)
+	{
+		uint64_t size = 0;
+		for (uint32_t i = firstLevel; i < entry.levels.size(); ++i) {
+			size += entry.levels[i].size;
+		}
+		return size;
+	}
+
+	TextureSystemStats TextureSystem::GetStats() const
+	{
+		TextureSystemStats stats;
+		stats.textureCount = m_textures.Size();
+		stats.nameHits = m_nameHits;
+		stats.contentHits = m_contentHits;
+		stats.streamingBytes = m_streamingBytes;
+		stats.streamingBudgetBytes = s_streamingBudgetBytes;
+		stats.streamingUploads = m_streamingUploads;
+
+		m_textures.ForEach([&](TextureHandle handle, const TextureEntry& entry) {
+			uint32_t references = m_textures.GetRefCount(handle);
+			stats.referenceCount += references;
+
+			// Aliases hold one reference on the entry they resolve to, which already counts as a saved copy
+			const TextureEntry* owner = Resolve(handle);
+			if (!owner || !owner->texture) {
+				return;
+			}
+
+			uint64_t sizeBytes = owner->texture->GetSizeBytes();
+			if (owner == &entry) {
+				stats.residentBytes += sizeBytes;
+			}
+			stats.savedBytes += (references - 1) * sizeBytes;
+			if (!entry.levels.empty()) {
+				++stats.streamingTextureCount;
+			}
+		});
+
+		return stats;
+	}
+
+	void TextureSystem::Shutdown()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_completedMutex);
+			m_completedLoads.clear();
+		}
+
+		TextureSystemStats stats = GetStats();
+		MZ_CORE_INFO("Texture cache: {0} textures, {1} KiB resident, {2} KiB saved by sharing ({3} name hits, {4} content hits)",
+			stats.textureCount, stats.residentBytes / 1024, stats.savedBytes / 1024, stats.nameHits, stats.contentHits);
+		MZ_CORE_INFO("Texture streaming: {0} textures, {1} of {2} KiB budget committed, {3} residency changes",
+			stats.streamingTextureCount, stats.streamingBytes / 1024, stats.streamingBudgetBytes / 1024, stats.streamingUploads);
+
+		m_textures.ForEach([](TextureHandle, TextureEntry& entry) {
+			delete entry.texture;
+		});
+
+		m_textures.Clear();
+		m_handlesByName.clear();
+		m_handlesByHash.clear();
+
+		delete m_defaultTexture;
+		m_defaultTexture = nullptr;
+	}
+
+	bool TextureSystem::OpenSource(const std::string& name, TextureLoadResult& result)
+	{
+		// The manifest already knows the hash of cooked textures, so they are deduplicated without reading them.
+		// It is salted with the cooked format, so a cooked and an uncooked copy of one image are not merged.
+		const AssetManifestEntry* cooked = Application::Get().GetAssetManifest().Find("textures/" + name);
+		if (cooked) {
+			std::string cookedPath = AssetManifest::s_cookedRoot + cooked->cookedPath;
+			if (result.file.Open(cookedPath)) {
+				// Block compressed textures need device support, otherwise the source image is decoded instead
+				const TextureFileHeader* header = result.file.GetSize() >= sizeof(TextureFileHeader)
+					? reinterpret_cast<const TextureFileHeader*>(result.file.GetData())
+					: nullptr;
+				if (!header || Texture::IsFormatSupported(header->format)) {
+					result.contentHash = cooked->contentHash;
+					result.cooked = true;
+					return true;
+				}
+
+				MZ_CORE_WARN("Cooked texture {0} uses a format the device does not support, loading the source image", cookedPath);
+				result.file.Close();
+			}
+			else {
+				MZ_CORE_WARN("Cooked texture {0} is listed in the manifest but could not be opened", cookedPath);
+			}
+		}
+
+		if (!result.file.Open("assets/textures/" + name)) {
+			return false;
+		}
+
+		result.contentHash = HashBytes(result.file.GetData(), result.file.GetSize());
+		result.cooked = false;
+		return true;
+	}
+
+	void TextureSystem::FinishLoad(TextureHandle handle, TextureEntry& entry, TextureLoadResult* result)
+	{
+		entry.pending = false;
+
+		const std::string& name = entry.names.front();
+		if (!result) {
+			MZ_CORE_WARN("Failed to load texture {0}!", name);
+			return;
+		}
+
+		// The contents only become known on the worker, so a duplicate is found after handles to it were handed out
+		auto hashIt = m_handlesByHash.find(result->contentHash);
+		if (hashIt != m_handlesByHash.end()) {
+			entry.alias = hashIt->second;
+			m_textures.AddRef(entry.alias);
+			++m_contentHits;
+
+			MZ_CORE_TRACE("Texture {0} has the same contents as {1}, sharing it.", name, m_textures.Get(entry.alias)->names.front());
+			return;
+		}
+
+		if (!CreateTexture(name, *result, entry)) {
+			MZ_CORE_WARN("Failed to load texture {0}!", name);
+			return;
+		}
+
+		entry.contentHash = result->contentHash;
+		m_handlesByHash.emplace(result->contentHash, handle);
+	}
+
+	const TextureSystem::TextureEntry* TextureSystem::Resolve(TextureHandle handle) const
+	{
+		const TextureEntry* entry = m_textures.Get(handle);
+		return entry && entry->alias.IsValid() ? m_textures.Get(entry->alias) : entry;
+	}
+
+	bool TextureSystem::DecodeSource(const std::string& name, TextureLoadResult& result)
+	{
+		if (result.cooked) {
+			TextureFileView texture;
+			if (!texture.Parse(result.file.GetData(), result.file.GetSize())) {
+				MZ_CORE_WARN("Ignoring cooked texture {0}", name);
+				return false;
+			}
+
+			// Levels point straight into the mapping
+			const TextureFileHeader& header = texture.GetHeader();
+			result.format = header.format;
+			result.levels.resize(header.levelCount);
+			for (uint32_t i = 0; i < header.levelCount; ++i) {
+				result.levels[i].width = texture.GetLevels()[i].width;
+				result.levels[i].height = texture.GetLevels()[i].height;
+				result.levels[i].data = texture.GetLevelData(i);
+				result.levels[i].size = static_cast<size_t>(texture.GetLevels()[i].size);
+			}
+			return true;
+		}
+
+		int32_t width, height, channels;
+		result.pixels = stbi_load_from_memory(result.file.GetData(), static_cast<int>(result.file.GetSize()), &width, &height, &channels, STBI_rgb_alpha);
+		if (!result.pixels) {
+			return false;
+		}
+
+		// The compressed source is not needed once it is decoded
+		result.file.Close();
+
+		// Pixels are always expanded to RGBA by stbi_load
+		TextureLevel level;
+		level.width = static_cast<uint32_t>(width);
+		level.height = static_cast<uint32_t>(height);
+		level.data = result.pixels;
+		level.size = static_cast<size_t>(width) * height * 4;
+
+		result.format = TextureFormat::RGBA8_SRGB;
+		result.levels.assign(1, level);
+		return true;
+	}
+
+	bool TextureSystem::CreateTexture(const std::string& name, TextureLoadResult& result, TextureEntry& outEntry)
+	{
+		uint32_t levelCount = static_cast<uint32_t>(result.levels.size());
+
+		// Only the small levels of a cooked chain are uploaded now, the rest is streamed in once the texture is seen up close
+		uint32_t baseLevel = 0;
+		if (result.cooked) {
+			while (baseLevel + 1 < levelCount && std::max(result.levels[baseLevel].width, result.levels[baseLevel].height) > s_initialResidentSize) {
+				++baseLevel;
+			}
+		}
+
+		outEntry.texture = Texture::CreateTexture(result.format, result.levels.data(), levelCount, baseLevel);
+		if (!outEntry.texture) {
+			return false;
+		}
+
+		MZ_CORE_TRACE("Loaded {0}texture {1} ({2} levels, {3} resident).", result.cooked ? "cooked " : "", name, levelCount, levelCount - baseLevel);
+
+		if (baseLevel == 0) {
+			// Fully resident from the start, nothing to stream
+			return true;
+		}
+
+		// The mapping stays open while the texture lives so its levels can be uploaded on demand
+		outEntry.file = std::move(result.file);
+		outEntry.levels = std::move(result.levels);
+		outEntry.baseLevel = baseLevel;
+		outEntry.residentLevel = baseLevel;
+		outEntry.desiredLevel = baseLevel;
+
+		return true;
+	}
+}
\ No newline at end of file
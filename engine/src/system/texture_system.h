@@ -0,0 +1,146 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "engine/src/renderer/texture.h"
+#include "mapped_file.h"
+
+namespace mz {
+	struct TextureSystemStats {
+		uint32_t textureCount = 0;
+		// Live references across all textures
+		uint32_t referenceCount = 0;
+		// Acquires served from the cache, by name or by identical contents under another name
+		uint32_t nameHits = 0;
+		uint32_t contentHits = 0;
+		// GPU memory held by the cache, and what one copy per reference would have needed on top of it
+		uint64_t residentBytes = 0;
+		uint64_t savedBytes = 0;
+		// Textures whose upper mips are streamed, the memory the streamer has committed to them against
+		// its budget, and how many residency changes it has started
+		uint32_t streamingTextureCount = 0;
+		uint64_t streamingBytes = 0;
+		uint64_t streamingBudgetBytes = 0;
+		uint32_t streamingUploads = 0;
+	};
+
+	// CPU side of a texture, ready to be uploaded. Cooked levels point into the mapped file,
+	// decoded ones into the pixels owned by the result.
+	struct TextureLoadResult {
+		MappedFile file;
+		uint64_t contentHash = 0;
+		bool cooked = false;
+
+		TextureFormat format = TextureFormat::RGBA8_SRGB;
+		std::vector<TextureLevel> levels;
+		uint8_t* pixels = nullptr;
+
+		TextureLoadResult() = default;
+		~TextureLoadResult();
+	};
+
+	// Owns every texture. Acquires are deduplicated by name and by content hash, so any
+	// number of users share one GPU image, which is freed when the last reference is released.
+	// Cooked textures start out with only their small mips resident. The larger ones are streamed
+	// in when the texture covers enough of the screen, within a memory budget that is kept by
+	// dropping the mips of the textures that were seen least recently.
+	class TextureSystem {
+	public:
+		TextureSystem();
+
+		// Both add a reference, pair every call with Release()
+		// Reads, decodes and uploads the texture on the calling thread
+		TextureHandle Acquire(const std::string& name);
+		// Returns immediately, the file is mapped and decoded on the job system and uploaded by Update()
+		TextureHandle AcquireAsync(const std::string& name);
+		void Release(TextureHandle handle);
+
+		// Never returns null, textures that are missing or still loading resolve to a white default texture
+		const Texture* Get(TextureHandle handle) const;
+		// True while an asynchronous acquire has not been uploaded or has not failed yet
+		bool IsPending(TextureHandle handle) const;
+
+		// Size in pixels one user of the texture covers on screen this frame, drives which mips are streamed
+		void ReportCoverage(TextureHandle handle, float screenPixels);
+		// Uploads finished loads and starts and finishes mip uploads and evictions, call once per frame on the main thread
+		void Update();
+
+		TextureSystemStats GetStats() const;
+
+		void Shutdown();
+	private:
+		struct TextureEntry {
+			// Every name the texture was acquired under, all of them map to this entry
+			std::vector<std::string> names;
+			Texture* texture = nullptr;
+			uint64_t contentHash = 0;
+			bool pending = false;
+			// Set when an asynchronous load turned out to have the contents of another entry. The entry
+			// holds a reference to it and resolves to its texture instead of owning one.
+			TextureHandle alias;
+
+			// Streaming state, only used when levels is not empty. The file stays mapped so that
+			// levels can be uploaded again, they point into it.
+			MappedFile file;
+			std::vector<TextureLevel> levels;
+			// Level the texture was loaded with, it never drops below it
+			uint32_t baseLevel = 0;
+			// Level the streamer has requested, the texture converges to it
+			uint32_t residentLevel = 0;
+			// Level the last reported coverage needs
+			uint32_t desiredLevel = 0;
+			// Largest coverage reported since the last Update(), in pixels
+			float coverage = 0.0f;
+			uint64_t lastVisibleFrame = 0;
+		};
+
+		struct CompletedLoad {
+			TextureHandle handle;
+			std::unique_ptr<TextureLoadResult> result;
+		};
+
+		SlotMap<TextureEntry, Texture> m_textures;
+		std::unordered_map<std::string, TextureHandle> m_handlesByName;
+		std::unordered_map<uint64_t, TextureHandle> m_handlesByHash;
+		Texture* m_defaultTexture = nullptr;
+
+		uint32_t m_nameHits = 0;
+		uint32_t m_contentHits = 0;
+
+		// Filled by the workers, drained by Update()
+		std::deque<CompletedLoad> m_completedLoads;
+		std::mutex m_completedMutex;
+		// Upload budget per frame for finished loads, at least one is always uploaded
+		static constexpr size_t s_uploadBudgetBytes = 32 * 1024 * 1024;
+
+		// Levels up to this size are uploaded at load, larger ones are streamed
+		static constexpr uint32_t s_initialResidentSize = 64;
+		// Budget for the streamed textures and the upload volume started per frame, at least one upload always starts
+		static constexpr uint64_t s_streamingBudgetBytes = 256 * 1024 * 1024;
+		static constexpr uint64_t s_streamingUploadBytesPerFrame = 16 * 1024 * 1024;
+		// Textures not seen for this many frames only need their base level
+		static constexpr uint64_t s_coldFrameCount = 120;
+
+		uint64_t m_streamingBytes = 0;
+		uint32_t m_streamingUploads = 0;
+		// Scratch lists reused every frame
+		std::vector<TextureHandle> m_streamRequests;
+		std::vector<TextureHandle> m_evictionCandidates;
+
+		// Drops the levels of textures that were not visible recently, least recently seen first. Returns the bytes freed.
+		uint64_t EvictColdLevels(uint64_t bytesNeeded, uint64_t frameIndex);
+		bool RequestResidency(TextureEntry& entry, uint32_t level);
+
+		static uint32_t GetRequiredLevel(const TextureEntry& entry, float screenPixels);
+		static uint64_t GetLevelRangeBytes(const TextureEntry& entry, uint32_t firstLevel);
+		void FinishLoad(TextureHandle handle, TextureEntry& entry, TextureLoadResult* result);
+		// Follows the alias of an entry to the one that owns the texture
+		const TextureEntry* Resolve(TextureHandle handle) const;
+		inline TextureEntry* Resolve(TextureHandle handle) { return const_cast<TextureEntry*>(static_cast<const TextureSystem*>(this)->Resolve(handle)); }
+
+		// Safe to call from any thread, they only touch the file system and the manifest. Opening maps
+		// the file and finds its content hash, decoding fills in the levels.
+		static bool OpenSource(const std::string& name, TextureLoadResult& result);
+		static bool DecodeSource(const std::string& name, TextureLoadResult& result);
+		static bool CreateTexture(const std::string& name, TextureLoadResult& result, TextureEntry& outEntry);
+	};
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "engine/src/core/utils.h"
+
+namespace mz {
+	// Welds bitwise identical vertices while they are appended to a vertex array. Flat open addressing
+	// table with linear probing, sized once for the largest possible vertex count so it never rehashes.
+	// Slots keep the upper half of the hash, so most probes are rejected without touching vertex data.
+	// Vertices compare by their bytes, they have to be fully initialized including any padding.
+	template<typename Vertex>
+	class VertexDeduplicator {
+	public:
+		// maxVertices bounds how many vertices will be added, distinct or not
+		VertexDeduplicator(std::vector<Vertex>& vertices, size_t maxVertices)
+			: m_vertices(vertices), m_firstVertex(vertices.size())
+		{
+			// Load factor stays at or below one half
+			size_t capacity = 16;
+			while (capacity < maxVertices * 2) {
+				capacity *= 2;
+			}
+			m_slots.assign(capacity, Slot{ 0, s_emptySlot });
+			m_mask = capacity - 1;
+		}
+
+		// Index of the equal vertex added before, or of this one after appending it. Relative to the
+		// size the vertex array had when the deduplicator was created.
+		uint32_t Add(const Vertex& vertex)
+		{
+			uint64_t hash = HashBytes(&vertex, sizeof(Vertex));
+			uint32_t tag = static_cast<uint32_t>(hash >> 32);
+
+			for (size_t slot = hash & m_mask;; slot = (slot + 1) & m_mask) {
+				Slot& entry = m_slots[slot];
+				if (entry.index == s_emptySlot) {
+					entry.tag = tag;
+					entry.index = static_cast<uint32_t>(m_vertices.size() - m_firstVertex);
+					m_vertices.push_back(vertex);
+					return entry.index;
+				}
+
+				if (entry.tag == tag && memcmp(&m_vertices[m_firstVertex + entry.index], &vertex, sizeof(Vertex)) == 0) {
+					return entry.index;
+				}
+			}
+		}
+
+		inline uint32_t GetUniqueCount() const { return static_cast<uint32_t>(m_vertices.size() - m_firstVertex); }
+
+	private:
+		static constexpr uint32_t s_emptySlot = std::numeric_limits<uint32_t>::max();
+
+		struct Slot {
+			uint32_t tag;
+			uint32_t index;
+		};
+
+		std::vector<Vertex>& m_vertices;
+		size_t m_firstVertex;
+		std::vector<Slot> m_slots;
+		size_t m_mask;
+	};
+}
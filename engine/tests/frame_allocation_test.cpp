@@ -0,0 +1,132 @@
+// Steady-state allocation test.
+// Drives the per-frame scene work without a window or device: a few entities move every frame, transforms are
+// propagated through the hierarchy into the render proxies and the dirty proxy records are copied out the way the
+// object buffer upload consumes them. After the warm-up frames every frame must run without touching the heap.
+// Built with MZ_TRACK_ALLOCATIONS, exits with 1 when any measured frame allocates.
+//
+// Usage: frame_allocation_test [frames]
+
+#include <cstdlib>
+#include <cstring>
+
+#include "engine/src/mzpch.h"
+#include "engine/src/core/log.h"
+#include "engine/src/core/log.cpp"
+#include "engine/src/core/allocation_tracker.h"
+#include "engine/src/core/allocation_tracker.cpp"
+#include "engine/src/core/linear_allocator.h"
+#include "engine/src/core/linear_allocator.cpp"
+#include "engine/src/core/uuid.h"
+#include "engine/src/core/uuid.cpp"
+#include "engine/src/system/scene/components.h"
+#include "engine/src/system/scene/transform_batch.h"
+#include "engine/src/system/scene/transform_batch.cpp"
+#include "engine/src/system/scene/render_proxy.h"
+#include "engine/src/system/scene/render_proxy.cpp"
+#include "engine/src/system/scene/transform_hierarchy.h"
+#include "engine/src/system/scene/transform_hierarchy.cpp"
+
+using namespace mz;
+
+namespace {
+	constexpr uint32_t s_rootCount = 256;
+	// Every root carries a pivot without a transform and a transformed child below it
+	constexpr uint32_t s_entityCount = s_rootCount * 3;
+	constexpr uint32_t s_movingPerFrame = 16;
+	constexpr uint32_t s_warmupFrames = 10;
+	constexpr uint32_t s_defaultFrames = 200;
+	// Same order of magnitude as the application's frame allocator, overflow is expected to be grown away in warm-up
+	constexpr size_t s_frameAllocatorSize = 64 * 1024;
+
+	entt::entity CreateNode(entt::registry& registry, RenderProxyList& proxies, entt::entity parent, bool transformed)
+	{
+		entt::entity entity = registry.create();
+
+		auto& hierarchy = registry.emplace<HierarchyComponent>(entity);
+		if (parent != entt::null) {
+			auto& parentHierarchy = registry.get<HierarchyComponent>(parent);
+			hierarchy.Parent = parent;
+			hierarchy.Depth = parentHierarchy.Depth + 1;
+			hierarchy.NextSibling = parentHierarchy.FirstChild;
+			parentHierarchy.FirstChild = entity;
+		}
+
+		if (transformed) {
+			registry.emplace<Transform3dComponent>(entity, glm::vec3(static_cast<float>(entt::to_entity(entity)), 0.0f, 0.0f));
+			// The scene adds a proxy through the component signals, the geometry is irrelevant here
+			proxies.Add(entity, GeometryHandle{}, glm::mat4(1.0f));
+		}
+
+		return entity;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Log::Init();
+
+	if (!AllocationTracker::IsEnabled()) {
+		MZ_CORE_ERROR("frame_allocation_test has to be built with MZ_TRACK_ALLOCATIONS");
+		return 1;
+	}
+
+	uint32_t frameCount = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : s_defaultFrames;
+
+	entt::registry registry;
+	RenderProxyList proxies;
+	TransformBatch batch;
+	LinearAllocator frameAllocator(s_frameAllocatorSize);
+
+	std::vector<entt::entity> roots;
+	roots.reserve(s_rootCount);
+	for (uint32_t i = 0; i < s_rootCount; ++i) {
+		entt::entity root = CreateNode(registry, proxies, entt::null, true);
+		entt::entity pivot = CreateNode(registry, proxies, root, false);
+		CreateNode(registry, proxies, pivot, true);
+		roots.push_back(root);
+	}
+	TransformHierarchy::SortByDepth(registry);
+
+	// Stands in for the mapped staging memory of the object buffer
+	std::vector<glm::mat4> staging(s_entityCount);
+
+	uint64_t allocatingFrames = 0;
+	uint64_t totalAllocations = 0;
+	for (uint32_t frame = 0; frame < s_warmupFrames + frameCount; ++frame) {
+		uint64_t frameStart = AllocationTracker::GetThreadAllocationCount();
+
+		frameAllocator.Reset();
+
+		for (uint32_t i = 0; i < s_movingPerFrame; ++i) {
+			entt::entity root = roots[(frame * s_movingPerFrame + i) % s_rootCount];
+			auto& transform = registry.get<Transform3dComponent>(root);
+			transform.SetRotation(transform.Rotation + glm::vec3(0.0f, 0.01f, 0.0f));
+		}
+
+		TransformHierarchy::Update(registry, batch, frameAllocator, proxies);
+
+		const glm::mat4* transforms = proxies.GetTransforms();
+		const uint32_t* dirty = proxies.GetDirtyIndices();
+		for (uint32_t i = 0; i < proxies.GetDirtyCount(); ++i) {
+			if (dirty[i] < proxies.Size()) {
+				std::memcpy(&staging[dirty[i]], &transforms[dirty[i]], sizeof(glm::mat4));
+			}
+		}
+		proxies.ClearDirty();
+
+		uint64_t frameAllocations = AllocationTracker::GetThreadAllocationCount() - frameStart;
+		if (frame >= s_warmupFrames && frameAllocations > 0) {
+			++allocatingFrames;
+			totalAllocations += frameAllocations;
+			MZ_CORE_ERROR("Frame {0} performed {1} heap allocations", frame, frameAllocations);
+		}
+	}
+
+	if (allocatingFrames > 0) {
+		MZ_CORE_ERROR("{0} of {1} steady-state frames allocated, {2} allocations in total", allocatingFrames, frameCount, totalAllocations);
+		return 1;
+	}
+
+	MZ_CORE_INFO("{0} steady-state frames over {1} entities ran without heap allocations", frameCount, s_entityCount);
+	return 0;
+}
@@ -0,0 +1,285 @@
+// Engine micro benchmarks.
+// Times hot engine paths against their straightforward alternatives on synthetic data, so optimizations are
+// judged by numbers instead of frame log timings. --validate only checks the SIMD transform kernels against the
+// glm reference and exits with 1 on a mismatch. Mesh loads are only measured when --mesh or --cooked is given.
+//
+// Usage: mzbench [--validate] [--entities N] [--iterations N] [--moving N] [--mesh source] [--cooked mzmesh] [--loads N]
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+#include "engine/src/mzpch.h"
+#include "engine/src/core/log.h"
+#include "engine/src/core/log.cpp"
+#include "engine/src/core/linear_allocator.h"
+#include "engine/src/core/linear_allocator.cpp"
+#include "engine/src/core/uuid.h"
+#include "engine/src/core/uuid.cpp"
+#include "engine/src/system/scene/components.h"
+#include "engine/src/system/scene/transform_batch.h"
+#include "engine/src/system/scene/transform_batch.cpp"
+#include "engine/src/system/scene/render_proxy.h"
+#include "engine/src/system/scene/render_proxy.cpp"
+#include "engine/src/renderer/vulkan/vulkan_object_staging.h"
+#include "engine/src/renderer/vulkan/vulkan_object_staging.cpp"
+#include "engine/src/core/utils.h"
+#include "engine/src/system/mapped_file.h"
+#include "engine/src/system/mapped_file.cpp"
+#include "engine/src/system/mesh_file.h"
+#include "engine/src/system/mesh_file.cpp"
+#include "engine/src/system/mesh_importer.h"
+#include "engine/src/system/mesh_importer.cpp"
+
+using namespace mz;
+
+namespace {
+	struct BenchOptions {
+		uint32_t entities = 10000;
+		uint32_t iterations = 100;
+		// Objects moved per frame by the upload bench, the rest of the scene stays static
+		uint32_t moving = 100;
+		std::string meshSource;
+		std::string meshCooked;
+		uint32_t loads = 5;
+	};
+
+	// Average milliseconds of one call over all iterations, after a warm-up call
+	template<typename Function>
+	float TimeAverage(uint32_t iterations, Function&& function)
+	{
+		function();
+
+		auto startTime = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < iterations; ++i) {
+			function();
+		}
+		auto endTime = std::chrono::high_resolution_clock::now();
+
+		return std::chrono::duration<float, std::chrono::milliseconds::period>(endTime - startTime).count() / iterations;
+	}
+
+	const char* GetSimdLevelName(SimdLevel level)
+	{
+		switch (level) {
+		case SimdLevel::SSE2: return "SSE2";
+		case SimdLevel::AVX2: return "AVX2";
+		default: return "scalar";
+		}
+	}
+
+	// Local matrix composition of every entity: Transform3dComponent::GetTransform one at a time against the
+	// TransformBatch kernels the scene uses
+	void BenchTransforms(const BenchOptions& options)
+	{
+		std::vector<Transform3dComponent> transforms(options.entities);
+		for (uint32_t i = 0; i < options.entities; ++i) {
+			float t = static_cast<float>(i);
+			transforms[i].Translation = glm::vec3(t * 0.5f, -t * 0.25f, t * 0.125f);
+			transforms[i].Rotation = glm::vec3(t * 0.037f, -t * 0.021f, t * 0.011f);
+			transforms[i].Scale = glm::vec3(1.0f + t * 0.001f);
+		}
+
+		float perEntity = TimeAverage(options.iterations, [&]() {
+			for (auto& transform : transforms) {
+				transform.LocalTransform = transform.GetTransform();
+			}
+		});
+		MZ_CORE_INFO("Transforms, {0} entities: per-entity glm {1:.3f} ms", options.entities, perEntity);
+
+		// Sized like the frame allocator after warm-up, so the batch never spills into overflow blocks
+		LinearAllocator allocator(static_cast<size_t>(options.entities) * 22 * sizeof(float) + 4096);
+		TransformBatch batch;
+		SimdLevel supported = TransformBatch::GetSupportedSimdLevel();
+		for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 }) {
+			if (level > supported) {
+				break;
+			}
+
+			float batched = TimeAverage(options.iterations, [&]() {
+				allocator.Reset();
+				batch.Begin(allocator, options.entities);
+				for (const auto& transform : transforms) {
+					batch.Push(transform.Translation, transform.Rotation, transform.Scale);
+				}
+				batch.Compose(level);
+				for (uint32_t i = 0; i < options.entities; ++i) {
+					transforms[i].LocalTransform = batch.GetMatrix(i);
+				}
+			});
+			MZ_CORE_INFO("Transforms, {0} entities: batched {1} {2:.3f} ms ({3:.2f}x)", options.entities, GetSimdLevelName(level),
+				batched, batched > 0.0f ? perEntity / batched : 0.0f);
+		}
+	}
+
+	// Object buffer records written per frame for a mostly static scene: the delta upload staging only the proxies
+	// that moved against staging every record
+	void BenchObjectUpload(const BenchOptions& options)
+	{
+		uint32_t moving = std::min(options.moving, options.entities);
+
+		entt::registry registry;
+		RenderProxyList proxies;
+		std::vector<entt::entity> entities(options.entities);
+		for (uint32_t i = 0; i < options.entities; ++i) {
+			entities[i] = registry.create();
+			proxies.Add(entities[i], GeometryHandle{}, glm::translate(glm::mat4(1.0f), glm::vec3(static_cast<float>(i), 0.0f, 0.0f)));
+		}
+		// The initial full upload is not part of the steady state
+		proxies.ClearDirty();
+
+		std::vector<uint8_t> staging(static_cast<size_t>(options.entities) * VulkanObjectStaging::s_recordSize);
+		std::vector<VkBufferCopy> regions;
+		regions.reserve(options.entities);
+
+		// Movers are picked pseudo-randomly, so some of them are adjacent and share a copy region
+		uint32_t seed = 1;
+		uint64_t deltaBytes = 0, deltaRegions = 0;
+		float deltaMs = 0.0f;
+		for (uint32_t frame = 0; frame < options.iterations; ++frame) {
+			for (uint32_t i = 0; i < moving; ++i) {
+				seed = seed * 1664525u + 1013904223u;
+				uint32_t index = seed % options.entities;
+				glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(static_cast<float>(index), static_cast<float>(frame), 0.0f));
+				proxies.SetTransform(entities[index], model);
+			}
+
+			RendererObjectData objects;
+			objects.transforms = proxies.GetTransforms();
+			objects.count = proxies.Size();
+			objects.dirtyIndices = proxies.GetDirtyIndices();
+			objects.dirtyCount = proxies.GetDirtyCount();
+
+			auto startTime = std::chrono::high_resolution_clock::now();
+			uint32_t written = VulkanObjectStaging::StageRecords(objects, false, staging.data(), 0, regions);
+			auto endTime = std::chrono::high_resolution_clock::now();
+
+			deltaMs += std::chrono::duration<float, std::chrono::milliseconds::period>(endTime - startTime).count();
+			deltaBytes += written * VulkanObjectStaging::s_recordSize;
+			deltaRegions += regions.size();
+			proxies.ClearDirty();
+		}
+
+		RendererObjectData objects;
+		objects.transforms = proxies.GetTransforms();
+		objects.count = proxies.Size();
+		float fullMs = TimeAverage(options.iterations, [&]() {
+			VulkanObjectStaging::StageRecords(objects, true, staging.data(), 0, regions);
+		});
+		uint64_t fullBytes = static_cast<uint64_t>(objects.count) * VulkanObjectStaging::s_recordSize;
+
+		MZ_CORE_INFO("Object upload, {0} objects, {1} moving per frame: delta {2} bytes/frame in {3:.1f} regions ({4:.4f} ms), full {5} bytes/frame ({6:.4f} ms)",
+			options.entities, moving, deltaBytes / options.iterations, static_cast<float>(deltaRegions) / options.iterations,
+			deltaMs / options.iterations, fullBytes, fullMs);
+	}
+
+	// First and average time of a load. The first one is as cold as the OS file cache allows, later ones read cached pages.
+	template<typename Function>
+	bool TimeLoads(const char* label, uint32_t loads, Function&& load)
+	{
+		float firstMs = 0.0f, totalMs = 0.0f;
+		for (uint32_t i = 0; i < loads; ++i) {
+			auto startTime = std::chrono::high_resolution_clock::now();
+			if (!load()) {
+				MZ_CORE_ERROR("Mesh load {0} failed", label);
+				return false;
+			}
+			auto endTime = std::chrono::high_resolution_clock::now();
+
+			float ms = std::chrono::duration<float, std::chrono::milliseconds::period>(endTime - startTime).count();
+			firstMs = i == 0 ? ms : firstMs;
+			totalMs += ms;
+		}
+
+		MZ_CORE_INFO("Mesh load, {0}: first {1:.3f} ms, average {2:.3f} ms over {3} loads", label, firstMs, totalMs / loads, loads);
+		return true;
+	}
+
+	// Cooked .mzmesh against the Assimp import the runtime falls back to. Both hash their vertex and index data
+	// like the geometry system does, so the mapped pages are actually read.
+	void BenchMeshLoad(const BenchOptions& options)
+	{
+		uint64_t checksum = 0;
+
+		if (!options.meshCooked.empty()) {
+			TimeLoads(".mzmesh", options.loads, [&]() {
+				MappedFile file;
+				MeshFileView mesh;
+				if (!file.Open(options.meshCooked) || !mesh.Parse(file.GetData(), file.GetSize())) {
+					return false;
+				}
+
+				const MeshFileHeader& header = mesh.GetHeader();
+				checksum ^= HashBytes(mesh.GetVertices(), size_t(header.vertexCount) * header.vertexStride);
+				checksum ^= HashBytes(mesh.GetIndices(), size_t(header.indexCount) * header.indexStride);
+				return true;
+			});
+		}
+
+		if (!options.meshSource.empty()) {
+			TimeLoads("Assimp", options.loads, [&]() {
+				MeshData mesh;
+				if (!MeshImporter::ImportAssimp(options.meshSource, mesh)) {
+					return false;
+				}
+
+				checksum ^= HashBytes(mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex3d));
+				checksum ^= HashBytes(mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+				return true;
+			});
+		}
+
+		// Keeps the hashing from being optimized away
+		MZ_CORE_TRACE("Mesh load checksum {0:x}", checksum);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Log::Init();
+
+	BenchOptions options;
+	bool validateOnly = false;
+	for (int i = 1; i < argc; ++i) {
+		std::string argument = argv[i];
+		if (argument == "--validate") {
+			validateOnly = true;
+		}
+		else if (argument == "--entities" && i + 1 < argc) {
+			options.entities = std::max(static_cast<uint32_t>(std::stoul(argv[++i])), 1u);
+		}
+		else if (argument == "--iterations" && i + 1 < argc) {
+			options.iterations = std::max(static_cast<uint32_t>(std::stoul(argv[++i])), 1u);
+		}
+		else if (argument == "--moving" && i + 1 < argc) {
+			options.moving = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (argument == "--mesh" && i + 1 < argc) {
+			options.meshSource = argv[++i];
+		}
+		else if (argument == "--cooked" && i + 1 < argc) {
+			options.meshCooked = argv[++i];
+		}
+		else if (argument == "--loads" && i + 1 < argc) {
+			options.loads = std::max(static_cast<uint32_t>(std::stoul(argv[++i])), 1u);
+		}
+		else {
+			MZ_CORE_WARN("Ignoring unknown argument {0}", argument);
+		}
+	}
+
+	// Timings of kernels that compute the wrong thing are meaningless
+	if (!TransformBatch::ValidateKernels()) {
+		return 1;
+	}
+	if (validateOnly) {
+		MZ_CORE_INFO("Transform kernels match the glm reference up to {0}", GetSimdLevelName(TransformBatch::GetSupportedSimdLevel()));
+		return 0;
+	}
+
+	BenchTransforms(options);
+	BenchObjectUpload(options);
+	BenchMeshLoad(options);
+
+	return 0;
+}
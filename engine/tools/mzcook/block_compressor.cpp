@@ -0,0 +1,257 @@
+#include "block_compressor.h"
+
+namespace mz {
+	// Palette weights of the first endpoint for the four BC1 color indices
+	static constexpr float s_colorWeights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+	static uint16_t PackRgb565(const float* color)
+	{
+		uint32_t r = static_cast<uint32_t>(std::clamp(color[0], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+		uint32_t g = static_cast<uint32_t>(std::clamp(color[1], 0.0f, 255.0f) * 63.0f / 255.0f + 0.5f);
+		uint32_t b = static_cast<uint32_t>(std::clamp(color[2], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	static void UnpackRgb565(uint16_t packed, float* color)
+	{
+		uint32_t r = (packed >> 11) & 31;
+		uint32_t g = (packed >> 5) & 63;
+		uint32_t b = packed & 31;
+		color[0] = static_cast<float>((r << 3) | (r >> 2));
+		color[1] = static_cast<float>((g << 2) | (g >> 4));
+		color[2] = static_cast<float>((b << 3) | (b >> 2));
+	}
+
+	// Picks the nearest palette entry for every texel, returns the summed squared error
+	static float FitColorIndices(const uint8_t* block, uint16_t endpoint0, uint16_t endpoint1, uint32_t& outIndices)
+	{
+		float color0[3], color1[3];
+		UnpackRgb565(endpoint0, color0);
+		UnpackRgb565(endpoint1, color1);
+
+		float palette[4][3];
+		for (int i = 0; i < 4; ++i) {
+			for (int c = 0; c < 3; ++c) {
+				palette[i][c] = color0[c] * s_colorWeights[i] + color1[c] * (1.0f - s_colorWeights[i]);
+			}
+		}
+
+		float totalError = 0.0f;
+		outIndices = 0;
+		for (uint32_t texel = 0; texel < 16; ++texel) {
+			const uint8_t* pixel = block + texel * 4;
+
+			uint32_t bestIndex = 0;
+			float bestError = std::numeric_limits<float>::max();
+			for (uint32_t i = 0; i < 4; ++i) {
+				float error = 0.0f;
+				for (int c = 0; c < 3; ++c) {
+					float difference = palette[i][c] - pixel[c];
+					error += difference * difference;
+				}
+				if (error < bestError) {
+					bestError = error;
+					bestIndex = i;
+				}
+			}
+
+			outIndices |= bestIndex << (texel * 2);
+			totalError += bestError;
+		}
+
+		return totalError;
+	}
+
+	// Solves for the endpoints that minimize the error of the given index assignment
+	static bool RefineColorEndpoints(const uint8_t* block, uint32_t indices, float* outColor0, float* outColor1)
+	{
+		float alpha2 = 0.0f, beta2 = 0.0f, alphaBeta = 0.0f;
+		float alphaX[3] = {}, betaX[3] = {};
+
+		for (uint32_t texel = 0; texel < 16; ++texel) {
+			float alpha = s_colorWeights[(indices >> (texel * 2)) & 3];
+			float beta = 1.0f - alpha;
+
+			alpha2 += alpha * alpha;
+			beta2 += beta * beta;
+			alphaBeta += alpha * beta;
+			for (int c = 0; c < 3; ++c) {
+				alphaX[c] += alpha * block[texel * 4 + c];
+				betaX[c] += beta * block[texel * 4 + c];
+			}
+		}
+
+		float determinant = alpha2 * beta2 - alphaBeta * alphaBeta;
+		if (std::abs(determinant) < 1e-6f) {
+			return false;
+		}
+
+		for (int c = 0; c < 3; ++c) {
+			outColor0[c] = (alphaX[c] * beta2 - betaX[c] * alphaBeta) / determinant;
+			outColor1[c] = (betaX[c] * alpha2 - alphaX[c] * alphaBeta) / determinant;
+		}
+
+		return true;
+	}
+
+	void BlockCompressor::CompressBC1(const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* output)
+	{
+		uint8_t block[64];
+		for (uint32_t blockY = 0; blockY < (height + 3) / 4; ++blockY) {
+			for (uint32_t blockX = 0; blockX < (width + 3) / 4; ++blockX) {
+				LoadBlock(rgba, width, height, blockX, blockY, block);
+				EncodeColorBlock(block, output);
+				output += 8;
+			}
+		}
+	}
+
+	void BlockCompressor::CompressBC3(const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* output)
+	{
+		uint8_t block[64];
+		for (uint32_t blockY = 0; blockY < (height + 3) / 4; ++blockY) {
+			for (uint32_t blockX = 0; blockX < (width + 3) / 4; ++blockX) {
+				LoadBlock(rgba, width, height, blockX, blockY, block);
+				EncodeAlphaBlock(block, output);
+				EncodeColorBlock(block, output + 8);
+				output += 16;
+			}
+		}
+	}
+
+	void BlockCompressor::LoadBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t* block)
+	{
+		for (uint32_t y = 0; y < 4; ++y) {
+			uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+			for (uint32_t x = 0; x < 4; ++x) {
+				uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+				memcpy(block + (y * 4 + x) * 4, rgba + (size_t(sourceY) * width + sourceX) * 4, 4);
+			}
+		}
+	}
+
+	void BlockCompressor::EncodeColorBlock(const uint8_t* block, uint8_t* output)
+	{
+		float mean[3] = {};
+		for (uint32_t texel = 0; texel < 16; ++texel) {
+			for (int c = 0; c < 3; ++c) {
+				mean[c] += block[texel * 4 + c] / 16.0f;
+			}
+		}
+
+		// Covariance of the block colors, its dominant eigenvector is the line the endpoints are fitted to
+		float covariance[6] = {};
+		for (uint32_t texel = 0; texel < 16; ++texel) {
+			float r = block[texel * 4 + 0] - mean[0];
+			float g = block[texel * 4 + 1] - mean[1];
+			float b = block[texel * 4 + 2] - mean[2];
+			covariance[0] += r * r; covariance[1] += r * g; covariance[2] += r * b;
+			covariance[3] += g * g; covariance[4] += g * b; covariance[5] += b * b;
+		}
+
+		float axis[3] = { 1.0f, 1.0f, 1.0f };
+		for (int iteration = 0; iteration < 8; ++iteration) {
+			float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+			float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+			float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+			float length = std::max({ std::abs(x), std::abs(y), std::abs(z) });
+			if (length < 1e-6f) {
+				// Flat block, any axis works
+				break;
+			}
+			axis[0] = x / length; axis[1] = y / length; axis[2] = z / length;
+		}
+
+		float minProjection = std::numeric_limits<float>::max();
+		float maxProjection = std::numeric_limits<float>::lowest();
+		for (uint32_t texel = 0; texel < 16; ++texel) {
+			float projection = 0.0f;
+			for (int c = 0; c < 3; ++c) {
+				projection += (block[texel * 4 + c] - mean[c]) * axis[c];
+			}
+			minProjection = std::min(minProjection, projection);
+			maxProjection = std::max(maxProjection, projection);
+		}
+
+		float axisLength2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+		float color0[3], color1[3];
+		for (int c = 0; c < 3; ++c) {
+			color0[c] = mean[c] + axis[c] * maxProjection / axisLength2;
+			color1[c] = mean[c] + axis[c] * minProjection / axisLength2;
+		}
+
+		uint16_t endpoint0 = PackRgb565(color0);
+		uint16_t endpoint1 = PackRgb565(color1);
+		uint32_t indices;
+		float error = FitColorIndices(block, endpoint0, endpoint1, indices);
+
+		// One least squares pass on the initial assignment, kept only when it lowers the error
+		float refined0[3], refined1[3];
+		if (RefineColorEndpoints(block, indices, refined0, refined1)) {
+			uint16_t refinedEndpoint0 = PackRgb565(refined0);
+			uint16_t refinedEndpoint1 = PackRgb565(refined1);
+			uint32_t refinedIndices;
+			float refinedError = FitColorIndices(block, refinedEndpoint0, refinedEndpoint1, refinedIndices);
+			if (refinedError < error) {
+				endpoint0 = refinedEndpoint0;
+				endpoint1 = refinedEndpoint1;
+				indices = refinedIndices;
+			}
+		}
+
+		// Four color mode requires endpoint0 > endpoint1, swapping mirrors the palette: 0<->1, 2<->3
+		if (endpoint0 < endpoint1) {
+			std::swap(endpoint0, endpoint1);
+			indices ^= 0x55555555;
+		}
+		else if (endpoint0 == endpoint1) {
+			indices = 0;
+		}
+
+		memcpy(output, &endpoint0, 2);
+		memcpy(output + 2, &endpoint1, 2);
+		memcpy(output + 4, &indices, 4);
+	}
+
+	void BlockCompressor::EncodeAlphaBlock(const uint8_t* block, uint8_t* output)
+	{
+		uint8_t alpha0 = 0, alpha1 = 255;
+		for (uint32_t texel = 0; texel < 16; ++texel) {
+			alpha0 = std::max(alpha0, block[texel * 4 + 3]);
+			alpha1 = std::min(alpha1, block[texel * 4 + 3]);
+		}
+
+		// Eight value mode (alpha0 > alpha1): both endpoints and six interpolated steps
+		float palette[8];
+		palette[0] = alpha0;
+		palette[1] = alpha1;
+		for (int i = 1; i < 7; ++i) {
+			palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7.0f;
+		}
+
+		uint64_t indices = 0;
+		if (alpha0 != alpha1) {
+			for (uint32_t texel = 0; texel < 16; ++texel) {
+				float alpha = block[texel * 4 + 3];
+
+				uint64_t bestIndex = 0;
+				float bestError = std::numeric_limits<float>::max();
+				for (uint64_t i = 0; i < 8; ++i) {
+					float error = std::abs(palette[i] - alpha);
+					if (error < bestError) {
+						bestError = error;
+						bestIndex = i;
+					}
+				}
+
+				indices |= bestIndex << (texel * 3);
+			}
+		}
+
+		output[0] = alpha0;
+		output[1] = alpha1;
+		for (int i = 0; i < 6; ++i) {
+			output[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+		}
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+
+namespace mz {
+	// BC1 and BC3 encoder for cooked textures. Endpoints are fitted along the principal axis of each
+	// block's colors and refined once by least squares. Texel values are encoded as stored, so sRGB
+	// data produces blocks for the matching _SRGB formats.
+	class BlockCompressor {
+	public:
+		// Input is tightly packed RGBA8, output is one block per 4x4 texels, row by row.
+		// Partial blocks at the right and bottom edges repeat the last row and column.
+		static void CompressBC1(const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* output);
+		static void CompressBC3(const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* output);
+	private:
+		static void LoadBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t* block);
+		// Always four color mode, the three color mode with its transparent index is never emitted
+		static void EncodeColorBlock(const uint8_t* block, uint8_t* output);
+		static void EncodeAlphaBlock(const uint8_t* block, uint8_t* output);
+	};
+}
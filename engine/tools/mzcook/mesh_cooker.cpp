@@ -0,0 +1,191 @@
+#include "mesh_cooker.h"
+#include "engine/src/system/mesh_importer.h"
+#include "engine/src/core/log.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+#include "meshlet_builder.h"
+#include "vertex_packer.h"
+
+namespace mz {
+	bool MeshCooker::Cook(const std::string& sourcePath, bool packVertices, MeshData& outMesh)
+	{
+		if (!MeshImporter::ImportAssimp(sourcePath, outMesh)) {
+			return false;
+		}
+
+		// Lets every submesh use 16 bit indices, the optimizer then works on the final pieces
+		uint32_t splitCount = SplitSubmeshes(outMesh, s_maxShortIndexVertices);
+		if (splitCount > 0) {
+			MZ_CORE_INFO("Split {0} submeshes of {1} for 16 bit indices, {2} submeshes now", splitCount, sourcePath, outMesh.submeshes.size());
+		}
+
+		MeshOptimizerStats stats = MeshOptimizer::Optimize(outMesh);
+		MZ_CORE_INFO("Optimized {0}: ACMR {1:.3f} -> {2:.3f}, ATVR {3:.3f} -> {4:.3f}", sourcePath,
+			stats.before.GetAcmr(), stats.after.GetAcmr(), stats.before.GetAtvr(), stats.after.GetAtvr());
+
+		// After the optimizer, so the coarser LODs share its vertex order
+		if (GenerateLods(outMesh) > 1) {
+			std::string triangles;
+			for (const MeshFileLod& lod : outMesh.lods) {
+				triangles += (triangles.empty() ? "" : " -> ") + std::to_string(lod.indexCount / 3);
+			}
+			MZ_CORE_INFO("Generated {0} LODs for {1}: {2} triangles, error {3:.4f}", outMesh.lods.size(), sourcePath, triangles, outMesh.lods.back().error);
+		}
+
+		// Over the final index ranges of every LOD, the bounds need full precision positions
+		if (outMesh.lods.front().indexCount / 3 >= s_meshletMinTriangles) {
+			uint32_t meshletCount = MeshletBuilder::Build(outMesh);
+			MZ_CORE_INFO("Built {0} meshlets for {1}, {2} in LOD 0", meshletCount, sourcePath, outMesh.lods.front().meshletCount);
+		}
+
+		// Last pass, everything before works on full precision vertices
+		if (packVertices && outMesh.vertices.size() >= s_packedVertexThreshold) {
+			VertexPacker::Pack(outMesh);
+			MZ_CORE_INFO("Packed {0} vertices of {1}: {2} KB -> {3} KB", outMesh.vertices.size(), sourcePath,
+				outMesh.vertices.size() * sizeof(Vertex3d) / 1024, outMesh.packedVertices.size() * sizeof(PackedVertex3d) / 1024);
+		}
+
+		return true;
+	}
+
+	uint32_t MeshCooker::GenerateLods(MeshData& mesh)
+	{
+		uint32_t baseSubmeshCount = static_cast<uint32_t>(mesh.submeshes.size());
+		uint32_t baseIndexCount = static_cast<uint32_t>(mesh.indices.size());
+		mesh.lods.assign(1, MeshFileLod{ 0, baseSubmeshCount, baseIndexCount, 0.0f });
+
+		if (baseIndexCount / 3 < s_lodMinTriangles) {
+			return 1;
+		}
+
+		// Errors add up along the chain, each LOD is simplified from the one before
+		std::vector<float> submeshErrors(baseSubmeshCount, 0.0f);
+		std::vector<float> errors;
+		std::vector<uint32_t> simplified;
+
+		while (mesh.lods.size() < s_maxMeshLodCount) {
+			const MeshFileLod previous = mesh.lods.back();
+			MeshFileLod lod{ static_cast<uint32_t>(mesh.submeshes.size()), baseSubmeshCount, 0, 0.0f };
+			size_t previousIndexCount = mesh.indices.size();
+			errors = submeshErrors;
+
+			for (uint32_t i = 0; i < baseSubmeshCount; ++i) {
+				MeshFileSubmesh submesh = mesh.submeshes[previous.firstSubmesh + i];
+
+				if (submesh.indexCount / 3 >= s_lodMinSubmeshTriangles) {
+					const Vertex3d* vertices = mesh.vertices.data() + submesh.firstVertex;
+					float error = MeshSimplifier::Simplify(mesh.indices.data() + submesh.firstIndex, submesh.indexCount,
+						vertices, submesh.vertexCount, submesh.indexCount / 6 * 3, simplified);
+
+					if (simplified.size() < submesh.indexCount) {
+						uint32_t indexCount = static_cast<uint32_t>(simplified.size());
+						MeshOptimizer::OptimizeVertexCache(simplified.data(), indexCount, submesh.vertexCount);
+						MeshOptimizer::OptimizeOverdraw(simplified.data(), indexCount, vertices, submesh.vertexCount, 1.05f);
+
+						submesh.firstIndex = static_cast<uint32_t>(mesh.indices.size());
+						submesh.indexCount = indexCount;
+						mesh.indices.insert(mesh.indices.end(), simplified.begin(), simplified.end());
+						errors[i] += error;
+					}
+				}
+
+				lod.indexCount += submesh.indexCount;
+				lod.error = std::max(lod.error, errors[i]);
+				mesh.submeshes.push_back(submesh);
+			}
+
+			if (lod.indexCount > previous.indexCount * s_lodMaxIndexRatio) {
+				mesh.submeshes.resize(lod.firstSubmesh);
+				mesh.indices.resize(previousIndexCount);
+				break;
+			}
+
+			submeshErrors = errors;
+			mesh.lods.push_back(lod);
+		}
+
+		return static_cast<uint32_t>(mesh.lods.size());
+	}
+
+	uint32_t MeshCooker::SplitSubmeshes(MeshData& mesh, uint32_t maxVertices)
+	{
+		uint32_t splitCount = 0;
+		for (const MeshFileSubmesh& submesh : mesh.submeshes) {
+			splitCount += submesh.vertexCount > maxVertices ? 1 : 0;
+		}
+
+		if (splitCount == 0) {
+			return 0;
+		}
+
+		std::vector<Vertex3d> vertices;
+		std::vector<uint32_t> indices;
+		std::vector<MeshFileSubmesh> submeshes;
+		vertices.reserve(mesh.vertices.size());
+		indices.reserve(mesh.indices.size());
+
+		// Local index of every source vertex in the piece being built, valid while its stamp matches the piece
+		std::vector<uint32_t> remap;
+		std::vector<uint32_t> remapPiece;
+		uint32_t piece = 0;
+
+		for (const MeshFileSubmesh& source : mesh.submeshes) {
+			const Vertex3d* sourceVertices = mesh.vertices.data() + source.firstVertex;
+			const uint32_t* sourceIndices = mesh.indices.data() + source.firstIndex;
+
+			if (source.vertexCount <= maxVertices) {
+				MeshFileSubmesh submesh = source;
+				submesh.firstVertex = static_cast<uint32_t>(vertices.size());
+				submesh.firstIndex = static_cast<uint32_t>(indices.size());
+				vertices.insert(vertices.end(), sourceVertices, sourceVertices + source.vertexCount);
+				indices.insert(indices.end(), sourceIndices, sourceIndices + source.indexCount);
+				submeshes.push_back(submesh);
+				continue;
+			}
+
+			remap.assign(source.vertexCount, 0);
+			remapPiece.assign(source.vertexCount, 0);
+
+			MeshFileSubmesh submesh{};
+			for (uint32_t triangle = 0; triangle + 2 < source.indexCount; triangle += 3) {
+				// A triangle adds at most three vertices, close the piece before it could overflow
+				if (submesh.indexCount == 0 || submesh.vertexCount + 3 > maxVertices) {
+					if (submesh.indexCount > 0) {
+						submeshes.push_back(submesh);
+					}
+
+					++piece;
+					submesh = MeshFileSubmesh{};
+					submesh.materialSlot = source.materialSlot;
+					submesh.firstVertex = static_cast<uint32_t>(vertices.size());
+					submesh.firstIndex = static_cast<uint32_t>(indices.size());
+					submesh.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+					submesh.boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+				}
+
+				for (uint32_t corner = 0; corner < 3; ++corner) {
+					uint32_t vertex = sourceIndices[triangle + corner];
+					if (remapPiece[vertex] != piece) {
+						remapPiece[vertex] = piece;
+						remap[vertex] = submesh.vertexCount++;
+						vertices.push_back(sourceVertices[vertex]);
+						submesh.boundsMin = glm::min(submesh.boundsMin, sourceVertices[vertex].pos);
+						submesh.boundsMax = glm::max(submesh.boundsMax, sourceVertices[vertex].pos);
+					}
+					indices.push_back(remap[vertex]);
+				}
+				submesh.indexCount += 3;
+			}
+
+			if (submesh.indexCount > 0) {
+				submeshes.push_back(submesh);
+			}
+		}
+
+		mesh.vertices = std::move(vertices);
+		mesh.indices = std::move(indices);
+		mesh.submeshes = std::move(submeshes);
+
+		return splitCount;
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "engine/src/system/mesh_file.h"
+
+namespace mz {
+	// Imports a source mesh and runs the offline processing passes on it
+	class MeshCooker {
+	public:
+		// Meshes with at least s_packedVertexThreshold vertices are stored as PackedVertex3d unless packing is disabled
+		static bool Cook(const std::string& sourcePath, bool packVertices, MeshData& outMesh);
+	private:
+		// Cuts submeshes with more than maxVertices vertices into consecutive runs of triangles that stay
+		// within the limit. Vertices shared across a cut are duplicated. Returns how many submeshes were split.
+		static uint32_t SplitSubmeshes(MeshData& mesh, uint32_t maxVertices);
+		// Appends up to s_maxMeshLodCount - 1 simplified LODs, each aiming for half the triangles of the one before.
+		// Expects the submeshes to be final, returns the number of LODs including LOD 0.
+		static uint32_t GenerateLods(MeshData& mesh);
+
+		// Below this the vertex buffer is too small for the bandwidth to matter, full precision is kept
+		static constexpr size_t s_packedVertexThreshold = 1024;
+		// Smaller meshes are drawn at full detail at any distance
+		static constexpr uint32_t s_lodMinTriangles = 256;
+		// Smaller submeshes are not simplified further, coarser LODs keep drawing their last index range
+		static constexpr uint32_t s_lodMinSubmeshTriangles = 16;
+		// A LOD keeping more of the previous one's indices than this is not worth its memory, generation stops there
+		static constexpr float s_lodMaxIndexRatio = 0.8f;
+		// Smaller meshes are cheap enough to draw whole, per meshlet culling would cost more than it saves
+		static constexpr uint32_t s_meshletMinTriangles = 4096;
+	};
+}
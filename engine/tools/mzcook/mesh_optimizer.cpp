@@ -0,0 +1,362 @@
+#include "mesh_optimizer.h"
+
+namespace mz {
+	// Cache the analysis and the overdraw clustering simulate, close to what current GPUs reuse
+	static constexpr uint32_t s_fifoCacheSize = 16;
+
+	// Forsyth scoring parameters
+	static constexpr uint32_t s_lruCacheSize = 32;
+	static constexpr float s_cacheDecayPower = 1.5f;
+	static constexpr float s_lastTriangleScore = 0.75f;
+	static constexpr float s_valenceBoostScale = 2.0f;
+	static constexpr float s_valenceBoostPower = 0.5f;
+
+	static constexpr uint32_t s_invalidIndex = std::numeric_limits<uint32_t>::max();
+
+	// FIFO cache simulated with timestamps, a vertex is cached while fewer than cacheSize misses happened since its own
+	class FifoCache {
+	public:
+		FifoCache(uint32_t vertexCount, uint32_t cacheSize)
+			: m_timestamps(vertexCount, 0), m_cacheSize(cacheSize), m_time(cacheSize + 1)
+		{
+		}
+
+		inline uint32_t Access(uint32_t vertex)
+		{
+			if (m_time - m_timestamps[vertex] > m_cacheSize) {
+				m_timestamps[vertex] = m_time++;
+				return 1;
+			}
+			return 0;
+		}
+
+		inline uint32_t AccessTriangle(const uint32_t* triangle) { return Access(triangle[0]) + Access(triangle[1]) + Access(triangle[2]); }
+
+		// Moving time past every stamp empties the cache
+		inline void Flush() { m_time += m_cacheSize + 1; }
+	private:
+		std::vector<uint32_t> m_timestamps;
+		uint32_t m_cacheSize;
+		uint32_t m_time;
+	};
+
+	MeshOptimizerStats MeshOptimizer::Optimize(MeshData& mesh)
+	{
+		MeshOptimizerStats stats;
+
+		for (const MeshFileSubmesh& submesh : mesh.submeshes) {
+			if (submesh.indexCount < 3 || submesh.vertexCount == 0) {
+				continue;
+			}
+
+			// Mesh indices are already local to their submesh
+			uint32_t* indices = mesh.indices.data() + submesh.firstIndex;
+			Vertex3d* vertices = mesh.vertices.data() + submesh.firstVertex;
+
+			stats.before += AnalyzeVertexCache(indices, submesh.indexCount, submesh.vertexCount);
+
+			OptimizeVertexCache(indices, submesh.indexCount, submesh.vertexCount);
+			// Accepts clusters up to 5% worse than the cache optimized order in exchange for less overdraw
+			OptimizeOverdraw(indices, submesh.indexCount, vertices, submesh.vertexCount, 1.05f);
+			OptimizeVertexFetch(indices, submesh.indexCount, vertices, submesh.vertexCount);
+
+			stats.after += AnalyzeVertexCache(indices, submesh.indexCount, submesh.vertexCount);
+		}
+
+		return stats;
+	}
+
+	VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount)
+	{
+		VertexCacheStats stats;
+		stats.triangles = indexCount / 3;
+
+		FifoCache cache(vertexCount, s_fifoCacheSize);
+		std::vector<uint8_t> referenced(vertexCount, 0);
+		for (uint32_t i = 0; i < stats.triangles * 3; ++i) {
+			stats.misses += cache.Access(indices[i]);
+			if (!referenced[indices[i]]) {
+				referenced[indices[i]] = 1;
+				++stats.vertices;
+			}
+		}
+
+		return stats;
+	}
+
+	float MeshOptimizer::GetVertexScore(int32_t cachePosition, uint32_t remainingTriangles)
+	{
+		// Vertices without triangles left never need to be picked again
+		if (remainingTriangles == 0) {
+			return -1.0f;
+		}
+
+		float score = 0.0f;
+		if (cachePosition >= 0) {
+			// The last triangle's vertices get a fixed score so it is not simply continued, which would strip
+			if (cachePosition < 3) {
+				score = s_lastTriangleScore;
+			}
+			else {
+				float scale = 1.0f / (s_lruCacheSize - 3);
+				score = std::pow(1.0f - (cachePosition - 3) * scale, s_cacheDecayPower);
+			}
+		}
+
+		// Boost vertices with few triangles left, finishing them removes them from consideration
+		score += s_valenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -s_valenceBoostPower);
+		return score;
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(uint32_t* indices, uint32_t indexCount, uint32_t vertexCount)
+	{
+		uint32_t triangleCount = indexCount / 3;
+		if (triangleCount == 0) {
+			return;
+		}
+
+		// Triangles using each vertex, compacted as triangles are emitted so only the remaining ones are visited
+		std::vector<uint32_t> remaining(vertexCount, 0);
+		for (uint32_t i = 0; i < triangleCount * 3; ++i) {
+			++remaining[indices[i]];
+		}
+
+		std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+		for (uint32_t v = 0; v < vertexCount; ++v) {
+			adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remaining[v];
+		}
+
+		std::vector<uint32_t> adjacency(triangleCount * 3);
+		{
+			std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (uint32_t i = 0; i < triangleCount * 3; ++i) {
+				adjacency[fill[indices[i]]++] = i / 3;
+			}
+		}
+
+		std::vector<int32_t> cachePositions(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount);
+		for (uint32_t v = 0; v < vertexCount; ++v) {
+			vertexScores[v] = GetVertexScore(-1, remaining[v]);
+		}
+
+		std::vector<float> triangleScores(triangleCount);
+		std::vector<uint8_t> emitted(triangleCount, 0);
+		uint32_t bestTriangle = 0;
+		for (uint32_t t = 0; t < triangleCount; ++t) {
+			const uint32_t* triangle = indices + t * 3;
+			triangleScores[t] = vertexScores[triangle[0]] + vertexScores[triangle[1]] + vertexScores[triangle[2]];
+			if (triangleScores[t] > triangleScores[bestTriangle]) {
+				bestTriangle = t;
+			}
+		}
+
+		std::vector<uint32_t> output(triangleCount * 3);
+		std::array<uint32_t, s_lruCacheSize + 3> cache;
+		std::array<uint32_t, s_lruCacheSize + 3> nextCache;
+		uint32_t cacheCount = 0;
+		uint32_t scanCursor = 0;
+
+		for (uint32_t outputTriangle = 0; outputTriangle < triangleCount; ++outputTriangle) {
+			// Nothing in the cache has triangles left, continue with the next unemitted one in input order
+			if (bestTriangle == s_invalidIndex) {
+				while (emitted[scanCursor]) {
+					++scanCursor;
+				}
+				bestTriangle = scanCursor;
+			}
+
+			const uint32_t* triangle = indices + bestTriangle * 3;
+			memcpy(output.data() + outputTriangle * 3, triangle, 3 * sizeof(uint32_t));
+			emitted[bestTriangle] = 1;
+
+			for (uint32_t k = 0; k < 3; ++k) {
+				uint32_t vertex = triangle[k];
+				uint32_t* vertexTriangles = adjacency.data() + adjacencyOffsets[vertex];
+				for (uint32_t i = 0; i < remaining[vertex]; ++i) {
+					if (vertexTriangles[i] == bestTriangle) {
+						vertexTriangles[i] = vertexTriangles[remaining[vertex] - 1];
+						--remaining[vertex];
+						break;
+					}
+				}
+			}
+
+			// The emitted vertices move to the front of the LRU cache, the rest shift back and may fall out
+			uint32_t nextCount = 0;
+			for (uint32_t k = 0; k < 3; ++k) {
+				if (std::find(nextCache.begin(), nextCache.begin() + nextCount, triangle[k]) == nextCache.begin() + nextCount) {
+					nextCache[nextCount++] = triangle[k];
+				}
+			}
+			for (uint32_t i = 0; i < cacheCount; ++i) {
+				uint32_t vertex = cache[i];
+				if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) {
+					nextCache[nextCount++] = vertex;
+				}
+			}
+
+			for (uint32_t i = 0; i < nextCount; ++i) {
+				cachePositions[nextCache[i]] = i < s_lruCacheSize ? static_cast<int32_t>(i) : -1;
+			}
+
+			// Triangle scores are sums of vertex scores, so only the change has to be applied to them
+			for (uint32_t i = 0; i < nextCount; ++i) {
+				uint32_t vertex = nextCache[i];
+				float score = GetVertexScore(cachePositions[vertex], remaining[vertex]);
+				float delta = score - vertexScores[vertex];
+				vertexScores[vertex] = score;
+
+				const uint32_t* vertexTriangles = adjacency.data() + adjacencyOffsets[vertex];
+				for (uint32_t j = 0; j < remaining[vertex]; ++j) {
+					triangleScores[vertexTriangles[j]] += delta;
+				}
+			}
+
+			cacheCount = std::min(nextCount, s_lruCacheSize);
+			std::copy(nextCache.begin(), nextCache.begin() + cacheCount, cache.begin());
+
+			// Only triangles touching the cache can have gained score
+			bestTriangle = s_invalidIndex;
+			float bestScore = -1.0f;
+			for (uint32_t i = 0; i < cacheCount; ++i) {
+				uint32_t vertex = cache[i];
+				const uint32_t* vertexTriangles = adjacency.data() + adjacencyOffsets[vertex];
+				for (uint32_t j = 0; j < remaining[vertex]; ++j) {
+					if (triangleScores[vertexTriangles[j]] > bestScore) {
+						bestScore = triangleScores[vertexTriangles[j]];
+						bestTriangle = vertexTriangles[j];
+					}
+				}
+			}
+		}
+
+		memcpy(indices, output.data(), output.size() * sizeof(uint32_t));
+	}
+
+	void MeshOptimizer::OptimizeOverdraw(uint32_t* indices, uint32_t indexCount, const Vertex3d* vertices, uint32_t vertexCount, float threshold)
+	{
+		uint32_t triangleCount = indexCount / 3;
+		if (triangleCount == 0) {
+			return;
+		}
+
+		FifoCache cache(vertexCount, s_fifoCacheSize);
+
+		// Hard boundaries are where the cache optimized order starts over, every vertex of the triangle misses
+		std::vector<uint32_t> hardBoundaries;
+		for (uint32_t t = 0; t < triangleCount; ++t) {
+			if (cache.AccessTriangle(indices + t * 3) == 3 || t == 0) {
+				hardBoundaries.push_back(t);
+			}
+		}
+		hardBoundaries.push_back(triangleCount);
+
+		// Each hard cluster is cut into the smallest pieces whose ACMR stays within threshold of the whole cluster
+		std::vector<uint32_t> clusterStarts;
+		for (size_t h = 0; h + 1 < hardBoundaries.size(); ++h) {
+			uint32_t start = hardBoundaries[h];
+			uint32_t end = hardBoundaries[h + 1];
+
+			cache.Flush();
+			uint32_t hardMisses = 0;
+			for (uint32_t t = start; t < end; ++t) {
+				hardMisses += cache.AccessTriangle(indices + t * 3);
+			}
+			float targetAcmr = threshold * static_cast<float>(hardMisses) / (end - start);
+
+			cache.Flush();
+			clusterStarts.push_back(start);
+			uint32_t clusterStart = start;
+			uint32_t clusterMisses = 0;
+			for (uint32_t t = start; t < end; ++t) {
+				clusterMisses += cache.AccessTriangle(indices + t * 3);
+				if (t + 1 < end && static_cast<float>(clusterMisses) / (t + 1 - clusterStart) <= targetAcmr) {
+					clusterStarts.push_back(t + 1);
+					clusterStart = t + 1;
+					clusterMisses = 0;
+					cache.Flush();
+				}
+			}
+		}
+		clusterStarts.push_back(triangleCount);
+
+		uint32_t clusterCount = static_cast<uint32_t>(clusterStarts.size()) - 1;
+		if (clusterCount < 2) {
+			return;
+		}
+
+		// Area weighted centroid and normal per cluster, and the centroid of the whole mesh
+		std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0.0f));
+		std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+		glm::vec3 meshCentroid(0.0f);
+		float meshArea = 0.0f;
+
+		for (uint32_t c = 0; c < clusterCount; ++c) {
+			float clusterArea = 0.0f;
+			for (uint32_t t = clusterStarts[c]; t < clusterStarts[c + 1]; ++t) {
+				const glm::vec3& p0 = vertices[indices[t * 3 + 0]].pos;
+				const glm::vec3& p1 = vertices[indices[t * 3 + 1]].pos;
+				const glm::vec3& p2 = vertices[indices[t * 3 + 2]].pos;
+
+				glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+				float area = glm::length(normal);
+
+				clusterCentroids[c] += (p0 + p1 + p2) * (area / 3.0f);
+				clusterNormals[c] += normal;
+				clusterArea += area;
+			}
+
+			meshCentroid += clusterCentroids[c];
+			meshArea += clusterArea;
+			clusterCentroids[c] = clusterArea > 0.0f ? clusterCentroids[c] / clusterArea : glm::vec3(0.0f);
+		}
+		meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : glm::vec3(0.0f);
+
+		// Clusters far out along their own normal face away from the rest of the mesh and occlude it from most views
+		std::vector<float> sortKeys(clusterCount);
+		for (uint32_t c = 0; c < clusterCount; ++c) {
+			float length = glm::length(clusterNormals[c]);
+			glm::vec3 normal = length > 0.0f ? clusterNormals[c] / length : glm::vec3(0.0f);
+			sortKeys[c] = glm::dot(clusterCentroids[c] - meshCentroid, normal);
+		}
+
+		std::vector<uint32_t> clusterOrder(clusterCount);
+		std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+		std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+		std::vector<uint32_t> output;
+		output.reserve(triangleCount * 3);
+		for (uint32_t c : clusterOrder) {
+			output.insert(output.end(), indices + clusterStarts[c] * 3, indices + clusterStarts[c + 1] * 3);
+		}
+
+		memcpy(indices, output.data(), output.size() * sizeof(uint32_t));
+	}
+
+	void MeshOptimizer::OptimizeVertexFetch(uint32_t* indices, uint32_t indexCount, Vertex3d* vertices, uint32_t vertexCount)
+	{
+		std::vector<uint32_t> remap(vertexCount, s_invalidIndex);
+		uint32_t nextVertex = 0;
+		for (uint32_t i = 0; i < indexCount; ++i) {
+			uint32_t& vertex = remap[indices[i]];
+			if (vertex == s_invalidIndex) {
+				vertex = nextVertex++;
+			}
+			indices[i] = vertex;
+		}
+
+		// Unreferenced vertices are kept so the submesh vertex range does not change
+		for (uint32_t& vertex : remap) {
+			if (vertex == s_invalidIndex) {
+				vertex = nextVertex++;
+			}
+		}
+
+		std::vector<Vertex3d> reordered(vertexCount);
+		for (uint32_t v = 0; v < vertexCount; ++v) {
+			reordered[remap[v]] = vertices[v];
+		}
+		std::copy(reordered.begin(), reordered.end(), vertices);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "engine/src/system/mesh_file.h"
+
+namespace mz {
+	// Post-transform vertex cache behaviour of an index buffer, simulated with a FIFO cache.
+	// Counts add up across buffers, so the stats of a whole mesh are the sum of its submeshes.
+	struct VertexCacheStats {
+		uint32_t misses = 0;
+		uint32_t triangles = 0;
+		// Distinct vertices the indices reference
+		uint32_t vertices = 0;
+
+		// Average cache miss ratio, transformed vertices per triangle. 0.5 is the ideal for large grids, 3 the worst case.
+		inline float GetAcmr() const { return triangles > 0 ? static_cast<float>(misses) / triangles : 0.0f; }
+		// Average transform to vertex ratio, 1 means every vertex is shaded exactly once
+		inline float GetAtvr() const { return vertices > 0 ? static_cast<float>(misses) / vertices : 0.0f; }
+
+		inline VertexCacheStats& operator+=(const VertexCacheStats& other)
+		{
+			misses += other.misses;
+			triangles += other.triangles;
+			vertices += other.vertices;
+			return *this;
+		}
+	};
+
+	struct MeshOptimizerStats {
+		VertexCacheStats before;
+		VertexCacheStats after;
+	};
+
+	// Reorders triangles and vertices of cooked meshes for the GPU. Every pass works on one submesh
+	// at a time with indices local to its vertex range, and none of them changes what is drawn.
+	class MeshOptimizer {
+	public:
+		// Runs the vertex cache, overdraw and vertex fetch passes on every submesh
+		static MeshOptimizerStats Optimize(MeshData& mesh);
+
+		static VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount);
+
+		// Forsyth's linear-speed vertex cache optimization, greedily emits the triangle whose vertices score highest in a simulated LRU cache
+		static void OptimizeVertexCache(uint32_t* indices, uint32_t indexCount, uint32_t vertexCount);
+		// Splits the cache optimized order into clusters whose cache efficiency stays within threshold of the original,
+		// then sorts the clusters so that the outward facing ones are drawn first and hide what lies behind them
+		static void OptimizeOverdraw(uint32_t* indices, uint32_t indexCount, const Vertex3d* vertices, uint32_t vertexCount, float threshold);
+		// Renumbers vertices in the order the indices first use them, unreferenced vertices move to the end
+		static void OptimizeVertexFetch(uint32_t* indices, uint32_t indexCount, Vertex3d* vertices, uint32_t vertexCount);
+	private:
+		static float GetVertexScore(int32_t cachePosition, uint32_t remainingTriangles);
+	};
+}
\ No newline at end of file
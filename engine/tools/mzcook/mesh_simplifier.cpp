@@ -0,0 +1,263 @@
+#include "mesh_simplifier.h"
+#include "engine/src/system/vertex_deduplicator.h"
+
+namespace mz {
+	// Largest turn a collapse may give a triangle's normal, about 75 degrees. Rejecting only actual flips lets
+	// consecutive passes turn slivers over one step at a time.
+	static constexpr float s_minNormalCosine = 0.25f;
+
+	void MeshSimplifier::Quadric::AddPlane(const glm::vec3& normal, float distance, float area)
+	{
+		double x = normal.x, y = normal.y, z = normal.z, d = distance, w = area;
+		a00 += w * x * x; a01 += w * x * y; a02 += w * x * z;
+		a11 += w * y * y; a12 += w * y * z; a22 += w * z * z;
+		b0 += w * x * d; b1 += w * y * d; b2 += w * z * d;
+		c += w * d * d;
+		weight += w;
+	}
+
+	MeshSimplifier::Quadric& MeshSimplifier::Quadric::operator+=(const Quadric& other)
+	{
+		a00 += other.a00; a01 += other.a01; a02 += other.a02;
+		a11 += other.a11; a12 += other.a12; a22 += other.a22;
+		b0 += other.b0; b1 += other.b1; b2 += other.b2;
+		c += other.c;
+		weight += other.weight;
+		return *this;
+	}
+
+	double MeshSimplifier::Quadric::Evaluate(const glm::vec3& position) const
+	{
+		double x = position.x, y = position.y, z = position.z;
+		double result = a00 * x * x + a11 * y * y + a22 * z * z
+			+ 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+			+ 2.0 * (b0 * x + b1 * y + b2 * z)
+			+ c;
+		// Rounding can push the sum of squares slightly below zero
+		return std::max(result, 0.0);
+	}
+
+	float MeshSimplifier::Simplify(const uint32_t* indices, uint32_t indexCount, const Vertex3d* vertices, uint32_t vertexCount,
+		uint32_t targetIndexCount, std::vector<uint32_t>& outIndices)
+	{
+		outIndices.assign(indices, indices + indexCount - indexCount % 3);
+		if (outIndices.size() <= targetIndexCount) {
+			return 0.0f;
+		}
+
+		std::vector<uint8_t> locked;
+		FindLockedVertices(outIndices.data(), static_cast<uint32_t>(outIndices.size()), vertices, vertexCount, locked);
+
+		std::vector<Quadric> quadrics(vertexCount);
+		for (size_t i = 0; i < outIndices.size(); i += 3) {
+			const glm::vec3& p0 = vertices[outIndices[i + 0]].pos;
+			const glm::vec3& p1 = vertices[outIndices[i + 1]].pos;
+			const glm::vec3& p2 = vertices[outIndices[i + 2]].pos;
+
+			glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+			float length = glm::length(cross);
+			if (length <= 0.0f) {
+				continue;
+			}
+
+			glm::vec3 normal = cross / length;
+			Quadric plane;
+			plane.AddPlane(normal, -glm::dot(normal, p0), 0.5f * length);
+			for (uint32_t corner = 0; corner < 3; ++corner) {
+				quadrics[outIndices[i + corner]] += plane;
+			}
+		}
+
+		// Cost of moving source onto target, the mean squared distance to both vertices' planes
+		auto getCost = [&](uint32_t source, uint32_t target) {
+			Quadric combined = quadrics[source];
+			combined += quadrics[target];
+			return combined.weight > 0.0 ? static_cast<float>(combined.Evaluate(vertices[target].pos) / combined.weight) : 0.0f;
+		};
+
+		std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+		std::vector<uint32_t> vertexTriangles;
+		std::vector<Collapse> collapses;
+		std::vector<uint32_t> remap(vertexCount);
+		// Vertices a collapse of this pass has moved or whose triangles it changed, they wait for the next pass
+		std::vector<uint8_t> touched(vertexCount);
+
+		float maxCost = 0.0f;
+		uint32_t targetTriangles = targetIndexCount / 3;
+
+		// Every pass ranks all edges once and performs the cheapest independent collapses
+		while (outIndices.size() / 3 > targetTriangles) {
+			uint32_t triangleCount = static_cast<uint32_t>(outIndices.size() / 3);
+
+			// Triangles around every vertex
+			std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+			for (uint32_t index : outIndices) {
+				++triangleOffsets[index + 1];
+			}
+			for (uint32_t v = 0; v < vertexCount; ++v) {
+				triangleOffsets[v + 1] += triangleOffsets[v];
+			}
+			vertexTriangles.resize(outIndices.size());
+			std::vector<uint32_t> cursor(triangleOffsets.begin(), triangleOffsets.end() - 1);
+			for (uint32_t i = 0; i < outIndices.size(); ++i) {
+				vertexTriangles[cursor[outIndices[i]]++] = i / 3;
+			}
+
+			// Interior edges are seen from both triangles, the index order picks one of the two
+			collapses.clear();
+			for (uint32_t i = 0; i < outIndices.size(); i += 3) {
+				for (uint32_t corner = 0; corner < 3; ++corner) {
+					uint32_t a = outIndices[i + corner];
+					uint32_t b = outIndices[i + (corner + 1) % 3];
+					if (a > b) {
+						continue;
+					}
+
+					float costAB = locked[a] ? std::numeric_limits<float>::max() : getCost(a, b);
+					float costBA = locked[b] ? std::numeric_limits<float>::max() : getCost(b, a);
+					if (costAB == std::numeric_limits<float>::max() && costBA == std::numeric_limits<float>::max()) {
+						continue;
+					}
+
+					collapses.push_back(costAB <= costBA ? Collapse{ a, b, costAB } : Collapse{ b, a, costBA });
+				}
+			}
+
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& left, const Collapse& right) { return left.cost < right.cost; });
+
+			std::iota(remap.begin(), remap.end(), 0);
+			std::fill(touched.begin(), touched.end(), 0);
+
+			uint32_t remainingTriangles = triangleCount;
+			uint32_t collapseCount = 0;
+			for (const Collapse& collapse : collapses) {
+				if (remainingTriangles <= targetTriangles) {
+					break;
+				}
+
+				if (touched[collapse.source] || touched[collapse.target]) {
+					continue;
+				}
+
+				const uint32_t* triangles = vertexTriangles.data() + triangleOffsets[collapse.source];
+				uint32_t count = triangleOffsets[collapse.source + 1] - triangleOffsets[collapse.source];
+				if (FlipsTriangles(outIndices, triangles, count, vertices, collapse.source, collapse.target)) {
+					continue;
+				}
+
+				// Triangles sharing the edge degenerate, the rest of the fan is reattached to the target
+				for (uint32_t t = 0; t < count; ++t) {
+					const uint32_t* triangle = outIndices.data() + triangles[t] * 3;
+					if (triangle[0] == collapse.target || triangle[1] == collapse.target || triangle[2] == collapse.target) {
+						--remainingTriangles;
+					}
+					touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+				}
+
+				remap[collapse.source] = collapse.target;
+				quadrics[collapse.target] += quadrics[collapse.source];
+				maxCost = std::max(maxCost, collapse.cost);
+				++collapseCount;
+			}
+
+			if (collapseCount == 0) {
+				break;
+			}
+
+			// No target moved in the same pass, so one remap step is enough
+			size_t writeIndex = 0;
+			for (size_t i = 0; i < outIndices.size(); i += 3) {
+				uint32_t a = remap[outIndices[i + 0]];
+				uint32_t b = remap[outIndices[i + 1]];
+				uint32_t c = remap[outIndices[i + 2]];
+				if (a == b || b == c || c == a) {
+					continue;
+				}
+
+				outIndices[writeIndex++] = a;
+				outIndices[writeIndex++] = b;
+				outIndices[writeIndex++] = c;
+			}
+			outIndices.resize(writeIndex);
+		}
+
+		return glm::sqrt(maxCost);
+	}
+
+	void MeshSimplifier::FindLockedVertices(const uint32_t* indices, uint32_t indexCount, const Vertex3d* vertices, uint32_t vertexCount,
+		std::vector<uint8_t>& outLocked)
+	{
+		outLocked.assign(vertexCount, 0);
+
+		// Vertices differing only in their attributes share a position, edges are matched by position so seams do not look open
+		std::vector<glm::vec3> positions;
+		std::vector<uint32_t> positionIds(vertexCount);
+		VertexDeduplicator<glm::vec3> deduplicator(positions, vertexCount);
+		for (uint32_t v = 0; v < vertexCount; ++v) {
+			positionIds[v] = deduplicator.Add(vertices[v].pos);
+		}
+
+		std::vector<uint32_t> positionUses(positions.size(), 0);
+		for (uint32_t v = 0; v < vertexCount; ++v) {
+			++positionUses[positionIds[v]];
+		}
+
+		for (uint32_t v = 0; v < vertexCount; ++v) {
+			if (positionUses[positionIds[v]] > 1) {
+				outLocked[v] = 1;
+			}
+		}
+
+		// Every edge once per triangle using it, closed manifold edges show up exactly twice
+		std::vector<uint64_t> edges;
+		edges.reserve(indexCount);
+		for (uint32_t i = 0; i + 2 < indexCount; i += 3) {
+			for (uint32_t corner = 0; corner < 3; ++corner) {
+				uint64_t a = positionIds[indices[i + corner]];
+				uint64_t b = positionIds[indices[i + (corner + 1) % 3]];
+				edges.push_back(std::min(a, b) << 32 | std::max(a, b));
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+
+		for (uint32_t i = 0; i + 2 < indexCount; i += 3) {
+			for (uint32_t corner = 0; corner < 3; ++corner) {
+				uint32_t vertexA = indices[i + corner];
+				uint32_t vertexB = indices[i + (corner + 1) % 3];
+				uint64_t a = positionIds[vertexA];
+				uint64_t b = positionIds[vertexB];
+				uint64_t edge = std::min(a, b) << 32 | std::max(a, b);
+
+				auto range = std::equal_range(edges.begin(), edges.end(), edge);
+				if (range.second - range.first != 2) {
+					outLocked[vertexA] = outLocked[vertexB] = 1;
+				}
+			}
+		}
+	}
+
+	bool MeshSimplifier::FlipsTriangles(const std::vector<uint32_t>& indices, const uint32_t* triangles, uint32_t triangleCount,
+		const Vertex3d* vertices, uint32_t source, uint32_t target)
+	{
+		for (uint32_t t = 0; t < triangleCount; ++t) {
+			const uint32_t* triangle = indices.data() + triangles[t] * 3;
+			if (triangle[0] == target || triangle[1] == target || triangle[2] == target) {
+				continue;
+			}
+
+			glm::vec3 before[3], after[3];
+			for (uint32_t corner = 0; corner < 3; ++corner) {
+				before[corner] = vertices[triangle[corner]].pos;
+				after[corner] = vertices[triangle[corner] == source ? target : triangle[corner]].pos;
+			}
+
+			glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+			glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+			if (glm::dot(normalBefore, normalAfter) <= s_minNormalCosine * glm::length(normalBefore) * glm::length(normalAfter)) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
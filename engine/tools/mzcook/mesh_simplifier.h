@@ -0,0 +1,45 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "engine/src/system/mesh_file.h"
+
+namespace mz {
+	// Quadric error metric simplification (Garland and Heckbert). Edges are collapsed onto one of their
+	// endpoints, so the simplified indices reference a subset of the original vertices and every LOD of
+	// a submesh shares its vertex range. Vertices on open borders and attribute seams stay in place,
+	// which keeps submeshes that were split apart and UV islands closed.
+	class MeshSimplifier {
+	public:
+		// Collapses the cheapest edges until at most targetIndexCount indices are left or no collapse is possible.
+		// Returns the geometric error in object space units: the root of the largest area weighted mean squared
+		// distance a collapsed vertex ended up from the planes of the triangles it absorbed.
+		static float Simplify(const uint32_t* indices, uint32_t indexCount, const Vertex3d* vertices, uint32_t vertexCount,
+			uint32_t targetIndexCount, std::vector<uint32_t>& outIndices);
+	private:
+		// Symmetric 4x4 matrix of the summed squared plane distances, doubles keep large meshes stable
+		struct Quadric {
+			double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+			double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+			double c = 0.0;
+			// Summed triangle area, normalizes the error to a mean squared distance
+			double weight = 0.0;
+
+			void AddPlane(const glm::vec3& normal, float distance, float area);
+			Quadric& operator+=(const Quadric& other);
+			double Evaluate(const glm::vec3& position) const;
+		};
+
+		struct Collapse {
+			uint32_t source;
+			uint32_t target;
+			float cost;
+		};
+
+		// Marks vertices that must not move: on an open or non-manifold edge, or sharing their position with another vertex
+		static void FindLockedVertices(const uint32_t* indices, uint32_t indexCount, const Vertex3d* vertices, uint32_t vertexCount,
+			std::vector<uint8_t>& outLocked);
+		// True when moving source onto target turns a remaining triangle around source over, or close to it
+		static bool FlipsTriangles(const std::vector<uint32_t>& indices, const uint32_t* triangles, uint32_t triangleCount,
+			const Vertex3d* vertices, uint32_t source, uint32_t target);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "meshlet_builder.h"
+
+namespace mz {
+	uint32_t MeshletBuilder::Build(MeshData& mesh)
+	{
+		mesh.meshlets.clear();
+		if (mesh.lods.empty()) {
+			mesh.lods.push_back(MeshFileLod{ 0, static_cast<uint32_t>(mesh.submeshes.size()), static_cast<uint32_t>(mesh.indices.size()), 0.0f });
+		}
+
+		// A vertex belongs to the meshlet being built while its stamp matches, no clearing between meshlets
+		std::vector<uint32_t> vertexStamps(mesh.vertices.size(), 0);
+		uint32_t stamp = 0;
+
+		for (MeshFileLod& lod : mesh.lods) {
+			lod.firstMeshlet = static_cast<uint32_t>(mesh.meshlets.size());
+			for (uint32_t i = lod.firstSubmesh; i < lod.firstSubmesh + lod.submeshCount; ++i) {
+				BuildSubmesh(mesh, mesh.submeshes[i], vertexStamps, stamp, mesh.meshlets);
+			}
+			lod.meshletCount = static_cast<uint32_t>(mesh.meshlets.size()) - lod.firstMeshlet;
+		}
+
+		return static_cast<uint32_t>(mesh.meshlets.size());
+	}
+
+	void MeshletBuilder::BuildSubmesh(const MeshData& mesh, const MeshFileSubmesh& submesh, std::vector<uint32_t>& vertexStamps,
+		uint32_t& stamp, std::vector<Meshlet>& outMeshlets)
+	{
+		const uint32_t* indices = mesh.indices.data() + submesh.firstIndex;
+		const Vertex3d* vertices = mesh.vertices.data() + submesh.firstVertex;
+
+		auto finish = [&](Meshlet& meshlet) {
+			ComputeBounds(mesh.indices.data() + meshlet.firstIndex, vertices, meshlet);
+			outMeshlets.push_back(meshlet);
+		};
+
+		Meshlet meshlet{};
+		++stamp;
+
+		for (uint32_t i = 0; i + 2 < submesh.indexCount; i += 3) {
+			uint32_t a = submesh.firstVertex + indices[i + 0];
+			uint32_t b = submesh.firstVertex + indices[i + 1];
+			uint32_t c = submesh.firstVertex + indices[i + 2];
+
+			uint32_t newVertices = (vertexStamps[a] != stamp ? 1 : 0)
+				+ (vertexStamps[b] != stamp && b != a ? 1 : 0)
+				+ (vertexStamps[c] != stamp && c != a && c != b ? 1 : 0);
+
+			if (meshlet.indexCount > 0
+				&& (meshlet.vertexCount + newVertices > s_maxMeshletVertices || meshlet.indexCount / 3 == s_maxMeshletTriangles)) {
+				finish(meshlet);
+				meshlet = Meshlet{};
+				++stamp;
+			}
+
+			if (meshlet.indexCount == 0) {
+				meshlet.firstIndex = submesh.firstIndex + i;
+				meshlet.firstVertex = submesh.firstVertex;
+			}
+
+			for (uint32_t vertex : { a, b, c }) {
+				if (vertexStamps[vertex] != stamp) {
+					vertexStamps[vertex] = stamp;
+					++meshlet.vertexCount;
+				}
+			}
+			meshlet.indexCount += 3;
+		}
+
+		if (meshlet.indexCount > 0) {
+			finish(meshlet);
+		}
+	}
+
+	void MeshletBuilder::ComputeBounds(const uint32_t* indices, const Vertex3d* vertices, Meshlet& meshlet)
+	{
+		glm::vec3 boundsMin(std::numeric_limits<float>::max());
+		glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+		for (uint32_t i = 0; i < meshlet.indexCount; ++i) {
+			boundsMin = glm::min(boundsMin, vertices[indices[i]].pos);
+			boundsMax = glm::max(boundsMax, vertices[indices[i]].pos);
+		}
+
+		meshlet.center = (boundsMin + boundsMax) * 0.5f;
+		meshlet.radius = 0.0f;
+		for (uint32_t i = 0; i < meshlet.indexCount; ++i) {
+			meshlet.radius = std::max(meshlet.radius, glm::length(vertices[indices[i]].pos - meshlet.center));
+		}
+
+		// The axis averages the unit normals, the cone then has to reach the normal furthest from it
+		std::array<glm::vec3, s_maxMeshletTriangles> normals;
+		uint32_t normalCount = 0;
+		glm::vec3 axis(0.0f);
+		for (uint32_t i = 0; i + 2 < meshlet.indexCount; i += 3) {
+			const glm::vec3& p0 = vertices[indices[i + 0]].pos;
+			const glm::vec3& p1 = vertices[indices[i + 1]].pos;
+			const glm::vec3& p2 = vertices[indices[i + 2]].pos;
+
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float length = glm::length(normal);
+			if (length <= 0.0f) {
+				continue;
+			}
+
+			normals[normalCount++] = normal / length;
+			axis += normal / length;
+		}
+
+		meshlet.coneAxis = glm::vec3(0.0f);
+		meshlet.coneCutoff = 1.0f;
+
+		float axisLength = glm::length(axis);
+		if (normalCount == 0 || axisLength <= 0.0f) {
+			return;
+		}
+
+		axis /= axisLength;
+		float minCosine = 1.0f;
+		for (uint32_t i = 0; i < normalCount; ++i) {
+			minCosine = std::min(minCosine, glm::dot(normals[i], axis));
+		}
+
+		if (minCosine <= s_minConeCosine) {
+			return;
+		}
+
+		// Viewing directions closer to the axis than 90 degrees minus the cone's half angle see only back faces,
+		// the cutoff is the cosine of that angle: cos(90 - angle) = sin(angle)
+		meshlet.coneAxis = axis;
+		meshlet.coneCutoff = glm::sqrt(1.0f - minCosine * minCosine);
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "engine/src/system/mesh_file.h"
+
+namespace mz {
+	// Splits submeshes into meshlets for GPU cluster culling. Triangles are taken in index order, so every meshlet
+	// is a consecutive index range that draws without any reordering, and the vertex cache order the optimizer
+	// produced keeps the meshlets spatially compact.
+	class MeshletBuilder {
+	public:
+		// Replaces the meshlets of every LOD, the LODs' meshlet runs follow their order. Expects full precision
+		// vertices and final index ranges. Returns the number of meshlets built.
+		static uint32_t Build(MeshData& mesh);
+	private:
+		// Appends the meshlets covering the submesh's index range
+		static void BuildSubmesh(const MeshData& mesh, const MeshFileSubmesh& submesh, std::vector<uint32_t>& vertexStamps,
+			uint32_t& stamp, std::vector<Meshlet>& outMeshlets);
+		// Bounding sphere and normal cone over the meshlet's triangles
+		static void ComputeBounds(const uint32_t* indices, const Vertex3d* vertices, Meshlet& meshlet);
+
+		// Cones with a triangle further than this cosine, about 84 degrees, from their axis cover close to a
+		// hemisphere and would hardly ever cull, they are stored as never culling
+		static constexpr float s_minConeCosine = 0.1f;
+	};
+}
\ No newline at end of file
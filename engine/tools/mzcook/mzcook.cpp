@@ -0,0 +1,278 @@
+// Offline asset cooker.
+// Converts assets/models and assets/textures into the cooked runtime formats and writes the
+// manifest the engine loads at startup. Inputs whose content hash matches the previous manifest
+// are skipped, everything else is cooked in parallel.
+// Assets that fail to cook are reported and left to the runtime import, only manifest and output directory
+// failures make the exit code nonzero unless --strict is passed.
+//
+// Usage: mzcook [input root] [output root] [--force] [--strict] [--jobs N] [--uncompressed] [--float-vertices]
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <numeric>
+#include <thread>
+
+#include "engine/src/mzpch.h"
+#include "engine/src/core/log.h"
+#include "engine/src/core/log.cpp"
+#include "engine/src/core/utils.h"
+#include "engine/src/system/mapped_file.h"
+#include "engine/src/system/mapped_file.cpp"
+#include "engine/src/system/mesh_file.h"
+#include "engine/src/system/mesh_file.cpp"
+#include "engine/src/system/mesh_importer.h"
+#include "engine/src/system/mesh_importer.cpp"
+#include "engine/src/system/texture_file.h"
+#include "engine/src/system/texture_file.cpp"
+#include "engine/src/system/asset_manifest.h"
+#include "engine/src/system/asset_manifest.cpp"
+#include "mesh_optimizer.h"
+#include "mesh_optimizer.cpp"
+#include "mesh_simplifier.h"
+#include "mesh_simplifier.cpp"
+#include "meshlet_builder.h"
+#include "meshlet_builder.cpp"
+#include "vertex_packer.h"
+#include "vertex_packer.cpp"
+#include "mesh_cooker.h"
+#include "mesh_cooker.cpp"
+#include "block_compressor.h"
+#include "block_compressor.cpp"
+#include "texture_cooker.h"
+#include "texture_cooker.cpp"
+
+namespace fs = std::filesystem;
+
+namespace mz {
+	// Bump when a cooking pass changes its output without a file format version change
+	static constexpr uint64_t s_cookerVersion = 3;
+
+	enum class CookAssetType {
+		Mesh, Texture
+	};
+
+	struct CookJob {
+		CookAssetType type;
+		fs::path sourcePath;
+		// Manifest key, e.g. "models/tower2.fbx"
+		std::string sourceName;
+		// Relative to the output root, e.g. "models/tower2.mzmesh"
+		std::string cookedPath;
+
+		enum class Result { Pending, Cooked, Skipped, Failed } result = Result::Pending;
+		uint64_t contentHash = 0;
+	};
+
+	struct CookOptions {
+		bool force = false;
+		// Fails the run when any single asset fails to cook
+		bool strict = false;
+		// Keeps textures in RGBA8 instead of block compressing them
+		bool uncompressed = false;
+		// Keeps large meshes in full precision instead of packing their vertices
+		bool floatVertices = false;
+	};
+
+	static uint64_t GetFormatSalt(CookAssetType type, const CookOptions& options)
+	{
+		uint64_t formatVersion = type == CookAssetType::Mesh ? s_meshFileVersion : s_textureFileVersion;
+		bool optionSet = type == CookAssetType::Texture ? options.uncompressed : options.floatVertices;
+		uint64_t optionBits = optionSet ? 1 : 0;
+		return (s_cookerVersion << 32) ^ (optionBits << 16) ^ (formatVersion << 8) ^ static_cast<uint64_t>(type);
+	}
+
+	static void CollectJobs(const fs::path& inputRoot, const std::string& directory, CookAssetType type,
+		const std::set<std::string>& extensions, const std::string& cookedExtension, std::vector<CookJob>& jobs)
+	{
+		fs::path root = inputRoot / directory;
+		if (!fs::exists(root)) {
+			return;
+		}
+
+		for (const auto& entry : fs::recursive_directory_iterator(root)) {
+			if (!entry.is_regular_file()) {
+				continue;
+			}
+
+			std::string extension = entry.path().extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			if (extensions.count(extension) == 0) {
+				continue;
+			}
+
+			fs::path relative = fs::relative(entry.path(), root);
+
+			CookJob job;
+			job.type = type;
+			job.sourcePath = entry.path();
+			job.sourceName = directory + "/" + relative.generic_string();
+			job.cookedPath = directory + "/" + fs::path(relative).replace_extension(cookedExtension).generic_string();
+			jobs.push_back(std::move(job));
+		}
+	}
+
+	static bool CookAsset(const CookJob& job, const MappedFile& source, const fs::path& outputPath, const CookOptions& options)
+	{
+		switch (job.type) {
+		case CookAssetType::Mesh: {
+			MeshData mesh;
+			return MeshCooker::Cook(job.sourcePath.string(), !options.floatVertices, mesh) && WriteMeshFile(outputPath.string(), mesh);
+		}
+		case CookAssetType::Texture: {
+			TextureData texture;
+			return TextureCooker::Cook(source.GetData(), source.GetSize(), !options.uncompressed, texture) && WriteTextureFile(outputPath.string(), texture);
+		}
+		}
+
+		return false;
+	}
+
+	static void ProcessJob(CookJob& job, const AssetManifest& previousManifest, const fs::path& outputRoot, const CookOptions& options)
+	{
+		MappedFile source;
+		if (!source.Open(job.sourcePath.string())) {
+			MZ_CORE_ERROR("Failed to open {0}", job.sourcePath.string());
+			job.result = CookJob::Result::Failed;
+			return;
+		}
+
+		job.contentHash = HashBytes(source.GetData(), source.GetSize(), GetFormatSalt(job.type, options));
+
+		fs::path outputPath = outputRoot / job.cookedPath;
+
+		const AssetManifestEntry* previous = previousManifest.Find(job.sourceName);
+		if (!options.force && previous && previous->contentHash == job.contentHash && previous->cookedPath == job.cookedPath && fs::exists(outputPath)) {
+			job.result = CookJob::Result::Skipped;
+			return;
+		}
+
+		std::error_code error;
+		fs::create_directories(outputPath.parent_path(), error);
+
+		auto startTime = std::chrono::high_resolution_clock::now();
+
+		if (!CookAsset(job, source, outputPath, options)) {
+			MZ_CORE_ERROR("Failed to cook {0}", job.sourceName);
+			job.result = CookJob::Result::Failed;
+			return;
+		}
+
+		auto endTime = std::chrono::high_resolution_clock::now();
+		MZ_CORE_INFO("Cooked {0} in {1} ms", job.sourceName, std::chrono::duration<float, std::chrono::milliseconds::period>(endTime - startTime).count());
+
+		job.result = CookJob::Result::Cooked;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	using namespace mz;
+
+	Log::Init();
+
+	fs::path inputRoot = "assets";
+	fs::path outputRoot;
+	CookOptions options;
+	uint32_t jobCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	std::vector<std::string> positional;
+	for (int i = 1; i < argc; ++i) {
+		std::string argument = argv[i];
+		if (argument == "--force") {
+			options.force = true;
+		}
+		else if (argument == "--strict") {
+			options.strict = true;
+		}
+		else if (argument == "--uncompressed") {
+			options.uncompressed = true;
+		}
+		else if (argument == "--float-vertices") {
+			options.floatVertices = true;
+		}
+		else if (argument == "--jobs" && i + 1 < argc) {
+			jobCount = std::max(static_cast<uint32_t>(std::stoul(argv[++i])), 1u);
+		}
+		else {
+			positional.push_back(argument);
+		}
+	}
+
+	if (positional.size() > 0) {
+		inputRoot = positional[0];
+	}
+	outputRoot = positional.size() > 1 ? fs::path(positional[1]) : inputRoot / "cooked";
+
+	std::vector<CookJob> jobs;
+	CollectJobs(inputRoot, "models", CookAssetType::Mesh, { ".fbx", ".obj", ".gltf", ".glb", ".dae", ".3ds" }, ".mzmesh", jobs);
+	CollectJobs(inputRoot, "textures", CookAssetType::Texture, { ".png", ".jpg", ".jpeg", ".tga", ".bmp" }, ".mztex", jobs);
+
+	fs::path manifestPath = outputRoot / AssetManifest::s_fileName;
+	AssetManifest previousManifest;
+	previousManifest.Load(manifestPath.string());
+
+	MZ_CORE_INFO("Cooking {0} assets from {1} to {2} on {3} threads", jobs.size(), inputRoot.string(), outputRoot.string(), jobCount);
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	// Workers pull jobs from a shared counter, each job only touches its own record
+	std::atomic<size_t> nextJob = 0;
+	auto worker = [&]() {
+		for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+			ProcessJob(jobs[i], previousManifest, outputRoot, options);
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (uint32_t i = 1; i < std::min<size_t>(jobCount, jobs.size()); ++i) {
+		workers.emplace_back(worker);
+	}
+	worker();
+	for (std::thread& thread : workers) {
+		thread.join();
+	}
+
+	// Failed assets are left out so the runtime falls back to importing the source
+	AssetManifest manifest;
+	uint32_t cooked = 0, skipped = 0, failed = 0;
+	for (const CookJob& job : jobs) {
+		switch (job.result) {
+		case CookJob::Result::Cooked: ++cooked; break;
+		case CookJob::Result::Skipped: ++skipped; break;
+		default: ++failed; continue;
+		}
+
+		AssetManifestEntry entry;
+		entry.contentHash = job.contentHash;
+		entry.cookedPath = job.cookedPath;
+		manifest.Set(job.sourceName, entry);
+	}
+
+	std::error_code error;
+	fs::create_directories(outputRoot, error);
+	if (error) {
+		MZ_CORE_ERROR("Failed to create output directory {0}: {1}", outputRoot.string(), error.message());
+		return 1;
+	}
+	if (!manifest.Save(manifestPath.string())) {
+		return 1;
+	}
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+	MZ_CORE_INFO("Cooked {0}, skipped {1} unchanged, {2} failed in {3} ms", cooked, skipped, failed,
+		std::chrono::duration<float, std::chrono::milliseconds::period>(endTime - startTime).count());
+
+	if (failed > 0) {
+		MZ_CORE_WARN("{0} assets failed to cook, the engine imports them from source:", failed);
+		for (const CookJob& job : jobs) {
+			if (job.result == CookJob::Result::Failed) {
+				MZ_CORE_WARN("  {0}", job.sourceName);
+			}
+		}
+	}
+
+	// One broken source asset should not break the build that depends on the cook
+	return options.strict && failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+#include "texture_cooker.h"
+#include "block_compressor.h"
+
+namespace mz {
+	static float SrgbToLinear(uint8_t value)
+	{
+		static const std::array<float, 256> table = [] {
+			std::array<float, 256> result{};
+			for (int i = 0; i < 256; ++i) {
+				float c = i / 255.0f;
+				result[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+			}
+			return result;
+		}();
+
+		return table[value];
+	}
+
+	static uint8_t LinearToSrgb(float value)
+	{
+		float c = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+		return static_cast<uint8_t>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+	}
+
+	bool TextureCooker::Cook(const uint8_t* fileData, size_t fileSize, bool compress, TextureData& outTexture)
+	{
+		int32_t width, height, channels;
+		stbi_uc* pixels = stbi_load_from_memory(fileData, static_cast<int>(fileSize), &width, &height, &channels, STBI_rgb_alpha);
+		if (!pixels) {
+			MZ_CORE_ERROR("Failed to decode image: {0}", stbi_failure_reason());
+			return false;
+		}
+
+		outTexture.format = TextureFormat::RGBA8_SRGB;
+		outTexture.width = static_cast<uint32_t>(width);
+		outTexture.height = static_cast<uint32_t>(height);
+		outTexture.levels.clear();
+
+		// Level sizes for the whole chain down to 1x1
+		uint32_t levelWidth = outTexture.width;
+		uint32_t levelHeight = outTexture.height;
+		uint64_t totalSize = 0;
+		while (true) {
+			TextureFileLevel level{};
+			level.width = levelWidth;
+			level.height = levelHeight;
+			level.offset = totalSize;
+			level.size = uint64_t(levelWidth) * levelHeight * 4;
+			outTexture.levels.push_back(level);
+			totalSize += level.size;
+
+			if (levelWidth == 1 && levelHeight == 1) {
+				break;
+			}
+			levelWidth = std::max(levelWidth / 2, 1u);
+			levelHeight = std::max(levelHeight / 2, 1u);
+		}
+
+		outTexture.pixels.resize(totalSize);
+		memcpy(outTexture.pixels.data(), pixels, outTexture.levels[0].size);
+		stbi_image_free(pixels);
+
+		for (size_t i = 1; i < outTexture.levels.size(); ++i) {
+			const TextureFileLevel& source = outTexture.levels[i - 1];
+			const TextureFileLevel& level = outTexture.levels[i];
+			Downsample(outTexture.pixels.data() + source.offset, source.width, source.height,
+				outTexture.pixels.data() + level.offset, level.width, level.height);
+		}
+
+		if (compress) {
+			bool opaque = true;
+			for (uint64_t i = 3; i < outTexture.levels[0].size && opaque; i += 4) {
+				opaque = outTexture.pixels[i] == 255;
+			}
+
+			CompressLevels(opaque ? TextureFormat::BC1_RGB_SRGB : TextureFormat::BC3_SRGB, outTexture);
+		}
+
+		return true;
+	}
+
+	void TextureCooker::CompressLevels(TextureFormat format, TextureData& texture)
+	{
+		std::vector<TextureFileLevel> levels = texture.levels;
+		uint64_t totalSize = 0;
+		for (TextureFileLevel& level : levels) {
+			level.offset = totalSize;
+			level.size = GetTextureLevelSize(format, level.width, level.height);
+			totalSize += level.size;
+		}
+
+		std::vector<uint8_t> pixels(totalSize);
+		for (size_t i = 0; i < levels.size(); ++i) {
+			const uint8_t* source = texture.pixels.data() + texture.levels[i].offset;
+			uint8_t* destination = pixels.data() + levels[i].offset;
+
+			if (format == TextureFormat::BC1_RGB_SRGB) {
+				BlockCompressor::CompressBC1(source, levels[i].width, levels[i].height, destination);
+			}
+			else {
+				BlockCompressor::CompressBC3(source, levels[i].width, levels[i].height, destination);
+			}
+		}
+
+		texture.format = format;
+		texture.levels = std::move(levels);
+		texture.pixels = std::move(pixels);
+	}
+
+	void TextureCooker::Downsample(const uint8_t* source, uint32_t sourceWidth, uint32_t sourceHeight, uint8_t* destination, uint32_t width, uint32_t height)
+	{
+		for (uint32_t y = 0; y < height; ++y) {
+			uint32_t y0 = std::min(y * 2, sourceHeight - 1);
+			uint32_t y1 = std::min(y * 2 + 1, sourceHeight - 1);
+
+			for (uint32_t x = 0; x < width; ++x) {
+				uint32_t x0 = std::min(x * 2, sourceWidth - 1);
+				uint32_t x1 = std::min(x * 2 + 1, sourceWidth - 1);
+
+				const uint8_t* texels[4] = {
+					source + (size_t(y0) * sourceWidth + x0) * 4,
+					source + (size_t(y0) * sourceWidth + x1) * 4,
+					source + (size_t(y1) * sourceWidth + x0) * 4,
+					source + (size_t(y1) * sourceWidth + x1) * 4
+				};
+
+				uint8_t* out = destination + (size_t(y) * width + x) * 4;
+
+				// Color is averaged in linear space, alpha is linear already
+				for (int c = 0; c < 3; ++c) {
+					float sum = 0.0f;
+					for (const uint8_t* texel : texels) {
+						sum += SrgbToLinear(texel[c]);
+					}
+					out[c] = LinearToSrgb(sum * 0.25f);
+				}
+
+				uint32_t alpha = 0;
+				for (const uint8_t* texel : texels) {
+					alpha += texel[3];
+				}
+				out[3] = static_cast<uint8_t>((alpha + 2) / 4);
+			}
+		}
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "engine/src/system/texture_file.h"
+
+namespace mz {
+	// Decodes a source image and builds the full mip chain in the cooked layout.
+	// Compressed textures are BC1 when fully opaque and BC3 otherwise.
+	class TextureCooker {
+	public:
+		static bool Cook(const uint8_t* fileData, size_t fileSize, bool compress, TextureData& outTexture);
+	private:
+		// Re-encodes every RGBA8 level into the target block format
+		static void CompressLevels(TextureFormat format, TextureData& texture);
+
+		// sRGB aware 2x2 box filter, odd edges clamp
+		static void Downsample(const uint8_t* source, uint32_t sourceWidth, uint32_t sourceHeight, uint8_t* destination, uint32_t width, uint32_t height);
+	};
+}
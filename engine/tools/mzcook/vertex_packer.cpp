@@ -0,0 +1,112 @@
+#include "vertex_packer.h"
+
+namespace mz {
+	void VertexPacker::Pack(MeshData& mesh)
+	{
+		glm::vec3 extent = mesh.boundsMax - mesh.boundsMin;
+		// Flat axes map every position to zero, the shader's scale for them is zero as well
+		glm::vec3 inverseExtent(
+			extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+			extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+			extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+
+		mesh.packedVertices.resize(mesh.vertices.size());
+		for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+			const Vertex3d& vertex = mesh.vertices[i];
+			PackedVertex3d& packed = mesh.packedVertices[i];
+
+			glm::vec3 position = (vertex.pos - mesh.boundsMin) * inverseExtent;
+			for (int c = 0; c < 3; ++c) {
+				packed.pos[c] = QuantizeUnorm16(position[c]);
+				packed.color[c] = QuantizeUnorm8(vertex.color[c]);
+			}
+			packed.pos[3] = 0;
+			packed.color[3] = 255;
+
+			EncodeOctahedral(vertex.normal, packed.normal);
+
+			packed.texCoord[0] = FloatToHalf(vertex.texCoord.x);
+			packed.texCoord[1] = FloatToHalf(vertex.texCoord.y);
+		}
+
+		mesh.vertexFormat = VertexFormat::Packed;
+	}
+
+	void VertexPacker::EncodeOctahedral(const glm::vec3& normal, int16_t* output)
+	{
+		float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+		if (length < 1e-12f) {
+			// Degenerate normals decode to +z
+			output[0] = 0;
+			output[1] = 0;
+			return;
+		}
+
+		float x = normal.x / length;
+		float y = normal.y / length;
+
+		// The lower hemisphere is folded over the diagonals into the corners of the square
+		if (normal.z < 0.0f) {
+			float foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			float foldedY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = foldedX;
+			y = foldedY;
+		}
+
+		output[0] = QuantizeSnorm16(x);
+		output[1] = QuantizeSnorm16(y);
+	}
+
+	uint16_t VertexPacker::FloatToHalf(float value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+
+		uint32_t sign = (bits >> 16) & 0x8000;
+		uint32_t floatExponent = (bits >> 23) & 0xFF;
+		uint32_t mantissa = bits & 0x7FFFFF;
+
+		if (floatExponent == 0xFF) {
+			// Infinity stays infinity, NaN stays a quiet NaN
+			return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+		}
+
+		int32_t exponent = static_cast<int32_t>(floatExponent) - 127 + 15;
+		if (exponent >= 31) {
+			return static_cast<uint16_t>(sign | 0x7C00);
+		}
+
+		if (exponent <= 0) {
+			// Subnormal half, anything below half of the smallest one rounds to zero
+			if (exponent < -10) {
+				return static_cast<uint16_t>(sign);
+			}
+
+			mantissa |= 0x800000;
+			uint32_t shift = static_cast<uint32_t>(14 - exponent);
+			uint32_t half = mantissa >> shift;
+			half += (mantissa >> (shift - 1)) & 1;
+			return static_cast<uint16_t>(sign | half);
+		}
+
+		// A carry out of the mantissa correctly bumps the exponent, up to infinity
+		uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+		half += (mantissa >> 12) & 1;
+		return static_cast<uint16_t>(sign | half);
+	}
+
+	uint16_t VertexPacker::QuantizeUnorm16(float value)
+	{
+		return static_cast<uint16_t>(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+	}
+
+	uint8_t VertexPacker::QuantizeUnorm8(float value)
+	{
+		return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+
+	int16_t VertexPacker::QuantizeSnorm16(float value)
+	{
+		return static_cast<int16_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "engine/src/mzpch.h"
+#include "engine/src/system/mesh_file.h"
+
+namespace mz {
+	// Quantizes cooked vertices into PackedVertex3d, the inverse of the packed vertex shader
+	class VertexPacker {
+	public:
+		// Fills packedVertices from vertices and switches the mesh to the packed format. Positions are
+		// quantized within the mesh bounds, so those have to be final.
+		static void Pack(MeshData& mesh);
+
+		// Octahedral mapping of a unit vector onto [-1, 1]^2, stored as signed normalized 16 bit
+		static void EncodeOctahedral(const glm::vec3& normal, int16_t* output);
+		// Round to nearest, out of range values saturate to infinity
+		static uint16_t FloatToHalf(float value);
+	private:
+		static uint16_t QuantizeUnorm16(float value);
+		static uint8_t QuantizeUnorm8(float value);
+		static int16_t QuantizeSnorm16(float value);
+	};
+}